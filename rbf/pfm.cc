@@ -3,6 +3,7 @@
 
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include "pfm.h"
 
@@ -176,6 +177,23 @@ RC FileHandle::appendPage(const void *data)
 }
 
 
+RC FileHandle::appendPages(const void *data, unsigned numPages)
+{
+    if (fseek(_fd, 0, SEEK_END))
+        return FH_SEEK_FAILED;
+
+    // One write and one flush for the whole run of pages
+    size_t size = (size_t) numPages * PAGE_SIZE;
+    if (fwrite(data, 1, size, _fd) == size)
+    {
+        fflush(_fd);
+        appendPageCounter += numPages;
+        return SUCCESS;
+    }
+    return FH_WRITE_FAILED;
+}
+
+
 unsigned FileHandle::getNumberOfPages()
 {
     // Use stat to get the file size
@@ -188,6 +206,20 @@ unsigned FileHandle::getNumberOfPages()
 }
 
 
+RC FileHandle::truncate(unsigned numPages)
+{
+    // Can only shrink the file
+    if (getNumberOfPages() < numPages)
+        return FH_PAGE_DN_EXIST;
+
+    // Push out anything still buffered before cutting the file
+    if (fflush(_fd) || ftruncate(fileno(_fd), (off_t) PAGE_SIZE * numPages))
+        return FH_TRUNCATE_FAILED;
+
+    return SUCCESS;
+}
+
+
 RC FileHandle::collectCounterValues(unsigned &readPageCount, unsigned &writePageCount, unsigned &appendPageCount)
 {
     readPageCount   = readPageCounter;
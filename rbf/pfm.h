@@ -14,6 +14,7 @@
 #define FH_SEEK_FAILED    2
 #define FH_READ_FAILED    3
 #define FH_WRITE_FAILED   4
+#define FH_TRUNCATE_FAILED 5
 
 typedef unsigned PageNum;
 typedef int RC;
@@ -62,7 +63,9 @@ public:
     RC readPage(PageNum pageNum, void *data);                           // Get a specific page
     RC writePage(PageNum pageNum, const void *data);                    // Write a specific page
     RC appendPage(const void *data);                                    // Append a specific page
+    RC appendPages(const void *data, unsigned numPages);                // Append numPages consecutive pages with one write
     unsigned getNumberOfPages();                                        // Get the number of pages in the file
+    RC truncate(unsigned numPages);                                     // Drop every page from numPages on
     RC collectCounterValues(unsigned &readPageCount, unsigned &writePageCount, unsigned &appendPageCount);  // Put the current counter values into variables
 
     // Let PagedFileManager access our private helper methods
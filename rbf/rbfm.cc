@@ -1,11 +1,24 @@
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <map>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "rbfm.h"
 
@@ -21,6 +34,7 @@ RecordBasedFileManager* RecordBasedFileManager::instance()
 }
 
 RecordBasedFileManager::RecordBasedFileManager()
+: forwardedRecords(0)
 {
     // Initialize the internal PagedFileManager instance
     _pf_manager = PagedFileManager::instance();
@@ -60,6 +74,67 @@ RC RecordBasedFileManager::destroyFile(const string &fileName)
     return _pf_manager->destroyFile(fileName);
 }
 
+RC RecordBasedFileManager::createClusteredFile(const string &fileName, const vector<Attribute> &recordDescriptor, const string &keyAttribute)
+{
+    auto pred = [&](Attribute a) {return a.name == keyAttribute;};
+    auto iterPos = find_if(recordDescriptor.begin(), recordDescriptor.end(), pred);
+    if (iterPos == recordDescriptor.end())
+        return RBFM_NO_SUCH_ATTR;
+
+    RC rc = createFile(fileName);
+    if (rc)
+        return rc;
+
+    // Page 0 becomes the header page, with an empty directory
+    void *headerPage = malloc(PAGE_SIZE);
+    if (headerPage == NULL)
+        return RBFM_MALLOC_FAILED;
+    newRecordBasedPage(headerPage);
+    SlotDirectoryHeaderV2 slotHeader = getSlotDirectoryHeaderV2(headerPage);
+    slotHeader.flags = PAGE_FLAG_CLUSTER_HEADER;
+    slotHeader.freeSpaceOffset = sizeof(SlotDirectoryHeaderV2);
+    setSlotDirectoryHeaderV2(headerPage, slotHeader);
+
+    ClusterHeader header;
+    header.keyIndex = distance(recordDescriptor.begin(), iterPos);
+    header.keyType = iterPos->type;
+    header.directoryLength = 0;
+    header.nextPage = NO_NEXT_PAGE;
+
+    FileHandle fileHandle;
+    rc = openFile(fileName, fileHandle);
+    if (rc == SUCCESS)
+    {
+        rc = writeClusterDirectory(fileHandle, headerPage, header, vector<ClusterDirectoryEntry>());
+        closeFile(fileHandle);
+    }
+    free(headerPage);
+    return rc;
+}
+
+RC RecordBasedFileManager::createAppendOnlyFile(const string &fileName)
+{
+    RC rc = createFile(fileName);
+    if (rc)
+        return rc;
+
+    // Flag the first page, which marks the file as append-only
+    void *pageData = malloc(PAGE_SIZE);
+    if (pageData == NULL)
+        return RBFM_MALLOC_FAILED;
+    newAppendOnlyPage(pageData);
+    FileHandle fileHandle;
+    rc = openFile(fileName, fileHandle);
+    if (rc == SUCCESS)
+    {
+        if (fileHandle.writePage(0, pageData))
+            rc = RBFM_WRITE_FAILED;
+        closeFile(fileHandle);
+    }
+    free(pageData);
+    return rc;
+}
+
 RC RecordBasedFileManager::openFile(const string &fileName, FileHandle &fileHandle) 
 {
     return _pf_manager->openFile(fileName.c_str(), fileHandle);
@@ -72,9 +147,68 @@ RC RecordBasedFileManager::closeFile(FileHandle &fileHandle)
 
 RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, RID &rid) 
 {
-    // Gets the size of the record.
-    unsigned recordSize = getRecordSize(recordDescriptor, data);
+    return insertRecord(fileHandle, recordDescriptor, data, rid, DEFAULT_FILL_FACTOR);
+}
+
+RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, RID &rid,
+        unsigned fillFactor)
+{
+    if (fillFactor == 0 || fillFactor > 100)
+        return RBFM_BAD_FILL_FACTOR;
+
+    // Encodes the record, getting its size on the way.
+    void *record = malloc(PAGE_SIZE);
+    if (record == NULL)
+        return RBFM_MALLOC_FAILED;
+    unsigned recordSize;
+    RC rc = encodeRecord(fileHandle, recordDescriptor, data, record, recordSize);
+    if (rc == SUCCESS)
+    {
+        rc = insertEncodedRecord(fileHandle, record, recordSize, rid, fillFactor);
+        // Don't leave the record's large values behind if it never made it onto a page
+        if (rc != SUCCESS)
+        {
+            vector<LobPointer> lobs;
+            getRecordLobs(record, lobs);
+            freeLobs(fileHandle, lobs);
+        }
+    }
+    free(record);
+    return rc;
+}
+
+RC RecordBasedFileManager::checkFillFactor(FileHandle &fileHandle, unsigned fillFactor)
+{
+    if (fillFactor == 0 || fillFactor > 100)
+        return RBFM_BAD_FILL_FACTOR;
+    if (fillFactor == 100 || fileHandle.getNumberOfPages() == 0)
+        return SUCCESS;
+
+    // The kind of file is told by its first page
+    void *pageData = malloc(PAGE_SIZE);
+    if (pageData == NULL)
+        return RBFM_MALLOC_FAILED;
+    RC rc = SUCCESS;
+    if (fileHandle.readPage(0, pageData))
+        rc = RBFM_READ_FAILED;
+    else if (isClusterHeaderPage(pageData))
+        rc = RBFM_CLUSTERED_FILE;
+    else if (isAppendOnlyPage(pageData))
+        rc = RBFM_APPEND_ONLY_FILE;
+    free(pageData);
+    return rc;
+}
+
+RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, RecordBuilder &builder, RID &rid)
+{
+    unsigned recordSize = builder.finish();
+    if (recordSize > MAX_RECORD_SIZE)
+        return RBFM_RECORD_TOO_LARGE;
+    return insertEncodedRecord(fileHandle, builder.record, recordSize, rid, DEFAULT_FILL_FACTOR);
+}
 
+RC RecordBasedFileManager::insertEncodedRecord(FileHandle &fileHandle, const void *record, unsigned recordSize, RID &rid, unsigned fillFactor)
+{
     // Cycles through pages looking for enough free space for the new entry.
     void *pageData = malloc(PAGE_SIZE);
     if (pageData == NULL)
@@ -87,8 +221,26 @@ RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const vector<Att
         if (fileHandle.readPage(i, pageData))
             return RBFM_READ_FAILED;
 
+        // Clustered files place the record by its key instead
+        if (i == 0 && isClusterHeaderPage(pageData))
+        {
+            RC rc = insertClusteredRecord(fileHandle, pageData, record, recordSize, rid);
+            free(pageData);
+            return rc;
+        }
+        // Append-only files only look at their last page
+        if (i == 0 && isAppendOnlyPage(pageData))
+        {
+            RC rc = appendEncodedRecord(fileHandle, pageData, record, recordSize, rid);
+            free(pageData);
+            return rc;
+        }
+
         // When we find a page with enough space (accounting also for the size that will be added to the slot directory), we stop the loop.
-        if (getPageFreeSpaceSize(pageData) >= sizeof(SlotDirectoryRecordEntry) + recordSize)
+        // The page must also stay within the fill factor once the record is on it.
+        unsigned freeSpace = getPageFreeSpaceSize(pageData);
+        unsigned spaceNeeded = getRecordSpaceNeeded(pageData, recordSize, true);
+        if (freeSpace >= spaceNeeded && PAGE_SIZE - freeSpace + spaceNeeded <= PAGE_SIZE * fillFactor / 100)
         {
             pageFound = true;
             break;
@@ -101,26 +253,25 @@ RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const vector<Att
         newRecordBasedPage(pageData);
     }
 
-    SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(pageData);
-
     // Setting the return RID.
     rid.pageNum = i;
     rid.slotNum = getOpenSlot(pageData);
+    bool newSlot = rid.slotNum == getSlotDirectoryHeader(pageData).recordEntriesNumber;
 
     // Adding the new record reference in the slot directory.
-    SlotDirectoryRecordEntry newRecordEntry;
-    newRecordEntry.length = recordSize;
-    newRecordEntry.offset = slotHeader.freeSpaceOffset - recordSize;
+    SlotDirectoryRecordEntry newRecordEntry = allocateRecordSpace(pageData, recordSize, newSlot);
     setSlotDirectoryRecordEntry(pageData, rid.slotNum, newRecordEntry);
 
     // Updating the slot directory header.
-    slotHeader.freeSpaceOffset = newRecordEntry.offset;
-    if (rid.slotNum == slotHeader.recordEntriesNumber)
+    if (newSlot)
+    {
+        SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(pageData);
         slotHeader.recordEntriesNumber += 1;
-    setSlotDirectoryHeader(pageData, slotHeader);
+        setSlotDirectoryHeader(pageData, slotHeader);
+    }
 
     // Adding the record data.
-    setRecordAtOffset (pageData, newRecordEntry.offset, recordDescriptor, data);
+    memcpy((char*) pageData + newRecordEntry.offset, record, recordSize);
 
     // Writing the page to disk.
     if (pageFound)
@@ -172,20 +323,66 @@ RC RecordBasedFileManager::readRecord(FileHandle &fileHandle, const vector<Attri
         // Retrieve the actual entry data
         case VALID:
             int32_t offset = recordEntry.offset;
-            getRecordAtOffset(pageData, offset, recordDescriptor, data);
+            RC rc = getRecordAtOffset(fileHandle, pageData, offset, recordDescriptor, data);
             free(pageData);
-            return SUCCESS;
+            return rc;
     }
     // Not possible to reach this point, but compiler doesn't know that
     return -1;
 }
 
+RC RecordBasedFileManager::readRecords(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID *rids, unsigned n,
+        const RecordBatchCallback &callback)
+{
+    // Project every attribute, in order
+    vector<unsigned> projection(recordDescriptor.size());
+    for (unsigned i = 0; i < projection.size(); i++)
+        projection[i] = i;
+    return fetchRecords(fileHandle, recordDescriptor, rids, n, projection, callback);
+}
+
+RC RecordBasedFileManager::readRecordView(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, RecordView &view)
+{
+    // Read the page straight into the view's buffer
+    if (fileHandle.readPage(rid.pageNum, view.pageData))
+        return RBFM_READ_FAILED;
+
+    // Checks if the specific slot id exists in the page
+    SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(view.pageData);
+    if(slotHeader.recordEntriesNumber <= rid.slotNum)
+        return RBFM_SLOT_DN_EXIST;
+
+    SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(view.pageData, rid.slotNum);
+
+    SlotStatus status = getSlotStatus(recordEntry);
+    switch (status)
+    {
+        case DEAD:
+            return RBFM_READ_AFTER_DEL;
+        // Follow the forwarding address, the forwarded page replaces this one in the view
+        case MOVED:
+            RID newRid;
+            newRid.pageNum = recordEntry.length;
+            newRid.slotNum = -recordEntry.offset;
+            return readRecordView(fileHandle, recordDescriptor, newRid, view);
+        case VALID:
+            view.recordOffset = recordEntry.offset;
+            return SUCCESS;
+    }
+    return -1;
+}
+
 RC RecordBasedFileManager::deleteRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid)
 {
     // Get page
     void *pageData = malloc(PAGE_SIZE);
     if (fileHandle.readPage(rid.pageNum, pageData) != SUCCESS)
         return RBFM_READ_FAILED;
+    if (isAppendOnlyPage(pageData))
+    {
+        free(pageData);
+        return RBFM_APPEND_ONLY_FILE;
+    }
 
     // Get page header
     SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(pageData);
@@ -215,24 +412,58 @@ RC RecordBasedFileManager::deleteRecord(FileHandle &fileHandle, const vector<Att
         }
         markSlotDeleted(pageData, rid.slotNum);
     }
-    else if (status == VALID)
+    // Large values of the record are freed once the record is gone
+    vector<LobPointer> lobs;
+    if (status == VALID)
     {
+        getRecordLobs((char*) pageData + recordEntry.offset, lobs);
         markSlotDeleted(pageData, rid.slotNum);
-        reorganizePage(pageData);
+        reorganizePageIfFragmented(pageData);
     }
     
     // Once we've deleted the page(s), write changes to disk
     RC rc = fileHandle.writePage(rid.pageNum, pageData);
     free(pageData);
+    if (rc == SUCCESS)
+        rc = freeLobs(fileHandle, lobs);
     return rc;
 }
 
+RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, const RID &rid)
+{
+    void *record = malloc(PAGE_SIZE);
+    if (record == NULL)
+        return RBFM_MALLOC_FAILED;
+    unsigned recordSize;
+    RC rc = encodeRecord(fileHandle, recordDescriptor, data, record, recordSize);
+    if (rc == SUCCESS)
+    {
+        rc = updateEncodedRecord(fileHandle, record, recordSize, rid);
+        if (rc != SUCCESS)
+        {
+            vector<LobPointer> lobs;
+            getRecordLobs(record, lobs);
+            freeLobs(fileHandle, lobs);
+        }
+    }
+    free(record);
+    return rc;
+}
+
+RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, RecordBuilder &builder, const RID &rid)
+{
+    unsigned recordSize = builder.finish();
+    if (recordSize > MAX_RECORD_SIZE)
+        return RBFM_RECORD_TOO_LARGE;
+    return updateEncodedRecord(fileHandle, builder.record, recordSize, rid);
+}
+
 // update record
 // smaller: write at offset + size differece, update slot info, reorganize
-// Larger but fits: remove, reorganize, setRecordAtOffset
+// Larger but fits: remove, reorganize, copy in the record
 // Larger dnf: remove, reorganize, insert into new page and update slot info
 // same: do nothing
-RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, const RID &rid)
+RC RecordBasedFileManager::updateEncodedRecord(FileHandle &fileHandle, const void *record, unsigned recordSize, const RID &rid)
 {
     // Retrieve the specific page
     void *pageData = malloc(PAGE_SIZE);
@@ -266,855 +497,4079 @@ RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, const vector<Att
             RID newRid;
             newRid.pageNum = recordEntry.length;
             newRid.slotNum = -recordEntry.offset;
-            return updateRecord(fileHandle, recordDescriptor, data, newRid);
+            return updateEncodedRecord(fileHandle, record, recordSize, newRid);
         default:
         break;
     }
+    // On a clustered page, a record whose key changed may have to move to another page
+    bool clustered = getPageFormat(pageData) == PAGE_FORMAT_V2 && (getSlotDirectoryHeaderV2(pageData).flags & PAGE_FLAG_CLUSTERED);
+    bool keyMoved = false;
+    if (clustered)
+    {
+        void *headerPage = malloc(PAGE_SIZE);
+        ClusterHeader header;
+        vector<ClusterDirectoryEntry> entries;
+        string oldKey, newKey;
+        RC rc = fileHandle.readPage(0, headerPage) ? RBFM_READ_FAILED : SUCCESS;
+        if (rc == SUCCESS)
+        {
+            memcpy(&header, (char*) headerPage + sizeof(SlotDirectoryHeaderV2), sizeof(ClusterHeader));
+            rc = getClusterKey((char*) pageData + recordEntry.offset, header, oldKey);
+        }
+        if (rc == SUCCESS)
+            rc = getClusterKey(record, header, newKey);
+        if (rc == SUCCESS && oldKey != newKey)
+        {
+            rc = readClusterDirectory(fileHandle, headerPage, header, entries);
+            keyMoved = !clusterKeyBelongsOnPage(header, entries, newKey, rid.pageNum);
+        }
+        free(headerPage);
+        if (rc)
+        {
+            free(pageData);
+            return rc;
+        }
+    }
+
     // Do actual work
-    // Gets the size of the updated record
-    unsigned recordSize = getRecordSize(recordDescriptor, data);
-    if (recordSize  == recordEntry.length)
+    // Large values of the old record are freed once the new one is written
+    vector<LobPointer> lobs;
+    getRecordLobs((char*) pageData + recordEntry.offset, lobs);
+    if (!keyMoved && recordSize  == recordEntry.length)
     {
-        setRecordAtOffset(pageData, recordEntry.offset, recordDescriptor, data);
+        memcpy((char*) pageData + recordEntry.offset, record, recordSize);
         RC rc = fileHandle.writePage(rid.pageNum, pageData);
         free(pageData);
-        return rc;
+        return rc == SUCCESS ? freeLobs(fileHandle, lobs) : rc;
     }
-    else if (recordSize < recordEntry.length)
+    else if (!keyMoved && recordSize < recordEntry.length)
     {
-        setRecordAtOffset(pageData, recordEntry.offset, recordDescriptor, data);
+        memcpy((char*) pageData + recordEntry.offset, record, recordSize);
         recordEntry.length = recordSize;
         setSlotDirectoryRecordEntry(pageData, rid.slotNum, recordEntry);
-        reorganizePage(pageData);
+        reorganizePageIfFragmented(pageData);
         RC rc = fileHandle.writePage(rid.pageNum, pageData);
         free(pageData);
-        return rc;
+        return rc == SUCCESS ? freeLobs(fileHandle, lobs) : rc;
     }
-    else if (recordSize > recordEntry.length)
+    if (keyMoved || recordSize > recordEntry.length)
     {
         unsigned space = getPageFreeSpaceSize(pageData) + recordEntry.length;
-        if (recordSize > space)
+        if (keyMoved || recordSize > space)
         {
             // Need to insert then set forward address then reorganize
             RID newRid;
-            RC rc = insertRecord(fileHandle, recordDescriptor, data, newRid);
+            RC rc = insertEncodedRecord(fileHandle, record, recordSize, newRid, DEFAULT_FILL_FACTOR);
+            if (rc == SUCCESS && clustered)
+                rc = dropSplitCopy(fileHandle, pageData, rid);
             if (rc != SUCCESS)
             {
                 free(pageData);
                 return rc;
             }
+            recordEntry = getSlotDirectoryRecordEntry(pageData, rid.slotNum);
             recordEntry.length = newRid.pageNum;
             recordEntry.offset = -newRid.slotNum;
             setSlotDirectoryRecordEntry(pageData, rid.slotNum, recordEntry);
-            reorganizePage(pageData);
+            reorganizePageIfFragmented(pageData);
+            forwardedRecords++;
         }
         else
         {
-            // Need to set header to DEAD and reorganize to consolidate free space
-            recordEntry.length = 0;
-            recordEntry.offset = 0;
-            setSlotDirectoryRecordEntry(pageData, rid.slotNum, recordEntry);
-            reorganizePage(pageData);
-
-            // Get updated slotHeader with new free space pointer
-            slotHeader = getSlotDirectoryHeader(pageData);
-            // Update record length and offset
-            recordEntry.length = recordSize;
-            recordEntry.offset = slotHeader.freeSpaceOffset - recordSize;
+            // Need to set header to DEAD so its space can be reclaimed, then take new space for the record
+            markSlotDeleted(pageData, rid.slotNum);
+            recordEntry = allocateRecordSpace(pageData, recordSize, false);
             setSlotDirectoryRecordEntry(pageData, rid.slotNum, recordEntry);
 
-            // Update header with new free space pointer
-            slotHeader.freeSpaceOffset = recordEntry.offset;
-            setSlotDirectoryHeader(pageData, slotHeader);
-
             // Add new record data
-            setRecordAtOffset (pageData, recordEntry.offset, recordDescriptor, data);
+            memcpy((char*) pageData + recordEntry.offset, record, recordSize);
         }
     }
     RC rc = fileHandle.writePage(rid.pageNum, pageData);
     free(pageData);
-    return rc;
+    return rc == SUCCESS ? freeLobs(fileHandle, lobs) : rc;
 }
 
-RC RecordBasedFileManager::printRecord(const vector<Attribute> &recordDescriptor, const void *data) 
+RC RecordBasedFileManager::deleteWhere(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+        const vector<ScanPredicateGroup> &conditions, unsigned &deleted)
 {
-    // Parse the null indicator into an array
-    int nullIndicatorSize = getNullIndicatorSize(recordDescriptor.size());
-    char nullIndicator[nullIndicatorSize];
-    memset(nullIndicator, 0, nullIndicatorSize);
-    memcpy(nullIndicator, data, nullIndicatorSize);
-    
-    // We've read in the null indicator, so we can skip past it now
-    unsigned offset = nullIndicatorSize;
+    deleted = 0;
 
-    cout << "----" << endl;
-    for (unsigned i = 0; i < (unsigned) recordDescriptor.size(); i++)
+    // The scan iterator evaluates the conditions against whatever page sits in its buffer
+    RBFM_ScanIterator iterator;
+    vector<string> noAttributes;
+    RC rc = iterator.scanInit(fileHandle, recordDescriptor, conditions, noAttributes);
+    if (rc)
     {
-        cout << setw(10) << left << recordDescriptor[i].name << ": ";
-        // If the field is null, don't print it
-        bool isNull = fieldIsNull(nullIndicator, i);
-        if (isNull)
+        iterator.close();
+        return rc;
+    }
+    void *pageData = iterator.pageData;
+    if (pageData == NULL)
+        return RBFM_MALLOC_FAILED;
+
+    // Slots freed so far, and the MOVED slot pointing at each slot, for the MOVED slots seen so far.
+    // A MOVED slot dies with its target: if the target goes first, the MOVED slot is freed when it
+    // is reached, or afterwards if its page was already written.
+    auto key = [](uint32_t pageNum, uint32_t slotNum) {return ((uint64_t) pageNum << 32) | slotNum;};
+    unordered_set<uint64_t> freedSlots;
+    unordered_map<uint64_t, RID> movedFrom;
+    map<PageNum, vector<unsigned>> pending;
+
+    PageNum pageNum = 0;
+    function<void(unsigned)> freeSlot = [&](unsigned slotNum)
+    {
+        markSlotDeleted(pageData, slotNum);
+        freedSlots.insert(key(pageNum, slotNum));
+        auto from = movedFrom.find(key(pageNum, slotNum));
+        if (from == movedFrom.end())
+            return;
+        RID home = from->second;
+        movedFrom.erase(from);
+        if (home.pageNum == pageNum)
+            freeSlot(home.slotNum);
+        else
+            pending[home.pageNum].push_back(home.slotNum);
+    };
+
+    unsigned numPages = fileHandle.getNumberOfPages();
+    for (pageNum = 0; pageNum < numPages && rc == SUCCESS; pageNum++)
+    {
+        if (fileHandle.readPage(pageNum, pageData))
         {
-            cout << "NULL" << endl;
-            continue;
+            rc = RBFM_READ_FAILED;
+            break;
         }
-        switch (recordDescriptor[i].type)
+        if (pageNum == 0 && isAppendOnlyPage(pageData))
         {
-            case TypeInt:
-                uint32_t data_integer;
-                memcpy(&data_integer, ((char*) data + offset), INT_SIZE);
-                offset += INT_SIZE;
-
-                cout << "" << data_integer << endl;
+            rc = RBFM_APPEND_ONLY_FILE;
             break;
-            case TypeReal:
-                float data_real;
-                memcpy(&data_real, ((char*) data + offset), REAL_SIZE);
-                offset += REAL_SIZE;
-
-                cout << "" << data_real << endl;
-            break;
-            case TypeVarChar:
-                // First VARCHAR_LENGTH_SIZE bytes describe the varchar length
-                uint32_t varcharSize;
-                memcpy(&varcharSize, ((char*) data + offset), VARCHAR_LENGTH_SIZE);
-                offset += VARCHAR_LENGTH_SIZE;
+        }
 
-                // Gets the actual string.
-                char *data_string = (char*) malloc(varcharSize + 1);
-                if (data_string == NULL)
-                    return RBFM_MALLOC_FAILED;
-                memcpy(data_string, ((char*) data + offset), varcharSize);
+        bool dirty = false;
+        vector<LobPointer> lobs;
+        SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(pageData);
+        for (unsigned slotNum = 0; slotNum < slotHeader.recordEntriesNumber; slotNum++)
+        {
+            SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(pageData, slotNum);
+            SlotStatus status = getSlotStatus(recordEntry);
+            if (status == MOVED)
+            {
+                uint64_t target = key(recordEntry.length, -recordEntry.offset);
+                if (freedSlots.count(target))
+                {
+                    freeSlot(slotNum);
+                    dirty = true;
+                }
+                else
+                {
+                    RID home;
+                    home.pageNum = pageNum;
+                    home.slotNum = slotNum;
+                    movedFrom[target] = home;
+                }
+            }
+            else if (status == VALID)
+            {
+                iterator.currSlot = slotNum;
+                if (!iterator.checkScanCondition())
+                    continue;
+                getRecordLobs((char*) pageData + recordEntry.offset, lobs);
+                freeSlot(slotNum);
+                deleted++;
+                dirty = true;
+            }
+        }
 
-                // Adds the string terminator.
-                data_string[varcharSize] = '\0';
-                offset += varcharSize;
+        if (!dirty)
+            continue;
+        reorganizePageIfFragmented(pageData);
+        if (fileHandle.writePage(pageNum, pageData))
+            rc = RBFM_WRITE_FAILED;
+        else
+            rc = freeLobs(fileHandle, lobs);
+    }
 
-                cout << data_string << endl;
-                free(data_string);
-            break;
+    // Free the MOVED slots whose targets were deleted after their page was written.
+    // Freeing them can in turn free the slots pointing at them.
+    while (!pending.empty() && rc == SUCCESS)
+    {
+        map<PageNum, vector<unsigned>> round;
+        round.swap(pending);
+        for (auto &page : round)
+        {
+            pageNum = page.first;
+            if (fileHandle.readPage(pageNum, pageData))
+            {
+                rc = RBFM_READ_FAILED;
+                break;
+            }
+            for (unsigned slotNum : page.second)
+                freeSlot(slotNum);
+            reorganizePageIfFragmented(pageData);
+            if (fileHandle.writePage(pageNum, pageData))
+            {
+                rc = RBFM_WRITE_FAILED;
+                break;
+            }
         }
     }
-    cout << "----" << endl;
 
-    return SUCCESS;
+    iterator.close();
+    return rc;
 }
 
-RC RecordBasedFileManager::readAttribute(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, const string &attributeName, void *data)
+RC RecordBasedFileManager::discardPages(FileHandle &fileHandle, PageNum firstPage, PageNum endPage, unsigned &deleted)
 {
-    char *pageData = (char*)malloc(PAGE_SIZE);
-    if (pageData == NULL)
-        return RBFM_MALLOC_FAILED;
-    if (fileHandle.readPage(rid.pageNum, pageData) != SUCCESS)
+    deleted = 0;
+    unsigned numPages = fileHandle.getNumberOfPages();
+    endPage = min(endPage, numPages);
+    if (firstPage >= endPage)
+        return SUCCESS;
+
+    void *pageData = malloc(PAGE_SIZE);
+    void *otherPage = malloc(PAGE_SIZE);
+    if (pageData == NULL || otherPage == NULL)
     {
         free(pageData);
-        return RBFM_READ_FAILED;
+        free(otherPage);
+        return RBFM_MALLOC_FAILED;
     }
-    // Get record header, recurse if forwarded
-    // Checks if the specific slot id exists in the page
-    SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(pageData);
-    if(slotHeader.recordEntriesNumber < rid.slotNum)
-        return RBFM_SLOT_DN_EXIST;
 
-    // Gets the slot directory record entry data
-    SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(pageData, rid.slotNum);
+    // The pages of a clustered file are all referenced by its directory
+    RC rc = SUCCESS;
+    if (fileHandle.readPage(0, pageData))
+        rc = RBFM_READ_FAILED;
+    else if (isClusterHeaderPage(pageData))
+        rc = RBFM_CLUSTERED_FILE;
+
+    // Deletes the record at the end of a forwarding chain leaving the range. Records forwarded into
+    // the range are deleted with it.
+    vector<LobPointer> lobs;
+    auto deleteForwarded = [&](RID rid) -> RC
+    {
+        while (rid.pageNum < firstPage || rid.pageNum >= endPage)
+        {
+            if (fileHandle.readPage(rid.pageNum, otherPage))
+                return RBFM_READ_FAILED;
+            if (rid.slotNum >= getSlotDirectoryHeader(otherPage).recordEntriesNumber)
+                return SUCCESS;
+            SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(otherPage, rid.slotNum);
+            SlotStatus status = getSlotStatus(recordEntry);
+            if (status == DEAD)
+                return SUCCESS;
+            if (status == VALID)
+            {
+                getRecordLobs((char*) otherPage + recordEntry.offset, lobs);
+                deleted++;
+            }
+            markSlotDeleted(otherPage, rid.slotNum);
+            reorganizePageIfFragmented(otherPage);
+            if (fileHandle.writePage(rid.pageNum, otherPage))
+                return RBFM_WRITE_FAILED;
+            if (status == VALID)
+                return SUCCESS;
+            rid.pageNum = recordEntry.length;
+            rid.slotNum = -recordEntry.offset;
+        }
+        return SUCCESS;
+    };
 
-    SlotStatus status = getSlotStatus(recordEntry);
-    switch (status)
+    // True if the forwarding chain from rid leads into the range
+    auto forwardsIntoRange = [&](RID rid, bool &into) -> RC
     {
-        // Error to get attribute of a deleted record
-        case DEAD:
-            free(pageData);
-            return RBFM_READ_AFTER_DEL;
-        // Get the forwarding address from the record entry and recurse
-        case MOVED:
-            free(pageData);
-            RID newRid;
-            newRid.pageNum = recordEntry.length;
-            newRid.slotNum = -recordEntry.offset;
-            return readAttribute(fileHandle, recordDescriptor, newRid, attributeName, data);
-        default:
-        break;
-    }
+        into = false;
+        while (rid.pageNum < firstPage || rid.pageNum >= endPage)
+        {
+            if (fileHandle.readPage(rid.pageNum, otherPage))
+                return RBFM_READ_FAILED;
+            if (rid.slotNum >= getSlotDirectoryHeader(otherPage).recordEntriesNumber)
+                return SUCCESS;
+            SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(otherPage, rid.slotNum);
+            if (getSlotStatus(recordEntry) != MOVED)
+                return SUCCESS;
+            rid.pageNum = recordEntry.length;
+            rid.slotNum = -recordEntry.offset;
+        }
+        into = true;
+        return SUCCESS;
+    };
+
+    // Records forwarded into the range from outside it are deleted with it. Their MOVED slots go too, as
+    // they would otherwise point at whatever record takes the slot once the range is filled again.
+    for (PageNum pageNum = 0; pageNum < numPages && rc == SUCCESS; pageNum++)
+    {
+        if (pageNum >= firstPage && pageNum < endPage)
+            continue;
+        if (fileHandle.readPage(pageNum, pageData))
+        {
+            rc = RBFM_READ_FAILED;
+            break;
+        }
+        if (isOverflowPage(pageData))
+            continue;
+
+        bool changed = false;
+        SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(pageData);
+        for (unsigned slotNum = 0; slotNum < slotHeader.recordEntriesNumber && rc == SUCCESS; slotNum++)
+        {
+            SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(pageData, slotNum);
+            if (getSlotStatus(recordEntry) != MOVED)
+                continue;
+            RID target;
+            target.pageNum = recordEntry.length;
+            target.slotNum = -recordEntry.offset;
+            bool into;
+            rc = forwardsIntoRange(target, into);
+            if (rc == SUCCESS && into)
+            {
+                markSlotDeleted(pageData, slotNum);
+                changed = true;
+            }
+        }
+        if (rc == SUCCESS && changed)
+        {
+            reorganizePageIfFragmented(pageData);
+            if (fileHandle.writePage(pageNum, pageData))
+                rc = RBFM_WRITE_FAILED;
+        }
+    }
+
+    for (PageNum pageNum = firstPage; pageNum < endPage && rc == SUCCESS; pageNum++)
+    {
+        if (fileHandle.readPage(pageNum, pageData))
+        {
+            rc = RBFM_READ_FAILED;
+            break;
+        }
+        // Overflow pages belong to whichever record points at them
+        if (isOverflowPage(pageData))
+            continue;
+
+        SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(pageData);
+        for (unsigned slotNum = 0; slotNum < slotHeader.recordEntriesNumber && rc == SUCCESS; slotNum++)
+        {
+            SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(pageData, slotNum);
+            SlotStatus status = getSlotStatus(recordEntry);
+            if (status == VALID)
+            {
+                getRecordLobs((char*) pageData + recordEntry.offset, lobs);
+                deleted++;
+            }
+            else if (status == MOVED)
+            {
+                RID target;
+                target.pageNum = recordEntry.length;
+                target.slotNum = -recordEntry.offset;
+                rc = deleteForwarded(target);
+            }
+        }
+
+        // The page starts over empty, keeping its flags
+        uint8_t flags = getPageFormat(pageData) == PAGE_FORMAT_V2 ? getSlotDirectoryHeaderV2(pageData).flags : 0;
+        newRecordBasedPage(pageData);
+        SlotDirectoryHeaderV2 header = getSlotDirectoryHeaderV2(pageData);
+        header.flags = flags;
+        setSlotDirectoryHeaderV2(pageData, header);
+        if (rc == SUCCESS && fileHandle.writePage(pageNum, pageData))
+            rc = RBFM_WRITE_FAILED;
+    }
+    if (rc == SUCCESS)
+        rc = freeLobs(fileHandle, lobs);
+
+    // Give back the empty pages now at the end of the file, always keeping the first page
+    if (rc == SUCCESS && endPage == numPages)
+    {
+        unsigned newNumPages = numPages;
+        while (newNumPages > 1)
+        {
+            if (fileHandle.readPage(newNumPages - 1, pageData))
+            {
+                rc = RBFM_READ_FAILED;
+                break;
+            }
+            if (isOverflowPage(pageData))
+                break;
+            SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(pageData);
+            bool empty = true;
+            for (unsigned slotNum = 0; slotNum < slotHeader.recordEntriesNumber && empty; slotNum++)
+                empty = getSlotStatus(getSlotDirectoryRecordEntry(pageData, slotNum)) == DEAD;
+            if (!empty)
+                break;
+            newNumPages--;
+        }
+        if (rc == SUCCESS && newNumPages < numPages && fileHandle.truncate(newNumPages))
+            rc = RBFM_WRITE_FAILED;
+    }
+
+    free(pageData);
+    free(otherPage);
+    return rc;
+}
+
+RC RecordBasedFileManager::openAppendWriter(FileHandle &fileHandle, AppendWriter &writer)
+{
+    RC rc = writer.close();
+    if (rc)
+        return rc;
+
+    if (fileHandle.readPage(0, writer.pageData))
+        return RBFM_READ_FAILED;
+    if (!isAppendOnlyPage(writer.pageData))
+        return RBFM_OPEN_FAILED;
+
+    // Pick up the last page, unless it is not a record page of the file (e.g. holds a large value)
+    writer.tailPage = fileHandle.getNumberOfPages() - 1;
+    if (fileHandle.readPage(writer.tailPage, writer.pageData))
+        return RBFM_READ_FAILED;
+    if (!isAppendOnlyPage(writer.pageData))
+    {
+        newAppendOnlyPage(writer.pageData);
+        writer.tailPage = fileHandle.getNumberOfPages();
+        if (fileHandle.appendPage(writer.pageData))
+            return RBFM_APPEND_FAILED;
+    }
+    writer.fileHandle = &fileHandle;
+    writer.dirty = false;
+    return SUCCESS;
+}
+
+RC RecordBasedFileManager::vacuumForwardedRecords(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, unsigned &hopsRemoved)
+{
+    hopsRemoved = 0;
+
+    void *pageData = malloc(PAGE_SIZE);
+    void *otherPage = malloc(PAGE_SIZE);
+    void *recordData = malloc(PAGE_SIZE);
+    if (pageData == NULL || otherPage == NULL || recordData == NULL)
+    {
+        free(pageData);
+        free(otherPage);
+        free(recordData);
+        return RBFM_MALLOC_FAILED;
+    }
+
+    RC rc = SUCCESS;
+    unsigned numPages = fileHandle.getNumberOfPages();
+    for (PageNum pageNum = 0; pageNum < numPages && rc == SUCCESS; pageNum++)
+    {
+        if (fileHandle.readPage(pageNum, pageData))
+        {
+            rc = RBFM_READ_FAILED;
+            break;
+        }
+        // Moving records back home would take them out of key order
+        if (pageNum == 0 && isClusterHeaderPage(pageData))
+        {
+            rc = RBFM_CLUSTERED_FILE;
+            break;
+        }
+        bool dirty = false;
+
+        SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(pageData);
+        for (unsigned slotNum = 0; slotNum < slotHeader.recordEntriesNumber && rc == SUCCESS; slotNum++)
+        {
+            SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(pageData, slotNum);
+            if (getSlotStatus(recordEntry) != MOVED)
+                continue;
+
+            // Walk the chain to the record, remembering every slot along the way
+            vector<RID> chain;
+            RID rid;
+            rid.pageNum = recordEntry.length;
+            rid.slotNum = -recordEntry.offset;
+            SlotDirectoryRecordEntry finalEntry;
+            while (true)
+            {
+                chain.push_back(rid);
+                void *page = rid.pageNum == pageNum ? pageData : otherPage;
+                if (page == otherPage && fileHandle.readPage(rid.pageNum, otherPage))
+                {
+                    rc = RBFM_READ_FAILED;
+                    break;
+                }
+                finalEntry = getSlotDirectoryRecordEntry(page, rid.slotNum);
+                if (getSlotStatus(finalEntry) != MOVED)
+                    break;
+                rid.pageNum = finalEntry.length;
+                rid.slotNum = -finalEntry.offset;
+            }
+            // A chain ending in a dead slot is left alone
+            if (rc || getSlotStatus(finalEntry) != VALID)
+                continue;
+
+            RID finalRid = chain.back();
+            unsigned hops = chain.size();
+            bool rehome = false;
+            if (finalRid.pageNum == pageNum)
+            {
+                // The record already lives on this page, the slot can simply take it over
+                setSlotDirectoryRecordEntry(pageData, slotNum, finalEntry);
+                rehome = true;
+            }
+            else if (getPageFreeSpaceSize(pageData) >= getRecordSpaceNeeded(pageData, finalEntry.length, false))
+            {
+                // otherPage still holds the final page from the walk, copy the record back home
+                memcpy(recordData, (char*)otherPage + finalEntry.offset, finalEntry.length);
+                recordEntry = allocateRecordSpace(pageData, finalEntry.length, false);
+                memcpy((char*)pageData + recordEntry.offset, recordData, finalEntry.length);
+                setSlotDirectoryRecordEntry(pageData, slotNum, recordEntry);
+                rehome = true;
+            }
+            else if (hops > 1)
+            {
+                // No room at home, but the slot can point straight at the record
+                recordEntry.length = finalRid.pageNum;
+                recordEntry.offset = -finalRid.slotNum;
+                setSlotDirectoryRecordEntry(pageData, slotNum, recordEntry);
+                chain.pop_back();
+            }
+            else
+                continue;
+
+            // Free every slot that is no longer referenced. Only the record slot holds data to compact away,
+            // and when it was taken over on this page its data now belongs to slotNum.
+            for (unsigned i = 0; i < chain.size(); i++)
+            {
+                bool isRecord = rehome && i == chain.size() - 1;
+                if (chain[i].pageNum == pageNum)
+                {
+                    markSlotDeleted(pageData, chain[i].slotNum);
+                    continue;
+                }
+                if (fileHandle.readPage(chain[i].pageNum, otherPage))
+                {
+                    rc = RBFM_READ_FAILED;
+                    break;
+                }
+                markSlotDeleted(otherPage, chain[i].slotNum);
+                if (isRecord)
+                    reorganizePageIfFragmented(otherPage);
+                if (fileHandle.writePage(chain[i].pageNum, otherPage))
+                {
+                    rc = RBFM_WRITE_FAILED;
+                    break;
+                }
+            }
+            hopsRemoved += rehome ? hops : hops - 1;
+            dirty = true;
+        }
+
+        if (dirty && rc == SUCCESS && fileHandle.writePage(pageNum, pageData))
+            rc = RBFM_WRITE_FAILED;
+    }
+
+    free(pageData);
+    free(otherPage);
+    free(recordData);
+    return rc;
+}
+
+RC RecordBasedFileManager::vacuumFile(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, bool relocate,
+      vector<RIDRemap> &remapped, VacuumStats &stats)
+{
+    memset(&stats, 0, sizeof(stats));
+
+    void *pageData = malloc(PAGE_SIZE);
+    void *otherPage = malloc(PAGE_SIZE);
+    if (pageData == NULL || otherPage == NULL)
+    {
+        free(pageData);
+        free(otherPage);
+        return RBFM_MALLOC_FAILED;
+    }
+
+    // Relocating would reuse slots of an append-only file and break the time order discardPages relies on
+    RC rc = SUCCESS;
+    if (fileHandle.getNumberOfPages() > 0)
+    {
+        if (fileHandle.readPage(0, pageData))
+            rc = RBFM_READ_FAILED;
+        else if (isAppendOnlyPage(pageData))
+            rc = RBFM_APPEND_ONLY_FILE;
+    }
+
+    // Collapse forwarding chains first, so every MOVED slot points straight at its record
+    unsigned hopsRemoved;
+    if (rc == SUCCESS)
+        rc = vacuumForwardedRecords(fileHandle, recordDescriptor, hopsRemoved);
+    if (rc)
+    {
+        free(pageData);
+        free(otherPage);
+        return rc;
+    }
+
+    unsigned numPages = fileHandle.getNumberOfPages();
+    stats.pagesBefore = numPages;
+
+    // One pass to learn how full each page is, and which MOVED slot points at each forwarded record
+    vector<unsigned> liveSlots(numPages, 0);
+    vector<unsigned> freeSpace(numPages, 0);
+    map<pair<uint32_t, uint32_t>, RID> forwardedFrom;
+    for (PageNum pageNum = 0; pageNum < numPages; pageNum++)
+    {
+        if (fileHandle.readPage(pageNum, pageData))
+        {
+            free(pageData);
+            free(otherPage);
+            return RBFM_READ_FAILED;
+        }
+        freeSpace[pageNum] = getPageFreeSpaceSize(pageData);
+        // Overflow pages hold no slots, but are in use and stay where they are
+        if (isOverflowPage(pageData))
+            liveSlots[pageNum] = 1;
+        SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(pageData);
+        for (unsigned slotNum = 0; slotNum < slotHeader.recordEntriesNumber; slotNum++)
+        {
+            SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(pageData, slotNum);
+            SlotStatus status = getSlotStatus(recordEntry);
+            if (status == DEAD)
+                continue;
+            liveSlots[pageNum]++;
+            if (status == MOVED)
+            {
+                RID home;
+                home.pageNum = pageNum;
+                home.slotNum = slotNum;
+                forwardedFrom[make_pair(recordEntry.length, (uint32_t) -recordEntry.offset)] = home;
+            }
+        }
+    }
+
+    // Empty the last page into earlier pages, one page at a time, until a page no longer fits
+    for (PageNum tail = numPages - 1; relocate && numPages > 1 && tail > 0 && rc == SUCCESS; tail--)
+    {
+        if (liveSlots[tail] == 0)
+            continue;
+        if (fileHandle.readPage(tail, pageData))
+        {
+            rc = RBFM_READ_FAILED;
+            break;
+        }
+        if (isOverflowPage(pageData))
+            break;
+
+        // Plan first fit destinations for every record, so a page is either emptied completely or left alone
+        SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(pageData);
+        vector<unsigned> plannedSpace(freeSpace.begin(), freeSpace.begin() + tail);
+        vector<PageNum> destination(slotHeader.recordEntriesNumber, tail);
+        bool fits = true;
+        for (unsigned slotNum = 0; slotNum < slotHeader.recordEntriesNumber && fits; slotNum++)
+        {
+            SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(pageData, slotNum);
+            if (getSlotStatus(recordEntry) != VALID)
+                continue;
+            // Sized for the roomier of the two page formats, since destinations may use either
+            unsigned needed = max(recordEntry.length, (uint32_t) FORWARD_STUB_SIZE) + sizeof(SlotDirectoryRecordEntry);
+            auto pos = find_if(plannedSpace.begin(), plannedSpace.end(), [&](unsigned space) {return space >= needed;});
+            if (pos == plannedSpace.end())
+                fits = false;
+            else
+            {
+                *pos -= needed;
+                destination[slotNum] = distance(plannedSpace.begin(), pos);
+            }
+        }
+        if (!fits)
+            break;
+
+        // Each slot is marked dead once its record is fully moved, and the emptied page written out before
+        // truncating, so a failure part way never leaves a record readable in two places
+        bool emptied = false;
+        for (unsigned slotNum = 0; slotNum < slotHeader.recordEntriesNumber && rc == SUCCESS; slotNum++)
+        {
+            SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(pageData, slotNum);
+            SlotStatus status = getSlotStatus(recordEntry);
+            if (status == DEAD)
+                continue;
+
+            RIDRemap remap;
+            remap.oldRid.pageNum = tail;
+            remap.oldRid.slotNum = slotNum;
+
+            // The record behind a MOVED slot simply keeps the RID it was forwarded to
+            if (status == MOVED)
+            {
+                remap.newRid.pageNum = recordEntry.length;
+                remap.newRid.slotNum = -recordEntry.offset;
+                forwardedFrom.erase(make_pair(remap.newRid.pageNum, remap.newRid.slotNum));
+                remapped.push_back(remap);
+                markSlotDeleted(pageData, slotNum);
+                emptied = true;
+                continue;
+            }
+
+            // Copy the record into its destination page
+            PageNum destPage = destination[slotNum];
+            if (fileHandle.readPage(destPage, otherPage))
+            {
+                rc = RBFM_READ_FAILED;
+                break;
+            }
+            remap.newRid.pageNum = destPage;
+            remap.newRid.slotNum = placeRecordOnPage(otherPage, (char*)pageData + recordEntry.offset, recordEntry.length);
+            freeSpace[destPage] = getPageFreeSpaceSize(otherPage);
+            liveSlots[destPage]++;
+            if (fileHandle.writePage(destPage, otherPage))
+            {
+                rc = RBFM_WRITE_FAILED;
+                break;
+            }
+            stats.recordsRelocated++;
+
+            // A forwarded record keeps its original RID, only the MOVED slot pointing at it changes
+            auto from = forwardedFrom.find(make_pair(tail, slotNum));
+            if (from == forwardedFrom.end())
+            {
+                remapped.push_back(remap);
+                markSlotDeleted(pageData, slotNum);
+                emptied = true;
+                continue;
+            }
+            RID home = from->second;
+            forwardedFrom.erase(from);
+            forwardedFrom[make_pair(remap.newRid.pageNum, remap.newRid.slotNum)] = home;
+            if (fileHandle.readPage(home.pageNum, otherPage))
+            {
+                rc = RBFM_READ_FAILED;
+                break;
+            }
+            SlotDirectoryRecordEntry homeEntry;
+            homeEntry.length = remap.newRid.pageNum;
+            homeEntry.offset = -remap.newRid.slotNum;
+            setSlotDirectoryRecordEntry(otherPage, home.slotNum, homeEntry);
+            if (fileHandle.writePage(home.pageNum, otherPage))
+            {
+                rc = RBFM_WRITE_FAILED;
+                break;
+            }
+            markSlotDeleted(pageData, slotNum);
+            emptied = true;
+        }
+        if (emptied)
+        {
+            reorganizePageIfFragmented(pageData);
+            if (fileHandle.writePage(tail, pageData) && rc == SUCCESS)
+                rc = RBFM_WRITE_FAILED;
+        }
+        liveSlots[tail] = 0;
+    }
+
+    // Everything after the last page still holding records can go, but a file always keeps its first page
+    unsigned newNumPages = numPages;
+    while (newNumPages > 1 && liveSlots[newNumPages - 1] == 0)
+        newNumPages--;
+    if (rc == SUCCESS && newNumPages < numPages && fileHandle.truncate(newNumPages))
+        rc = RBFM_WRITE_FAILED;
+
+    stats.pagesAfter = rc == SUCCESS ? newNumPages : numPages;
+    for (PageNum pageNum = 0; pageNum < stats.pagesAfter; pageNum++)
+    {
+        if (liveSlots[pageNum] == 0)
+            stats.emptyPagesRemaining++;
+    }
+    stats.bytesReclaimed = (stats.pagesBefore - stats.pagesAfter) * PAGE_SIZE;
+    stats.scanPagesSaved = stats.pagesBefore - stats.pagesAfter;
 
-    // Get offset to record
-    unsigned offset = recordEntry.offset;
-    // Get index and type of attribute
-    auto pred = [&](Attribute a) {return a.name == attributeName;};
-    auto iterPos = find_if(recordDescriptor.begin(), recordDescriptor.end(), pred);
-    unsigned index = distance(recordDescriptor.begin(), iterPos);
-    if (index == recordDescriptor.size())
-        return RBFM_NO_SUCH_ATTR;
-    AttrType type = recordDescriptor[index].type;
-    // Write attribute to data
-    getAttributeFromRecord(pageData, offset, index, type, data);
     free(pageData);
+    free(otherPage);
+    return rc;
+}
+
+RC RecordBasedFileManager::printRecord(const vector<Attribute> &recordDescriptor, const void *data) 
+{
+    // Parse the null indicator into an array
+    int nullIndicatorSize = getNullIndicatorSize(recordDescriptor.size());
+    char nullIndicator[nullIndicatorSize];
+    memset(nullIndicator, 0, nullIndicatorSize);
+    memcpy(nullIndicator, data, nullIndicatorSize);
+    
+    // We've read in the null indicator, so we can skip past it now
+    unsigned offset = nullIndicatorSize;
+
+    cout << "----" << endl;
+    for (unsigned i = 0; i < (unsigned) recordDescriptor.size(); i++)
+    {
+        cout << setw(10) << left << recordDescriptor[i].name << ": ";
+        // If the field is null, don't print it
+        bool isNull = fieldIsNull(nullIndicator, i);
+        if (isNull)
+        {
+            cout << "NULL" << endl;
+            continue;
+        }
+        switch (recordDescriptor[i].type)
+        {
+            case TypeInt:
+                uint32_t data_integer;
+                memcpy(&data_integer, ((char*) data + offset), INT_SIZE);
+                offset += INT_SIZE;
+
+                cout << "" << data_integer << endl;
+            break;
+            case TypeReal:
+                float data_real;
+                memcpy(&data_real, ((char*) data + offset), REAL_SIZE);
+                offset += REAL_SIZE;
+
+                cout << "" << data_real << endl;
+            break;
+            case TypeVarChar:
+                // First VARCHAR_LENGTH_SIZE bytes describe the varchar length
+                uint32_t varcharSize;
+                memcpy(&varcharSize, ((char*) data + offset), VARCHAR_LENGTH_SIZE);
+                offset += VARCHAR_LENGTH_SIZE;
+
+                // Gets the actual string.
+                char *data_string = (char*) malloc(varcharSize + 1);
+                if (data_string == NULL)
+                    return RBFM_MALLOC_FAILED;
+                memcpy(data_string, ((char*) data + offset), varcharSize);
+
+                // Adds the string terminator.
+                data_string[varcharSize] = '\0';
+                offset += varcharSize;
+
+                cout << data_string << endl;
+                free(data_string);
+            break;
+        }
+    }
+    cout << "----" << endl;
+
+    return SUCCESS;
+}
+
+RC RecordBasedFileManager::readAttribute(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, const string &attributeName, void *data)
+{
+    char *pageData = (char*)malloc(PAGE_SIZE);
+    if (pageData == NULL)
+        return RBFM_MALLOC_FAILED;
+    if (fileHandle.readPage(rid.pageNum, pageData) != SUCCESS)
+    {
+        free(pageData);
+        return RBFM_READ_FAILED;
+    }
+    // Get record header, recurse if forwarded
+    // Checks if the specific slot id exists in the page
+    SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(pageData);
+    if(slotHeader.recordEntriesNumber < rid.slotNum)
+        return RBFM_SLOT_DN_EXIST;
+
+    // Gets the slot directory record entry data
+    SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(pageData, rid.slotNum);
+
+    SlotStatus status = getSlotStatus(recordEntry);
+    switch (status)
+    {
+        // Error to get attribute of a deleted record
+        case DEAD:
+            free(pageData);
+            return RBFM_READ_AFTER_DEL;
+        // Get the forwarding address from the record entry and recurse
+        case MOVED:
+            free(pageData);
+            RID newRid;
+            newRid.pageNum = recordEntry.length;
+            newRid.slotNum = -recordEntry.offset;
+            return readAttribute(fileHandle, recordDescriptor, newRid, attributeName, data);
+        default:
+        break;
+    }
+
+    // Get offset to record
+    unsigned offset = recordEntry.offset;
+    // Get index and type of attribute
+    auto pred = [&](Attribute a) {return a.name == attributeName;};
+    auto iterPos = find_if(recordDescriptor.begin(), recordDescriptor.end(), pred);
+    unsigned index = distance(recordDescriptor.begin(), iterPos);
+    if (index == recordDescriptor.size())
+        return RBFM_NO_SUCH_ATTR;
+    AttrType type = recordDescriptor[index].type;
+    // Write attribute to data
+    RC rc = getAttributeFromRecord(fileHandle, pageData, offset, index, type, data);
+    free(pageData);
+    return rc;
+}
+
+unsigned RecordBasedFileManager::getForwardedRecordCount()
+{
+    return forwardedRecords;
+}
+
+RC RecordBasedFileManager::readAttributes(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid,
+        const vector<string> &attributeNames, void *data)
+{
+    // Resolve the names before touching the file
+    vector<unsigned> projection;
+    RC rc = getAttributeIndexes(recordDescriptor, attributeNames, projection);
+    if (rc)
+        return rc;
+
+    void *pageData = malloc(PAGE_SIZE);
+    if (pageData == NULL)
+        return RBFM_MALLOC_FAILED;
+
+    RID location;
+    SlotDirectoryRecordEntry recordEntry;
+    rc = readRecordPage(fileHandle, rid, pageData, location, recordEntry);
+    if (rc)
+    {
+        free(pageData);
+        return rc;
+    }
+
+    rc = getProjectedRecord(fileHandle, pageData, recordEntry.offset, recordDescriptor, projection, data);
+    free(pageData);
+    return rc;
+}
+
+RC RecordBasedFileManager::updateAttribute(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid,
+        const string &attributeName, const void *value)
+{
+    vector<unsigned> projection;
+    RC rc = getAttributeIndexes(recordDescriptor, vector<string>(1, attributeName), projection);
+    if (rc)
+        return rc;
+    unsigned index = projection[0];
+    AttrType type = recordDescriptor[index].type;
+
+    void *pageData = malloc(PAGE_SIZE);
+    if (pageData == NULL)
+        return RBFM_MALLOC_FAILED;
+
+    RID location;
+    SlotDirectoryRecordEntry recordEntry;
+    rc = readRecordPage(fileHandle, rid, pageData, location, recordEntry);
+    if (rc)
+    {
+        free(pageData);
+        return rc;
+    }
+
+    // The new value can overwrite the old one if it takes up exactly the same bytes
+    char *attrStart;
+    uint32_t attrLength;
+    bool isLob;
+    uint32_t valueLength = FIXED_WIDTH_FIELD_SIZE;
+    const char *valueStart = (const char*) value;
+    if (value != NULL && type == TypeVarChar)
+    {
+        memcpy(&valueLength, value, VARCHAR_LENGTH_SIZE);
+        valueStart += VARCHAR_LENGTH_SIZE;
+    }
+    bool inPlace = value != NULL
+        && findAttributeInRecord(pageData, recordEntry.offset, index, attrStart, attrLength, isLob)
+        && !isLob && attrLength == valueLength;
+
+    // Changing the key of a clustered record may move it to another page, leave that to updateRecord()
+    if (inPlace && getPageFormat(pageData) == PAGE_FORMAT_V2 && (getSlotDirectoryHeaderV2(pageData).flags & PAGE_FLAG_CLUSTERED))
+    {
+        void *headerPage = malloc(PAGE_SIZE);
+        if (headerPage == NULL || fileHandle.readPage(0, headerPage))
+        {
+            free(headerPage);
+            free(pageData);
+            return RBFM_READ_FAILED;
+        }
+        ClusterHeader header;
+        memcpy(&header, (char*) headerPage + sizeof(SlotDirectoryHeaderV2), sizeof(ClusterHeader));
+        free(headerPage);
+        inPlace = header.keyIndex != index;
+    }
+
+    if (inPlace)
+    {
+        memcpy(attrStart, valueStart, valueLength);
+        rc = fileHandle.writePage(location.pageNum, pageData);
+        free(pageData);
+        return rc == SUCCESS ? SUCCESS : RBFM_WRITE_FAILED;
+    }
+
+    // Otherwise decode the whole record, swap in the new value and update it
+    vector<unsigned> wholeRecord(recordDescriptor.size());
+    for (unsigned i = 0; i < wholeRecord.size(); i++)
+        wholeRecord[i] = i;
+    vector<char> oldData(getProjectedRecordSize(pageData, recordEntry.offset, recordDescriptor, wholeRecord));
+    rc = getProjectedRecord(fileHandle, pageData, recordEntry.offset, recordDescriptor, wholeRecord, oldData.data());
+    free(pageData);
+    if (rc)
+        return rc;
+
+    unsigned nullIndicatorSize = getNullIndicatorSize(recordDescriptor.size());
+    vector<char> newData(oldData.begin(), oldData.begin() + nullIndicatorSize);
+    unsigned oldOffset = nullIndicatorSize;
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    {
+        // Size of the field in the old record
+        unsigned fieldSize = 0;
+        if (!fieldIsNull(oldData.data(), i))
+        {
+            fieldSize = FIXED_WIDTH_FIELD_SIZE;
+            if (recordDescriptor[i].type == TypeVarChar)
+            {
+                uint32_t length;
+                memcpy(&length, oldData.data() + oldOffset, VARCHAR_LENGTH_SIZE);
+                fieldSize = VARCHAR_LENGTH_SIZE + length;
+            }
+        }
+        if (i != index)
+            newData.insert(newData.end(), oldData.begin() + oldOffset, oldData.begin() + oldOffset + fieldSize);
+        else if (value == NULL)
+            newData[i / CHAR_BIT] |= 1 << (CHAR_BIT - 1 - (i % CHAR_BIT));
+        else
+        {
+            newData[i / CHAR_BIT] &= ~(1 << (CHAR_BIT - 1 - (i % CHAR_BIT)));
+            unsigned size = type == TypeVarChar ? VARCHAR_LENGTH_SIZE + valueLength : valueLength;
+            newData.insert(newData.end(), (const char*) value, (const char*) value + size);
+        }
+        oldOffset += fieldSize;
+    }
+    return updateRecord(fileHandle, recordDescriptor, newData.data(), rid);
+}
+
+// Scan returns an iterator to allow the caller to go through the results one by one. 
+  RC RecordBasedFileManager::scan(FileHandle &fileHandle,
+      const vector<Attribute> &recordDescriptor,
+      const string &conditionAttribute,
+      const CompOp compOp,                  // comparision type such as "<" and "="
+      const void *value,                    // used in the comparison
+      const vector<string> &attributeNames, // a list of projected attributes
+      RBFM_ScanIterator &rbfm_ScanIterator)
+{
+    return rbfm_ScanIterator.scanInit(fileHandle, recordDescriptor, conditionAttribute, compOp, value, attributeNames);
+}
+
+RC RecordBasedFileManager::scan(FileHandle &fileHandle,
+      const vector<Attribute> &recordDescriptor,
+      const vector<ScanPredicateGroup> &conditions,
+      const vector<string> &attributeNames,
+      RBFM_ScanIterator &rbfm_ScanIterator)
+{
+    return rbfm_ScanIterator.scanInit(fileHandle, recordDescriptor, conditions, attributeNames);
+}
+
+RC RecordBasedFileManager::filterScan(FileHandle &fileHandle,
+      const vector<Attribute> &recordDescriptor,
+      const vector<ScanPredicateGroup> &conditions,
+      RBFM_ScanIterator &rbfm_ScanIterator)
+{
+    // Project the attributes the conditions refer to, in record descriptor order
+    vector<string> attributeNames;
+    for (const Attribute &attr : recordDescriptor)
+    {
+        bool filtered = false;
+        for (const ScanPredicateGroup &group : conditions)
+            for (const ScanPredicate &predicate : group)
+                if (predicate.compOp != NO_OP && predicate.attribute == attr.name)
+                    filtered = true;
+        if (filtered)
+            attributeNames.push_back(attr.name);
+    }
+    return rbfm_ScanIterator.scanInit(fileHandle, recordDescriptor, conditions, attributeNames);
+}
+
+RC RecordBasedFileManager::fetchProjected(FileHandle &fileHandle,
+      const vector<Attribute> &recordDescriptor,
+      const vector<RID> &rids,
+      const vector<string> &attributeNames,
+      const RecordBatchCallback &callback)
+{
+    vector<unsigned> projection;
+    RC rc = getAttributeIndexes(recordDescriptor, attributeNames, projection);
+    if (rc)
+        return rc;
+    return fetchRecords(fileHandle, recordDescriptor, rids.data(), rids.size(), projection, callback);
+}
+
+RC RecordBasedFileManager::parallelScan(const string &fileName,
+      const vector<Attribute> &recordDescriptor,
+      const vector<ScanPredicateGroup> &conditions,
+      const vector<string> &attributeNames,
+      unsigned numWorkers,
+      const ParallelScanCallback &callback)
+{
+    if (numWorkers == 0)
+        numWorkers = max(thread::hardware_concurrency(), 1u);
+
+    // Only need the page count up front, workers open their own handles
+    FileHandle fileHandle;
+    RC rc = openFile(fileName, fileHandle);
+    if (rc)
+        return rc;
+    uint32_t totalPage = fileHandle.getNumberOfPages();
+    closeFile(fileHandle);
+
+    // Workers claim morsels by bumping the shared page counter
+    atomic<uint32_t> nextPage(0);
+    atomic<bool> failed(false);
+    vector<RC> results(numWorkers, SUCCESS);
+
+    auto worker = [&](unsigned w)
+    {
+        FileHandle workerHandle;
+        RBFM_ScanIterator iter;
+        RC workerRc = openFile(fileName, workerHandle);
+        if (workerRc == SUCCESS)
+            workerRc = iter.scanInit(workerHandle, recordDescriptor, conditions, attributeNames);
+
+        // Each worker has its own output buffer, grown to fit each record as out-of-line varchars are
+        // copied whole
+        vector<char> data;
+
+        while (workerRc == SUCCESS && !failed)
+        {
+            uint32_t first = nextPage.fetch_add(PARALLEL_SCAN_MORSEL_PAGES);
+            if (first >= totalPage)
+                break;
+            workerRc = iter.setPageRange(first, min(first + PARALLEL_SCAN_MORSEL_PAGES, totalPage));
+
+            RID rid;
+            while (workerRc == SUCCESS && (workerRc = iter.getNextRecord(rid, data)) == SUCCESS)
+                callback(w, rid, data.data());
+            if (workerRc == RBFM_EOF)
+                workerRc = SUCCESS;
+        }
+
+        iter.close();
+        closeFile(workerHandle);
+        if (workerRc)
+            failed = true;
+        results[w] = workerRc;
+    };
+
+    vector<thread> workers;
+    for (unsigned w = 0; w < numWorkers; w++)
+        workers.push_back(thread(worker, w));
+    for (thread &t : workers)
+        t.join();
+
+    // Report the first failure, if any
+    for (RC result : results)
+    {
+        if (result)
+            return result;
+    }
+    return SUCCESS;
+}
+
+RC RecordBasedFileManager::bulkLoad(FileHandle &fileHandle,
+      const vector<Attribute> &recordDescriptor,
+      const string &dataFileName,
+      char delimiter,
+      bool hasHeader,
+      unsigned numWorkers,
+      BulkLoadStats &stats)
+{
+    memset(&stats, 0, sizeof(stats));
+    auto start = chrono::steady_clock::now();
+    if (numWorkers == 0)
+        numWorkers = max(thread::hardware_concurrency(), 1u);
+
+    // Rows are placed by key in a clustered file, and an append-only file needs its pages flagged
+    void *firstPage = malloc(PAGE_SIZE);
+    if (firstPage == NULL)
+        return RBFM_MALLOC_FAILED;
+    if (fileHandle.readPage(0, firstPage))
+    {
+        free(firstPage);
+        return RBFM_READ_FAILED;
+    }
+    bool clustered = isClusterHeaderPage(firstPage);
+    bool appendOnly = isAppendOnlyPage(firstPage);
+    free(firstPage);
+    if (clustered)
+        return RBFM_CLUSTERED_FILE;
+
+    int fd = open(dataFileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return RBFM_OPEN_FAILED;
+    struct stat fileStat;
+    if (fstat(fd, &fileStat))
+    {
+        ::close(fd);
+        return RBFM_READ_FAILED;
+    }
+    size_t size = fileStat.st_size;
+    if (size == 0)
+    {
+        ::close(fd);
+        return SUCCESS;
+    }
+    const char *text = (const char*) mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (text == MAP_FAILED)
+        return RBFM_READ_FAILED;
+
+    // Morsels start at the beginning of a line, every line belongs to the morsel it starts in
+    vector<size_t> morsels;
+    for (size_t offset = 0; offset < size; offset += BULK_LOAD_MORSEL_SIZE)
+    {
+        size_t lineStart = offset;
+        if (offset > 0 && text[offset - 1] != '\n')
+        {
+            const char *newline = (const char*) memchr(text + offset, '\n', size - offset);
+            lineStart = newline == NULL ? size : newline - text + 1;
+        }
+        if (lineStart < size && (morsels.empty() || lineStart > morsels.back()))
+            morsels.push_back(lineStart);
+    }
+    morsels.push_back(size);
+
+    // The file handle is shared: appending pages, and writing large values, take the lock
+    mutex fileMutex;
+    atomic<unsigned> nextMorsel(0);
+    atomic<unsigned> rows(0), rejectedRows(0), pages(0);
+    atomic<bool> failed(false);
+    vector<RC> results(numWorkers, SUCCESS);
+
+    auto worker = [&](unsigned w)
+    {
+        // Pages are filled in place in a batch, which goes out with one write once full
+        vector<char> batch((size_t) BULK_LOAD_BATCH_PAGES * PAGE_SIZE);
+        unsigned batchPages = 0;
+        void *pageData = batch.data();
+        void *record = malloc(PAGE_SIZE);
+        vector<char> data;
+        RC workerRc = record == NULL ? RBFM_MALLOC_FAILED : SUCCESS;
+        if (workerRc == SUCCESS)
+            appendOnly ? newAppendOnlyPage(pageData) : newRecordBasedPage(pageData);
+
+        auto appendBatch = [&]() -> RC
+        {
+            lock_guard<mutex> lock(fileMutex);
+            if (fileHandle.appendPages(batch.data(), batchPages))
+                return RBFM_APPEND_FAILED;
+            pages += batchPages;
+            batchPages = 0;
+            return SUCCESS;
+        };
+
+        // Keep the page at pageData and move on to a new one
+        auto appendFullPage = [&]() -> RC
+        {
+            batchPages++;
+            if (batchPages == BULK_LOAD_BATCH_PAGES)
+            {
+                RC rc = appendBatch();
+                if (rc)
+                    return rc;
+            }
+            pageData = batch.data() + (size_t) batchPages * PAGE_SIZE;
+            appendOnly ? newAppendOnlyPage(pageData) : newRecordBasedPage(pageData);
+            return SUCCESS;
+        };
+
+        while (workerRc == SUCCESS && !failed)
+        {
+            unsigned morsel = nextMorsel++;
+            if (morsel + 1 >= morsels.size())
+                break;
+
+            size_t pos = morsels[morsel];
+            while (pos < morsels[morsel + 1] && workerRc == SUCCESS)
+            {
+                const char *newline = (const char*) memchr(text + pos, '\n', size - pos);
+                size_t lineEnd = newline == NULL ? size : newline - text;
+                size_t length = lineEnd - pos;
+                if (length > 0 && text[lineEnd - 1] == '\r')
+                    length--;
+                bool skip = length == 0 || (hasHeader && pos == 0);
+                const char *line = text + pos;
+                pos = lineEnd + 1;
+                if (skip)
+                    continue;
+
+                bool hasLob;
+                if (!parseDelimitedRow(recordDescriptor, line, length, delimiter, data, hasLob))
+                {
+                    rejectedRows++;
+                    continue;
+                }
+                unsigned recordSize;
+                RC rc;
+                if (hasLob)
+                {
+                    lock_guard<mutex> lock(fileMutex);
+                    rc = encodeRecord(fileHandle, recordDescriptor, data.data(), record, recordSize);
+                }
+                else
+                    rc = encodeRecord(fileHandle, recordDescriptor, data.data(), record, recordSize);
+                if (rc == RBFM_RECORD_TOO_LARGE)
+                {
+                    rejectedRows++;
+                    continue;
+                }
+                if (rc)
+                {
+                    workerRc = rc;
+                    break;
+                }
+
+                if (getPageFreeSpaceSize(pageData) < getRecordSpaceNeeded(pageData, recordSize, true))
+                {
+                    workerRc = appendFullPage();
+                    if (workerRc)
+                        break;
+                }
+                appendRecordToPage(pageData, record, recordSize);
+                rows++;
+            }
+        }
+
+        // The last page of each worker goes out part full
+        if (workerRc == SUCCESS && getSlotDirectoryHeader(pageData).recordEntriesNumber > 0)
+            batchPages++;
+        if (workerRc == SUCCESS && batchPages > 0)
+            workerRc = appendBatch();
+
+        free(record);
+        if (workerRc)
+            failed = true;
+        results[w] = workerRc;
+    };
+
+    vector<thread> workers;
+    for (unsigned w = 0; w < numWorkers; w++)
+        workers.push_back(thread(worker, w));
+    for (thread &t : workers)
+        t.join();
+    munmap((void*) text, size);
+
+    stats.rows = rows;
+    stats.rejectedRows = rejectedRows;
+    stats.pages = pages;
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    stats.rowsPerSecond = stats.seconds > 0 ? stats.rows / stats.seconds : 0;
+
+    // Report the first failure, if any
+    for (RC result : results)
+    {
+        if (result)
+            return result;
+    }
+    return SUCCESS;
+}
+
+RC RecordBasedFileManager::analyzeFile(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, TableStats &stats)
+{
+    vector<PageNum> pages(fileHandle.getNumberOfPages());
+    for (unsigned i = 0; i < pages.size(); i++)
+        pages[i] = i;
+    return analyzePages(fileHandle, recordDescriptor, pages, stats);
+}
+
+RC RecordBasedFileManager::analyzeFile(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, unsigned sampledPages,
+        unsigned seed, TableStats &stats)
+{
+    vector<PageNum> pages(fileHandle.getNumberOfPages());
+    for (unsigned i = 0; i < pages.size(); i++)
+        pages[i] = i;
+    unsigned numPages = pages.size();
+    samplePageList(pages, sampledPages, seed);
+    RC rc = analyzePages(fileHandle, recordDescriptor, pages, stats);
+    if (rc == SUCCESS && !pages.empty())
+        stats.rowCount = (uint64_t) stats.rowCount * numPages / pages.size();
+    stats.sampled = pages.size() < numPages;
+    return rc;
+}
+
+RBFM_ScanIterator::RBFM_ScanIterator()
+: currPage(0), currSlot(0), totalPage(0), totalSlot(0), pageData(NULL), pageListPos(0), limit(0), returned(0), fingerprint(0)
+{
+    rbfm = RecordBasedFileManager::instance();
+}
+
+RC RBFM_ScanIterator::close()
+{
+    free(pageData);
+    return SUCCESS;
+}
+
+// Initialize the scanIterator with all necessary state
+RC RBFM_ScanIterator::scanInit(FileHandle &fh,
+        const vector<Attribute> rd,
+        const string &ca, 
+        const CompOp co, 
+        const void *v, 
+        const vector<string> &an)
+{
+    // A single condition is just one group holding one predicate
+    vector<ScanPredicateGroup> conds;
+    if (co != NO_OP)
+    {
+        ScanPredicate predicate;
+        predicate.attribute = ca;
+        predicate.compOp = co;
+        predicate.value = v;
+        conds.push_back(ScanPredicateGroup(1, predicate));
+    }
+    return scanInit(fh, rd, conds, an);
+}
+
+RC RBFM_ScanIterator::scanInit(FileHandle &fh,
+        const vector<Attribute> rd,
+        const vector<ScanPredicateGroup> &conds,
+        const vector<string> &an)
+{
+    // Start at page 0 slot 0
+    currPage = 0;
+    currSlot = 0;
+    totalPage = 0;
+    totalSlot = 0;
+    // Keep a buffer to hold the current page
+    pageData = malloc(PAGE_SIZE);
+
+    // Store the variables passed in to
+    fileHandle = fh;
+    recordDescriptor = rd;
+    attributeNames = an;
+    RC rc = rbfm->getAttributeIndexes(rd, an, projection);
+    if (rc)
+        return rc;
+
+    skipList.clear();
+
+    // Resolve every predicate against the record descriptor
+    conditions.clear();
+    for (const ScanPredicateGroup &group : conds)
+    {
+        CompiledPredicateGroup compiledGroup;
+        bool alwaysTrue = group.empty();
+        for (const ScanPredicate &predicate : group)
+        {
+            // A NO_OP predicate satisfies its whole group
+            if (predicate.compOp == NO_OP)
+            {
+                alwaysTrue = true;
+                continue;
+            }
+            CompiledPredicate compiled;
+            rc = compilePredicate(predicate, compiled);
+            if (rc)
+                return rc;
+            compiledGroup.push_back(compiled);
+        }
+        if (alwaysTrue)
+            continue;
+
+        // Within an OR group, try the predicate most likely to pass first
+        auto orComp = [](const CompiledPredicate &first, const CompiledPredicate &second)
+            {return first.selectivity * second.cost > second.selectivity * first.cost;};
+        stable_sort(compiledGroup.begin(), compiledGroup.end(), orComp);
+        conditions.push_back(compiledGroup);
+    }
+
+    // Across the AND groups, rank by cost per chance of rejecting the record
+    auto groupPass = [](const CompiledPredicateGroup &group)
+    {
+        float fail = 1;
+        for (const CompiledPredicate &predicate : group)
+            fail *= 1 - predicate.selectivity;
+        return 1 - fail;
+    };
+    auto groupCost = [](const CompiledPredicateGroup &group)
+    {
+        unsigned cost = 0;
+        for (const CompiledPredicate &predicate : group)
+            cost += predicate.cost;
+        return cost;
+    };
+    auto andComp = [&](const CompiledPredicateGroup &first, const CompiledPredicateGroup &second)
+        {return groupCost(first) * (1 - groupPass(second)) < groupCost(second) * (1 - groupPass(first));};
+    stable_sort(conditions.begin(), conditions.end(), andComp);
+
+    limit = 0;
+    returned = 0;
+    computeFingerprint();
+
+    // Get total number of pages
+    totalPage = fh.getNumberOfPages();
+    if (totalPage > 0)
+    {
+        if (fh.readPage(0, pageData))
+            return RBFM_READ_FAILED;
+    }
+    else
+        return SUCCESS;
+
+    pageList.clear();
+    pageListPos = 0;
+    if (rbfm->isClusterHeaderPage(pageData))
+        return initClusteredScan();
+
+    // Get number of slots on first page
+    SlotDirectoryHeader header = rbfm->getSlotDirectoryHeader(pageData);
+    totalSlot = header.recordEntriesNumber;
+
+    return SUCCESS;
+}
+
+// Narrows the scan to the directory pages whose key range meets the bounds the conditions put on the key.
+// Only groups holding a single predicate bound the key, the rest are left to the record checks.
+RC RBFM_ScanIterator::initClusteredScan()
+{
+    ClusterHeader header;
+    vector<ClusterDirectoryEntry> entries;
+    RC rc = rbfm->readClusterDirectory(fileHandle, pageData, header, entries);
+    if (rc)
+        return rc;
+    AttrType keyType = (AttrType) header.keyType;
+
+    string low, high;
+    bool hasLow = false, hasHigh = false;
+    for (const CompiledPredicateGroup &group : conditions)
+    {
+        if (group.size() != 1 || group[0].attrIndex != header.keyIndex)
+            continue;
+        const CompiledPredicate &predicate = group[0];
+        uint32_t valueSize = INT_SIZE;
+        if (keyType == TypeVarChar)
+        {
+            memcpy(&valueSize, predicate.value, VARCHAR_LENGTH_SIZE);
+            valueSize += VARCHAR_LENGTH_SIZE;
+        }
+        string value((const char*) predicate.value, valueSize);
+
+        bool lowers = predicate.compOp == EQ_OP || predicate.compOp == GT_OP || predicate.compOp == GE_OP;
+        bool uppers = predicate.compOp == EQ_OP || predicate.compOp == LT_OP || predicate.compOp == LE_OP;
+        if (lowers && (!hasLow || rbfm->compareClusterKeys(keyType, value, low) > 0))
+        {
+            low = value;
+            hasLow = true;
+        }
+        if (uppers && (!hasHigh || rbfm->compareClusterKeys(keyType, value, high) < 0))
+        {
+            high = value;
+            hasHigh = true;
+        }
+    }
+
+    // Start at the last page whose key is below the lower bound, as it can still hold keys up to the
+    // next page's key, and stop at the first page whose key is above the upper bound. findClusterEntry
+    // finds the last page whose key is not above it, step back over any whose key equals it.
+    unsigned first = 0;
+    if (hasLow)
+    {
+        first = rbfm->findClusterEntry(keyType, entries, low);
+        while (first > 0 && rbfm->compareClusterKeys(keyType, entries[first].key, low) >= 0)
+            first--;
+    }
+    for (unsigned i = first; i < entries.size(); i++)
+    {
+        if (i > first && hasHigh && rbfm->compareClusterKeys(keyType, entries[i].key, high) > 0)
+            break;
+        pageList.push_back(entries[i].pageNum);
+    }
+
+    // With nothing to visit the scan is over before it starts
+    if (pageList.empty())
+    {
+        totalPage = 0;
+        totalSlot = 0;
+        return SUCCESS;
+    }
+    currPage = pageList[0];
+    return getNextPage();
+}
+
+// Find the predicate's attribute in the record descriptor and estimate its cost and selectivity
+RC RBFM_ScanIterator::compilePredicate(const ScanPredicate &predicate, CompiledPredicate &compiled)
+{
+    auto pred = [&](Attribute a) {return a.name == predicate.attribute;};
+    auto iterPos = find_if(recordDescriptor.begin(), recordDescriptor.end(), pred);
+    compiled.attrIndex = distance(recordDescriptor.begin(), iterPos);
+    if (compiled.attrIndex == recordDescriptor.size())
+        return RBFM_NO_SUCH_ATTR;
+
+    compiled.type = recordDescriptor[compiled.attrIndex].type;
+    compiled.compOp = predicate.compOp;
+    compiled.value = predicate.value;
+
+    // Fixed size comparisons are a single load, varchars need a memcmp
+    compiled.cost = compiled.type == TypeVarChar ? 2 : 1;
+
+    // Without statistics, assume equality is rare, ranges split the data and inequality almost always passes
+    switch (compiled.compOp)
+    {
+        case EQ_OP: compiled.selectivity = 0.1;  break;
+        case NE_OP: compiled.selectivity = 0.9;  break;
+        default:    compiled.selectivity = 0.33; break;
+    }
+    return SUCCESS;
+}
+
+RC RBFM_ScanIterator::setPageRange(uint32_t firstPage, uint32_t endPage)
+{
+    pageList.clear();
+    currPage = firstPage;
+    currSlot = 0;
+    totalPage = min(endPage, fileHandle.getNumberOfPages());
+    totalSlot = 0;
+
+    // An empty range is exhausted on the first getNextSlot
+    if (currPage >= totalPage)
+        return SUCCESS;
+
+    return getNextPage();
+}
+
+RC RBFM_ScanIterator::getNextRecord(RID &rid, void *data)
+{
+    SlotDirectoryRecordEntry recordEntry;
+    RC rc = nextRecordEntry(recordEntry);
+    if (rc)
+        return rc;
+
+    // Copy the projected attributes straight from the page into data, if there are any
+    if (attributeNames.size() != 0)
+    {
+        rc = rbfm->getProjectedRecord(fileHandle, pageData, recordEntry.offset, recordDescriptor, projection, data);
+        if (rc)
+            return rc;
+    }
+
+    rid.pageNum = currPage;
+    rid.slotNum = currSlot++;
+    return SUCCESS;
+}
+
+RC RBFM_ScanIterator::getNextRecord(RID &rid, vector<char> &data)
+{
+    SlotDirectoryRecordEntry recordEntry;
+    RC rc = nextRecordEntry(recordEntry);
+    if (rc)
+        return rc;
+
+    // Out-of-line varchars are copied whole, so a projected record can be larger than a page
+    if (attributeNames.size() != 0)
+    {
+        data.resize(rbfm->getProjectedRecordSize(pageData, recordEntry.offset, recordDescriptor, projection));
+        rc = rbfm->getProjectedRecord(fileHandle, pageData, recordEntry.offset, recordDescriptor, projection, data.data());
+        if (rc)
+            return rc;
+    }
+
+    rid.pageNum = currPage;
+    rid.slotNum = currSlot++;
+    return SUCCESS;
+}
+
+RC RBFM_ScanIterator::nextRecordEntry(SlotDirectoryRecordEntry &recordEntry)
+{
+    if (limit && returned >= limit)
+        return RBFM_EOF;
+    RC rc = getNextSlot();
+    if (rc)
+        return rc;
+    returned++;
+
+    recordEntry = rbfm->getSlotDirectoryRecordEntry(pageData, currSlot);
+    return SUCCESS;
+}
+
+void RBFM_ScanIterator::setLimit(unsigned l)
+{
+    limit = l;
+    returned = 0;
+}
+
+RC RBFM_ScanIterator::getContinuation(ScanToken &token)
+{
+    memset(&token, 0, sizeof(ScanToken));
+    token.fingerprint = fingerprint;
+    token.pageNum = currPage;
+    token.slotNum = currSlot;
+    token.pageListPos = pageListPos;
+    return SUCCESS;
+}
+
+RC RBFM_ScanIterator::resume(const ScanToken &token)
+{
+    if (token.fingerprint != fingerprint)
+        return RBFM_BAD_SCAN_TOKEN;
+
+    currPage = token.pageNum;
+    currSlot = token.slotNum;
+    totalSlot = 0;
+    if (!pageList.empty())
+    {
+        // A clustered scan that ran to its end stays at its end
+        pageListPos = token.pageListPos;
+        if (pageListPos >= pageList.size())
+        {
+            currSlot = 0;
+            return SUCCESS;
+        }
+        // Splits since the token was taken shift the pages along
+        if (pageList[pageListPos] != currPage)
+        {
+            auto iterPos = find(pageList.begin(), pageList.end(), currPage);
+            if (iterPos == pageList.end())
+                return RBFM_BAD_SCAN_TOKEN;
+            pageListPos = distance(pageList.begin(), iterPos);
+        }
+    }
+    // Past the last page the scan is over, unless the file has grown since
+    else if (currPage >= totalPage)
+        return SUCCESS;
+
+    return getNextPage();
+}
+
+RC RBFM_ScanIterator::samplePages(unsigned count, unsigned seed)
+{
+    // Sample from the pages the scan would visit
+    if (pageList.empty())
+    {
+        for (PageNum i = 0; i < totalPage; i++)
+            pageList.push_back(i);
+    }
+    rbfm->samplePageList(pageList, count, seed);
+
+    pageListPos = 0;
+    currSlot = 0;
+    totalSlot = 0;
+    // With nothing to visit the scan is over before it starts
+    if (pageList.empty())
+    {
+        totalPage = 0;
+        return SUCCESS;
+    }
+    currPage = pageList[0];
+    return getNextPage();
+}
+
+RC RBFM_ScanIterator::samplePercent(float percent, unsigned seed)
+{
+    if (!(percent >= 0 && percent <= 100))
+        return RBFM_BAD_SAMPLE;
+    unsigned pages = pageList.empty() ? totalPage : pageList.size();
+    return samplePages(lround(pages * percent / 100), seed);
+}
+
+// FNV-1a over everything that decides which records the scan returns, and in what format
+void RBFM_ScanIterator::computeFingerprint()
+{
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&](const void *bytes, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= ((const unsigned char*) bytes)[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+    auto mixString = [&](const string &value)
+    {
+        uint32_t size = value.size();
+        mix(&size, sizeof(size));
+        mix(value.data(), size);
+    };
+
+    for (const Attribute &attr : recordDescriptor)
+    {
+        mixString(attr.name);
+        mix(&attr.type, sizeof(attr.type));
+    }
+    for (const CompiledPredicateGroup &group : conditions)
+    {
+        uint32_t size = group.size();
+        mix(&size, sizeof(size));
+        for (const CompiledPredicate &predicate : group)
+        {
+            mix(&predicate.attrIndex, sizeof(predicate.attrIndex));
+            mix(&predicate.compOp, sizeof(predicate.compOp));
+            uint32_t valueSize = INT_SIZE;
+            if (predicate.type == TypeVarChar)
+            {
+                memcpy(&valueSize, predicate.value, VARCHAR_LENGTH_SIZE);
+                valueSize += VARCHAR_LENGTH_SIZE;
+            }
+            mix(predicate.value, valueSize);
+        }
+    }
+    uint32_t separator = UINT_MAX;
+    mix(&separator, sizeof(separator));
+    for (const string &name : attributeNames)
+        mixString(name);
+    fingerprint = hash;
+}
+
+RecordBuilder::RecordBuilder(const vector<Attribute> &recordDescriptor)
+{
+    for (const Attribute &attr : recordDescriptor)
+        types.push_back(attr.type);
+    nullIndicatorSize = int(ceil((double) types.size() / CHAR_BIT));
+    headerSize = sizeof(RecordLength) + nullIndicatorSize + types.size() * sizeof(ColumnOffset);
+    record = (char*) malloc(max(headerSize, (unsigned) PAGE_SIZE));
+    reset();
+}
+
+RecordBuilder::~RecordBuilder()
+{
+    free(record);
+}
+
+void RecordBuilder::reset()
+{
+    RecordLength len = types.size();
+    memcpy(record, &len, sizeof(RecordLength));
+    memset(record + sizeof(RecordLength), 0, nullIndicatorSize);
+    for (unsigned i = 0; i < types.size(); i++)
+        record[sizeof(RecordLength) + i / CHAR_BIT] |= 1 << (CHAR_BIT - 1 - (i % CHAR_BIT));
+    nextColumn = 0;
+    dataEnd = headerSize;
+}
+
+RC RecordBuilder::setInt(unsigned i, int32_t value)
+{
+    return setField(i, TypeInt, &value, INT_SIZE);
+}
+
+RC RecordBuilder::setReal(unsigned i, float value)
+{
+    return setField(i, TypeReal, &value, REAL_SIZE);
+}
+
+RC RecordBuilder::setVarchar(unsigned i, const char *value, uint32_t length)
+{
+    return setField(i, TypeVarChar, value, length);
+}
+
+RC RecordBuilder::setLob(unsigned i, const LobPointer &pointer)
+{
+    RC rc = setField(i, TypeVarChar, &pointer, sizeof(LobPointer));
+    if (rc)
+        return rc;
+    ColumnOffset endOffset = dataEnd | LOB_COLUMN_FLAG;
+    memcpy(record + sizeof(RecordLength) + nullIndicatorSize + i * sizeof(ColumnOffset), &endOffset, sizeof(ColumnOffset));
+    return SUCCESS;
+}
+
+RC RecordBuilder::setNull(unsigned i)
+{
+    if (i >= types.size())
+        return RBFM_BAD_FIELD;
+    return setField(i, types[i], NULL, 0);
+}
+
+// Writes column i straight after the columns already set. A NULL value leaves the column null.
+RC RecordBuilder::setField(unsigned i, AttrType type, const void *value, uint32_t length)
+{
+    if (i >= types.size() || i < nextColumn || types[i] != type)
+        return RBFM_BAD_FIELD;
+    if (dataEnd > MAX_RECORD_SIZE || length > MAX_RECORD_SIZE - dataEnd)
+        return RBFM_RECORD_TOO_LARGE;
+
+    // Columns skipped over stay null and end where the data so far ends
+    char *directory = record + sizeof(RecordLength) + nullIndicatorSize;
+    ColumnOffset endOffset = dataEnd;
+    for (; nextColumn < i; nextColumn++)
+        memcpy(directory + nextColumn * sizeof(ColumnOffset), &endOffset, sizeof(ColumnOffset));
+
+    if (value != NULL)
+    {
+        memcpy(record + dataEnd, value, length);
+        dataEnd += length;
+        record[sizeof(RecordLength) + i / CHAR_BIT] &= ~(1 << (CHAR_BIT - 1 - (i % CHAR_BIT)));
+    }
+    endOffset = dataEnd;
+    memcpy(directory + i * sizeof(ColumnOffset), &endOffset, sizeof(ColumnOffset));
+    nextColumn = i + 1;
+    return SUCCESS;
+}
+
+unsigned RecordBuilder::finish()
+{
+    char *directory = record + sizeof(RecordLength) + nullIndicatorSize;
+    ColumnOffset endOffset = dataEnd;
+    for (unsigned i = nextColumn; i < types.size(); i++)
+        memcpy(directory + i * sizeof(ColumnOffset), &endOffset, sizeof(ColumnOffset));
+    return dataEnd;
+}
+
+RC RecordBasedFileManager::createLob(FileHandle &fileHandle, LobWriter &writer)
+{
+    writer.fileHandle = &fileHandle;
+    writer.currentPage = NO_NEXT_PAGE;
+    writer.pointer.firstPage = NO_NEXT_PAGE;
+    writer.pointer.length = 0;
+    return SUCCESS;
+}
+
+// Null values read as an empty value
+RC RecordBasedFileManager::openLob(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid,
+        const string &attributeName, LobReader &reader)
+{
+    auto pred = [&](Attribute a) {return a.name == attributeName;};
+    auto iterPos = find_if(recordDescriptor.begin(), recordDescriptor.end(), pred);
+    unsigned index = distance(recordDescriptor.begin(), iterPos);
+    if (index == recordDescriptor.size() || recordDescriptor[index].type != TypeVarChar)
+        return RBFM_NO_SUCH_ATTR;
+
+    RecordView view;
+    RC rc = readRecordView(fileHandle, recordDescriptor, rid, view);
+    if (rc)
+        return rc;
+
+    reader.fileHandle = &fileHandle;
+    reader.position = 0;
+    reader.pageLength = 0;
+    reader.pageOffset = 0;
+    reader.inlineValue.clear();
+
+    char *attrStart;
+    uint32_t attrLength;
+    bool isLob;
+    if (!findAttributeInRecord(view.pageData, view.recordOffset, index, attrStart, attrLength, isLob))
+        attrLength = 0;
+    else if (isLob)
+    {
+        reader.isInline = false;
+        memcpy(&reader.pointer, attrStart, sizeof(LobPointer));
+        reader.nextPage = reader.pointer.firstPage;
+        return SUCCESS;
+    }
+
+    reader.isInline = true;
+    reader.inlineValue.assign(attrStart, attrLength);
+    reader.pointer.firstPage = NO_NEXT_PAGE;
+    reader.pointer.length = attrLength;
+    reader.nextPage = NO_NEXT_PAGE;
+    return SUCCESS;
+}
+
+AppendWriter::AppendWriter()
+: fileHandle(NULL), tailPage(0), dirty(false)
+{
+    pageData = malloc(PAGE_SIZE);
+}
+
+AppendWriter::~AppendWriter()
+{
+    free(pageData);
+}
+
+RC AppendWriter::insertRecord(const vector<Attribute> &recordDescriptor, const void *data, RID &rid)
+{
+    if (fileHandle == NULL)
+        return RBFM_WRITE_FAILED;
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+    void *record = malloc(PAGE_SIZE);
+    if (record == NULL)
+        return RBFM_MALLOC_FAILED;
+    unsigned recordSize;
+    RC rc = rbfm->encodeRecord(*fileHandle, recordDescriptor, data, record, recordSize);
+    bool encoded = rc == SUCCESS;
+    if (rc == SUCCESS && rbfm->getPageFreeSpaceSize(pageData) < rbfm->getRecordSpaceNeeded(pageData, recordSize, true))
+    {
+        // Write out the full page, and claim the next one right away so that large values
+        // stored in the meantime go after it
+        rc = flush();
+        if (rc == SUCCESS)
+        {
+            rbfm->newAppendOnlyPage(pageData);
+            tailPage = fileHandle->getNumberOfPages();
+            if (fileHandle->appendPage(pageData))
+                rc = RBFM_APPEND_FAILED;
+        }
+    }
+    if (rc == SUCCESS)
+    {
+        rid.pageNum = tailPage;
+        rid.slotNum = rbfm->appendRecordToPage(pageData, record, recordSize);
+        dirty = true;
+    }
+    else if (encoded)
+    {
+        vector<LobPointer> lobs;
+        rbfm->getRecordLobs(record, lobs);
+        rbfm->freeLobs(*fileHandle, lobs);
+    }
+    free(record);
+    return rc;
+}
+
+RC AppendWriter::flush()
+{
+    if (fileHandle == NULL || !dirty)
+        return SUCCESS;
+    if (fileHandle->writePage(tailPage, pageData))
+        return RBFM_WRITE_FAILED;
+    dirty = false;
+    return SUCCESS;
+}
+
+RC AppendWriter::close()
+{
+    RC rc = flush();
+    fileHandle = NULL;
+    return rc;
+}
+
+LobWriter::LobWriter()
+: fileHandle(NULL), currentPage(NO_NEXT_PAGE)
+{
+    pageData = malloc(PAGE_SIZE);
+    pointer.firstPage = NO_NEXT_PAGE;
+    pointer.length = 0;
+}
+
+LobWriter::~LobWriter()
+{
+    free(pageData);
+}
+
+RC LobWriter::write(const void *data, uint32_t size)
+{
+    if (fileHandle == NULL)
+        return RBFM_WRITE_FAILED;
+
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    OverflowPageHeader header;
+    if (currentPage != NO_NEXT_PAGE)
+        memcpy(&header, (char*) pageData + sizeof(SlotDirectoryHeaderV2), sizeof(OverflowPageHeader));
+
+    const char *next = (const char*) data;
+    while (size > 0)
+    {
+        // Start a new page once the current one is full. Appending it straight away reserves its page number,
+        // so the page before it can link to it.
+        if (currentPage == NO_NEXT_PAGE || header.dataLength == OVERFLOW_PAGE_CAPACITY)
+        {
+            PageNum newPage = fileHandle->getNumberOfPages();
+            if (currentPage != NO_NEXT_PAGE)
+            {
+                header.nextPage = newPage;
+                memcpy((char*) pageData + sizeof(SlotDirectoryHeaderV2), &header, sizeof(OverflowPageHeader));
+                if (fileHandle->writePage(currentPage, pageData))
+                    return RBFM_WRITE_FAILED;
+            }
+
+            rbfm->newOverflowPage(pageData);
+            header.nextPage = NO_NEXT_PAGE;
+            header.dataLength = 0;
+            if (fileHandle->appendPage(pageData))
+                return RBFM_APPEND_FAILED;
+
+            if (pointer.firstPage == NO_NEXT_PAGE)
+                pointer.firstPage = newPage;
+            currentPage = newPage;
+        }
+
+        uint32_t chunk = min(size, (uint32_t) (OVERFLOW_PAGE_CAPACITY - header.dataLength));
+        memcpy((char*) pageData + OVERFLOW_DATA_OFFSET + header.dataLength, next, chunk);
+        header.dataLength += chunk;
+        memcpy((char*) pageData + sizeof(SlotDirectoryHeaderV2), &header, sizeof(OverflowPageHeader));
+        pointer.length += chunk;
+        next += chunk;
+        size -= chunk;
+    }
+    return SUCCESS;
+}
+
+RC LobWriter::close(LobPointer &lobPointer)
+{
+    if (fileHandle == NULL)
+        return RBFM_WRITE_FAILED;
+    if (currentPage != NO_NEXT_PAGE && fileHandle->writePage(currentPage, pageData))
+        return RBFM_WRITE_FAILED;
+    lobPointer = pointer;
+    fileHandle = NULL;
+    currentPage = NO_NEXT_PAGE;
+    return SUCCESS;
+}
+
+LobReader::LobReader()
+: fileHandle(NULL), isInline(true), position(0), nextPage(NO_NEXT_PAGE), pageLength(0), pageOffset(0)
+{
+    pageData = malloc(PAGE_SIZE);
+    pointer.firstPage = NO_NEXT_PAGE;
+    pointer.length = 0;
+}
+
+LobReader::~LobReader()
+{
+    free(pageData);
+}
+
+uint32_t LobReader::length() const
+{
+    return pointer.length;
+}
+
+RC LobReader::read(void *buffer, uint32_t size, uint32_t &bytesRead)
+{
+    bytesRead = 0;
+    while (bytesRead < size && position < pointer.length)
+    {
+        uint32_t chunk;
+        if (isInline)
+        {
+            chunk = min(size - bytesRead, pointer.length - position);
+            memcpy((char*) buffer + bytesRead, inlineValue.data() + position, chunk);
+        }
+        else
+        {
+            // Move on to the next page of the chain once this one is used up
+            if (pageOffset == pageLength)
+            {
+                if (nextPage == NO_NEXT_PAGE || fileHandle->readPage(nextPage, pageData))
+                    return RBFM_READ_FAILED;
+                OverflowPageHeader header;
+                memcpy(&header, (char*) pageData + sizeof(SlotDirectoryHeaderV2), sizeof(OverflowPageHeader));
+                nextPage = header.nextPage;
+                pageLength = header.dataLength;
+                pageOffset = 0;
+            }
+            chunk = min(size - bytesRead, pageLength - pageOffset);
+            memcpy((char*) buffer + bytesRead, (char*) pageData + OVERFLOW_DATA_OFFSET + pageOffset, chunk);
+            pageOffset += chunk;
+        }
+        position += chunk;
+        bytesRead += chunk;
+    }
+    return SUCCESS;
+}
+
+RecordView::RecordView()
+: recordOffset(0)
+{
+    rbfm = RecordBasedFileManager::instance();
+    pageData = malloc(PAGE_SIZE);
+}
+
+RecordView::~RecordView()
+{
+    free(pageData);
+}
+
+bool RecordView::isNull(unsigned i) const
+{
+    char *attrStart;
+    uint32_t attrLength;
+    bool isLob;
+    return !rbfm->findAttributeInRecord(pageData, recordOffset, i, attrStart, attrLength, isLob);
+}
+
+// Null fields read as 0
+int32_t RecordView::getInt(unsigned i) const
+{
+    char *attrStart;
+    uint32_t attrLength;
+    bool isLob;
+    int32_t value = 0;
+    if (rbfm->findAttributeInRecord(pageData, recordOffset, i, attrStart, attrLength, isLob))
+        memcpy(&value, attrStart, INT_SIZE);
+    return value;
+}
+
+float RecordView::getReal(unsigned i) const
+{
+    char *attrStart;
+    uint32_t attrLength;
+    bool isLob;
+    float value = 0;
+    if (rbfm->findAttributeInRecord(pageData, recordOffset, i, attrStart, attrLength, isLob))
+        memcpy(&value, attrStart, REAL_SIZE);
+    return value;
+}
+
+// Null fields read as an empty string
+const char *RecordView::getVarchar(unsigned i, uint32_t &length) const
+{
+    char *attrStart;
+    bool isLob;
+    if (rbfm->findAttributeInRecord(pageData, recordOffset, i, attrStart, length, isLob))
+    {
+        if (!isLob)
+            return attrStart;
+        LobPointer pointer;
+        memcpy(&pointer, attrStart, sizeof(LobPointer));
+        length = pointer.length;
+        return NULL;
+    }
+    length = 0;
+    return "";
+}
+
+// Private helper methods ///////////////////////////////////////////////////////////////////
+
+RC RBFM_ScanIterator::getNextSlot()
+{
+    // If we're done with the current page, or we've read the last page
+    if (currSlot >= totalSlot || currPage >= totalPage)
+    {
+        // Reinitialize the current slot and move to the next page
+        currSlot = 0;
+        if (!pageList.empty())
+        {
+            if (++pageListPos >= pageList.size())
+                return RBFM_EOF;
+            currPage = pageList[pageListPos];
+        }
+        else
+        {
+            currPage++;
+            // If we're done with last page, return EOF
+            if (currPage >= totalPage)
+                return RBFM_EOF;
+        }
+        // Otherwise get next page ready, and start over in case it has no slots
+        RC rc = getNextPage();
+        if (rc)
+            return rc;
+        return getNextSlot();
+    }
+
+    // Get slot header, check to see if valid and meets scan condition
+    SlotDirectoryRecordEntry recordEntry = rbfm->getSlotDirectoryRecordEntry(pageData, currSlot);
+
+    if (rbfm->getSlotStatus(recordEntry) != VALID || !checkScanCondition())
+    {
+        // If not, try next slot
+        currSlot++;
+        return getNextSlot();
+    }
+    return SUCCESS;
+}
+
+RC RBFM_ScanIterator::getNextPage()
+{
+    // Read in page
+    if (fileHandle.readPage(currPage, pageData))
+        return RBFM_READ_FAILED;
+
+    // Update slot total
+    SlotDirectoryHeader header = rbfm->getSlotDirectoryHeader(pageData);
+    totalSlot = header.recordEntriesNumber;
+    return SUCCESS;
+}
+
+bool RBFM_ScanIterator::checkScanCondition()
+{
+    SlotDirectoryRecordEntry recordEntry = rbfm->getSlotDirectoryRecordEntry(pageData, currSlot);
+    // Every group must have at least one satisfied predicate
+    for (const CompiledPredicateGroup &group : conditions)
+    {
+        bool groupResult = false;
+        for (const CompiledPredicate &predicate : group)
+        {
+            if (checkScanCondition(predicate, recordEntry.offset))
+            {
+                groupResult = true;
+                break;
+            }
+        }
+        if (!groupResult)
+            return false;
+    }
+    return true;
+}
+
+// Check a single predicate against the record at recordOffset, reading the attribute straight from the page
+bool RBFM_ScanIterator::checkScanCondition(const CompiledPredicate &predicate, unsigned recordOffset)
+{
+    if (predicate.value == NULL) return false;
+
+    char *attrStart;
+    uint32_t attrLength;
+    bool isLob;
+    // Null values never satisfy a condition
+    if (!rbfm->findAttributeInRecord(pageData, recordOffset, predicate.attrIndex, attrStart, attrLength, isLob))
+        return false;
+
+    if (predicate.type == TypeInt)
+    {
+        int32_t recordInt;
+        memcpy(&recordInt, attrStart, INT_SIZE);
+        return checkScanCondition(recordInt, predicate.compOp, predicate.value);
+    }
+    else if (predicate.type == TypeReal)
+    {
+        float recordReal;
+        memcpy(&recordReal, attrStart, REAL_SIZE);
+        return checkScanCondition(recordReal, predicate.compOp, predicate.value);
+    }
+    if (!isLob)
+        return checkScanCondition(attrStart, attrLength, predicate.compOp, predicate.value);
+
+    // A value stored out of line has to be read in before it can be compared
+    LobPointer pointer;
+    memcpy(&pointer, attrStart, sizeof(LobPointer));
+    char *value = (char*) malloc(max(pointer.length, (uint32_t) 1));
+    if (value == NULL || rbfm->readLob(fileHandle, pointer, value))
+    {
+        free(value);
+        return false;
+    }
+    bool result = checkScanCondition(value, pointer.length, predicate.compOp, predicate.value);
+    free(value);
+    return result;
+}
+
+bool RBFM_ScanIterator::checkScanCondition(int recordInt, CompOp compOp, const void *value)
+{
+    int32_t intValue;
+    memcpy (&intValue, value, INT_SIZE);
+
+    switch (compOp)
+    {
+        case EQ_OP: return recordInt == intValue;
+        case LT_OP: return recordInt < intValue;
+        case GT_OP: return recordInt > intValue;
+        case LE_OP: return recordInt <= intValue;
+        case GE_OP: return recordInt >= intValue;
+        case NE_OP: return recordInt != intValue;
+        case NO_OP: return true;
+        // Should never happen
+        default: return false;
+    }
+}
+
+bool RBFM_ScanIterator::checkScanCondition(float recordReal, CompOp compOp, const void *value)
+{
+    float realValue;
+    memcpy (&realValue, value, REAL_SIZE);
+
+    switch (compOp)
+    {
+        case EQ_OP: return recordReal == realValue;
+        case LT_OP: return recordReal < realValue;
+        case GT_OP: return recordReal > realValue;
+        case LE_OP: return recordReal <= realValue;
+        case GE_OP: return recordReal >= realValue;
+        case NE_OP: return recordReal != realValue;
+        case NO_OP: return true;
+        // Should never happen
+        default: return false;
+    }
+}
+
+bool RBFM_ScanIterator::checkScanCondition(const char *recordString, uint32_t recordLength, CompOp compOp, const void *value)
+{
+    if (compOp == NO_OP)
+        return true;
+
+    uint32_t valueSize;
+    memcpy(&valueSize, value, VARCHAR_LENGTH_SIZE);
+    const char *valueStr = (const char*) value + VARCHAR_LENGTH_SIZE;
+
+    // Compare the common prefix, the shorter string sorts first if they are otherwise equal
+    int cmp = memcmp(recordString, valueStr, min(recordLength, valueSize));
+    if (cmp == 0)
+        cmp = recordLength < valueSize ? -1 : (recordLength > valueSize ? 1 : 0);
+    switch (compOp)
+    {
+        case EQ_OP: return cmp == 0;
+        case LT_OP: return cmp <  0;
+        case GT_OP: return cmp >  0;
+        case LE_OP: return cmp <= 0;
+        case GE_OP: return cmp >= 0;
+        case NE_OP: return cmp != 0;
+        // Should never happen
+        default: return false;
+    }
+}
+
+// Configures a new record based page, and puts it in "page".
+void RecordBasedFileManager::newRecordBasedPage(void * page)
+{
+    memset(page, 0, PAGE_SIZE);
+    // Writes the slot directory header. New pages always use the v2 format.
+    SlotDirectoryHeaderV2 slotHeader;
+    slotHeader.flags = 0;
+    slotHeader.version = PAGE_FORMAT_V2;
+    slotHeader.freeSpaceOffset = PAGE_SIZE;
+    slotHeader.recordEntriesNumber = 0;
+    slotHeader.freeSlotHead = NO_FREE_SLOT;
+    slotHeader.fragmentedBytes = 0;
+    setSlotDirectoryHeaderV2(page, slotHeader);
+}
+
+unsigned RecordBasedFileManager::getPageFormat(void * page)
+{
+    return ((uint8_t*) page)[1] == PAGE_FORMAT_V2 ? PAGE_FORMAT_V2 : PAGE_FORMAT_V1;
+}
+
+// Bytes a record of recordSize takes up on the page, counting a new slot entry if newSlot is set
+unsigned RecordBasedFileManager::getRecordSpaceNeeded(void * page, unsigned recordSize, bool newSlot)
+{
+    if (getPageFormat(page) == PAGE_FORMAT_V1)
+        return recordSize + (newSlot ? sizeof(SlotDirectoryRecordEntry) : 0);
+    return max(recordSize, (unsigned) FORWARD_STUB_SIZE) + (newSlot ? sizeof(SlotDirectoryRecordEntryV2) : 0);
+}
+
+SlotDirectoryHeaderV2 RecordBasedFileManager::getSlotDirectoryHeaderV2(void * page)
+{
+    SlotDirectoryHeaderV2 slotHeader;
+    memcpy (&slotHeader, page, sizeof(SlotDirectoryHeaderV2));
+    return slotHeader;
+}
+
+void RecordBasedFileManager::setSlotDirectoryHeaderV2(void * page, SlotDirectoryHeaderV2 slotHeader)
+{
+    memcpy (page, &slotHeader, sizeof(SlotDirectoryHeaderV2));
+}
+
+SlotDirectoryRecordEntryV2 RecordBasedFileManager::getSlotDirectoryRecordEntryV2(void * page, unsigned recordEntryNumber)
+{
+    SlotDirectoryRecordEntryV2 recordEntry;
+    memcpy  (
+            &recordEntry,
+            ((char*) page + sizeof(SlotDirectoryHeaderV2) + recordEntryNumber * sizeof(SlotDirectoryRecordEntryV2)),
+            sizeof(SlotDirectoryRecordEntryV2)
+            );
+    return recordEntry;
+}
+
+void RecordBasedFileManager::setSlotDirectoryRecordEntryV2(void * page, unsigned recordEntryNumber, SlotDirectoryRecordEntryV2 recordEntry)
+{
+    memcpy  (
+            ((char*) page + sizeof(SlotDirectoryHeaderV2) + recordEntryNumber * sizeof(SlotDirectoryRecordEntryV2)),
+            &recordEntry,
+            sizeof(SlotDirectoryRecordEntryV2)
+            );
+}
+
+SlotDirectoryHeader RecordBasedFileManager::getSlotDirectoryHeader(void * page)
+{
+    // Getting the slot directory header.
+    SlotDirectoryHeader slotHeader;
+    if (getPageFormat(page) == PAGE_FORMAT_V1)
+    {
+        memcpy (&slotHeader, page, sizeof(SlotDirectoryHeader));
+        return slotHeader;
+    }
+    SlotDirectoryHeaderV2 header = getSlotDirectoryHeaderV2(page);
+    slotHeader.freeSpaceOffset = header.freeSpaceOffset;
+    slotHeader.recordEntriesNumber = header.recordEntriesNumber;
+    return slotHeader;
+}
+
+void RecordBasedFileManager::setSlotDirectoryHeader(void * page, SlotDirectoryHeader slotHeader)
+{
+    // Setting the slot directory header.
+    if (getPageFormat(page) == PAGE_FORMAT_V1)
+    {
+        memcpy (page, &slotHeader, sizeof(SlotDirectoryHeader));
+        return;
+    }
+    // Space given up by the record area belongs to no slot until a slot entry claims it
+    SlotDirectoryHeaderV2 header = getSlotDirectoryHeaderV2(page);
+    header.fragmentedBytes += header.freeSpaceOffset - slotHeader.freeSpaceOffset;
+    header.freeSpaceOffset = slotHeader.freeSpaceOffset;
+    header.recordEntriesNumber = slotHeader.recordEntriesNumber;
+    setSlotDirectoryHeaderV2(page, header);
+}
+
+SlotDirectoryRecordEntry RecordBasedFileManager::getSlotDirectoryRecordEntry(void * page, unsigned recordEntryNumber)
+{
+    // Getting the slot directory entry data.
+    SlotDirectoryRecordEntry recordEntry;
+    if (getPageFormat(page) == PAGE_FORMAT_V1)
+    {
+        memcpy  (
+                &recordEntry,
+                ((char*) page + sizeof(SlotDirectoryHeader) + recordEntryNumber * sizeof(SlotDirectoryRecordEntry)),
+                sizeof(SlotDirectoryRecordEntry)
+                );
+        return recordEntry;
+    }
+
+    // v2 entries are translated to the v1 encoding: DEAD is all 0s, MOVED is the new page in length
+    // and the negated new slot in offset
+    SlotDirectoryRecordEntryV2 entry = getSlotDirectoryRecordEntryV2(page, recordEntryNumber);
+    uint16_t offset = entry.offset & ~SLOT_V2_STATUS_MASK;
+    switch (entry.offset & SLOT_V2_STATUS_MASK)
+    {
+        case SLOT_V2_DEAD:
+            recordEntry.length = 0;
+            recordEntry.offset = 0;
+            break;
+        case SLOT_V2_MOVED:
+        {
+            uint32_t stub[2];
+            memcpy(stub, (char*) page + offset, FORWARD_STUB_SIZE);
+            recordEntry.length = stub[0];
+            recordEntry.offset = -(int32_t) stub[1];
+            break;
+        }
+        default:
+            recordEntry.length = entry.length;
+            recordEntry.offset = offset;
+    }
+    return recordEntry;
+}
+
+void RecordBasedFileManager::setSlotDirectoryRecordEntry(void * page, unsigned recordEntryNumber, SlotDirectoryRecordEntry recordEntry)
+{
+    // Setting the slot directory entry data.
+    if (getPageFormat(page) == PAGE_FORMAT_V1)
+    {
+        memcpy  (
+                ((char*) page + sizeof(SlotDirectoryHeader) + recordEntryNumber * sizeof(SlotDirectoryRecordEntry)),
+                &recordEntry,
+                sizeof(SlotDirectoryRecordEntry)
+                );
+        return;
+    }
+
+    // A slot past the end of the directory is being added, and holds nothing yet
+    SlotDirectoryHeaderV2 header = getSlotDirectoryHeaderV2(page);
+    SlotDirectoryRecordEntryV2 oldEntry;
+    oldEntry.offset = SLOT_V2_DEAD;
+    oldEntry.length = NO_FREE_SLOT;
+    bool onFreeList = false;
+    if (recordEntryNumber < header.recordEntriesNumber)
+    {
+        oldEntry = getSlotDirectoryRecordEntryV2(page, recordEntryNumber);
+        onFreeList = (oldEntry.offset & SLOT_V2_STATUS_MASK) == SLOT_V2_DEAD;
+    }
+    bool oldLive = (oldEntry.offset & SLOT_V2_STATUS_MASK) != SLOT_V2_DEAD;
+    SlotStatus status = getSlotStatus(recordEntry);
+    if (!oldLive && status == DEAD)
+        return;
+
+    SlotDirectoryRecordEntryV2 entry;
+    if (status == DEAD)
+    {
+        // Push the slot onto the free slot chain
+        entry.offset = SLOT_V2_DEAD;
+        entry.length = header.freeSlotHead;
+        header.freeSlotHead = recordEntryNumber;
+    }
+    else if (status == MOVED)
+    {
+        // The forwarding stub reuses the space the slot already owns
+        if (!oldLive)
+        {
+            setSlotDirectoryHeaderV2(page, header);
+            oldEntry.offset = allocateRecordSpace(page, FORWARD_STUB_SIZE, false).offset;
+            header = getSlotDirectoryHeaderV2(page);
+        }
+        entry.offset = (oldEntry.offset & ~SLOT_V2_STATUS_MASK) | SLOT_V2_MOVED;
+        entry.length = FORWARD_STUB_SIZE;
+        uint32_t stub[2] = {recordEntry.length, (uint32_t) -recordEntry.offset};
+        memcpy((char*) page + (entry.offset & ~SLOT_V2_STATUS_MASK), stub, FORWARD_STUB_SIZE);
+    }
+    else
+    {
+        entry.offset = recordEntry.offset;
+        entry.length = max(recordEntry.length, (uint32_t) FORWARD_STUB_SIZE);
+    }
+
+    // Unlink a reused dead slot from the free slot chain
+    if (onFreeList)
+    {
+        if (header.freeSlotHead == recordEntryNumber)
+            header.freeSlotHead = oldEntry.length;
+        else
+        {
+            unsigned prev = header.freeSlotHead;
+            SlotDirectoryRecordEntryV2 prevEntry = getSlotDirectoryRecordEntryV2(page, prev);
+            while (prevEntry.length != recordEntryNumber)
+            {
+                prev = prevEntry.length;
+                prevEntry = getSlotDirectoryRecordEntryV2(page, prev);
+            }
+            prevEntry.length = oldEntry.length;
+            setSlotDirectoryRecordEntryV2(page, prev, prevEntry);
+        }
+    }
+
+    // Bytes owned by the old entry and not by the new one are now fragmented
+    header.fragmentedBytes += (oldLive ? oldEntry.length : 0) - (status == DEAD ? 0 : entry.length);
+    setSlotDirectoryHeaderV2(page, header);
+    setSlotDirectoryRecordEntryV2(page, recordEntryNumber, entry);
+}
+
+// Computes the free space of a page (function of the free space pointer and the slot directory size).
+// On a v2 page this includes fragmented space that a compaction would recover.
+unsigned RecordBasedFileManager::getPageFreeSpaceSize(void * page) 
+{
+    if (getPageFormat(page) == PAGE_FORMAT_V1)
+    {
+        SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(page);
+        return slotHeader.freeSpaceOffset - slotHeader.recordEntriesNumber * sizeof(SlotDirectoryRecordEntry) - sizeof(SlotDirectoryHeader);
+    }
+    SlotDirectoryHeaderV2 slotHeader = getSlotDirectoryHeaderV2(page);
+    return slotHeader.freeSpaceOffset + slotHeader.fragmentedBytes
+        - slotHeader.recordEntriesNumber * sizeof(SlotDirectoryRecordEntryV2) - sizeof(SlotDirectoryHeaderV2);
+}
+
+// Calculate actual bytes for nulls-indicator for the given field counts
+int RecordBasedFileManager::getNullIndicatorSize(int fieldCount) 
+{
+    return int(ceil((double) fieldCount / CHAR_BIT));
+}
+
+// True if every column of the descriptor is fixed-width, so records without nulls can use FixedWidthLayout
+bool RecordBasedFileManager::isFixedWidth(const vector<Attribute> &recordDescriptor)
+{
+    for (const Attribute &attr : recordDescriptor)
+    {
+        if (!isFixedWidthType(attr.type))
+            return false;
+    }
+    return true;
+}
+
+bool RecordBasedFileManager::fieldIsNull(char *nullIndicator, int i)
+{
+    int indicatorIndex = i / CHAR_BIT;
+    int indicatorMask  = 1 << (CHAR_BIT - 1 - (i % CHAR_BIT));
+    return (nullIndicator[indicatorIndex] & indicatorMask) != 0;
+}
+
+// Turns API-format data into the stored format in a single pass, getting the size of the record on the way.
+// Varchars longer than LOB_INLINE_LIMIT are written to overflow pages as they are met.
+// record must have room for PAGE_SIZE bytes. Fields past that are not written, but still counted,
+// and the record is rejected once it is known to be too large.
+RC RecordBasedFileManager::encodeRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, void *record, unsigned &recordSize)
+{
+    if (isFixedWidth(recordDescriptor))
+    {
+        recordSize = FixedWidthDispatch<FIXED_WIDTH_MAX_SPECIALIZED>::encode(recordDescriptor.size(), record, data);
+        if (recordSize)
+            return SUCCESS;
+    }
+
+    // Read in the null indicator
+    int nullIndicatorSize = getNullIndicatorSize(recordDescriptor.size());
+    char nullIndicator[nullIndicatorSize];
+    memcpy(nullIndicator, (char*) data, nullIndicatorSize);
+
+    // Points to start of record
+    char *start = (char*) record;
+
+    // Offset into *data
+    unsigned data_offset = nullIndicatorSize;
+    // Offset into record header
+    unsigned header_offset = sizeof(RecordLength) + nullIndicatorSize;
+
+    // Keeps track of the offset of each record
+    // Offset is relative to the start of the record and points to the END of a field
+    unsigned rec_offset = header_offset + (recordDescriptor.size()) * sizeof(ColumnOffset);
+    if (rec_offset > MAX_RECORD_SIZE)
+        return RBFM_RECORD_TOO_LARGE;
+
+    RecordLength len = recordDescriptor.size();
+    memcpy(start, &len, sizeof(len));
+    memcpy(start + sizeof(len), nullIndicator, nullIndicatorSize);
+
+    vector<LobPointer> lobs;
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    {
+        ColumnOffset lobFlag = 0;
+        if (!fieldIsNull(nullIndicator, i))
+        {
+            // Points to current position in *data
+            char *data_start = (char*) data + data_offset;
+            uint32_t fieldSize;
+
+            switch (recordDescriptor[i].type)
+            {
+                case TypeInt:
+                    fieldSize = INT_SIZE;
+                break;
+                case TypeReal:
+                    fieldSize = REAL_SIZE;
+                break;
+                case TypeVarChar:
+                default:
+                    // We have to get the size of the VarChar field by reading the integer that precedes the string value itself
+                    memcpy(&fieldSize, data_start, VARCHAR_LENGTH_SIZE);
+                    data_start += VARCHAR_LENGTH_SIZE;
+                    data_offset += VARCHAR_LENGTH_SIZE;
+                break;
+            }
+            data_offset += fieldSize;
+
+            if (recordDescriptor[i].type == TypeVarChar && fieldSize > LOB_INLINE_LIMIT && rec_offset + sizeof(LobPointer) <= PAGE_SIZE)
+            {
+                // Store the value out of line, and its pointer in its place
+                LobPointer pointer;
+                RC rc = writeLob(fileHandle, data_start, fieldSize, pointer);
+                if (rc)
+                {
+                    freeLobs(fileHandle, lobs);
+                    return rc;
+                }
+                lobs.push_back(pointer);
+                memcpy(start + rec_offset, &pointer, sizeof(LobPointer));
+                rec_offset += sizeof(LobPointer);
+                lobFlag = LOB_COLUMN_FLAG;
+            }
+            else
+            {
+                if (rec_offset <= PAGE_SIZE && fieldSize <= PAGE_SIZE - rec_offset)
+                    memcpy (start + rec_offset, data_start, fieldSize);
+                rec_offset += fieldSize;
+            }
+        }
+        // Copy offset into record header
+        // Offset is relative to the start of the record and points to END of field
+        ColumnOffset endOffset = rec_offset | lobFlag;
+        memcpy(start + header_offset, &endOffset, sizeof(ColumnOffset));
+        header_offset += sizeof(ColumnOffset);
+    }
+
+    if (rec_offset > MAX_RECORD_SIZE)
+    {
+        freeLobs(fileHandle, lobs);
+        return RBFM_RECORD_TOO_LARGE;
+    }
+    recordSize = rec_offset;
+    return SUCCESS;
+}
+
+RC RecordBasedFileManager::getRecordAtOffset(FileHandle &fileHandle, void *page, int32_t offset, const vector<Attribute> &recordDescriptor, void *data)
+{
+    // Records written before columns were added to the descriptor fail isStoredWith and take the generic path
+    if (isFixedWidth(recordDescriptor)
+        && FixedWidthDispatch<FIXED_WIDTH_MAX_SPECIALIZED>::decode(recordDescriptor.size(), (char*) page + offset, data))
+        return SUCCESS;
+
+    // Pointer to start of record
+    char *start = (char*) page + offset;
+
+    // Allocate space for null indicator. The returned null indicator may be larger than
+    // the null indicator in the table has had fields added to it
+    int nullIndicatorSize = getNullIndicatorSize(recordDescriptor.size());
+    char nullIndicator[nullIndicatorSize];
+    memset(nullIndicator, 0, nullIndicatorSize);
+
+    // Get number of columns and size of the null indicator for this record
+    RecordLength len = 0;
+    memcpy (&len, (char*)page + offset, sizeof(RecordLength));
+    int recordNullIndicatorSize = getNullIndicatorSize(len);
+
+    // Read in the existing null indicator
+    memcpy (nullIndicator, start + sizeof(RecordLength), nullIndicatorSize);
+
+    // If this new recordDescriptor has had fields added to it, we set all of the new fields to null
+    for (unsigned i = len; i < recordDescriptor.size(); i++)
+    {
+        int indicatorIndex = (i+1) / CHAR_BIT;
+        int indicatorMask  = 1 << (CHAR_BIT - 1 - (i % CHAR_BIT));
+        nullIndicator[indicatorIndex] |= indicatorMask;
+    }
+    // Write out null indicator
+    memcpy(data, nullIndicator, nullIndicatorSize);
+
+    // Initialize some offsets
+    // rec_offset: points to data in the record. We move this forward as we read data from our record
+    unsigned rec_offset = sizeof(RecordLength) + recordNullIndicatorSize + len * sizeof(ColumnOffset);
+    // data_offset: points to our current place in the output data. We move this forward as we write data to data.
+    unsigned data_offset = nullIndicatorSize;
+    // directory_base: points to the start of our directory of indices
+    char *directory_base = start + sizeof(RecordLength) + recordNullIndicatorSize;
+    
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    {
+        if (fieldIsNull(nullIndicator, i))
+            continue;
+        
+        // Grab pointer to end of this column
+        ColumnOffset endPointer;
+        memcpy(&endPointer, directory_base + i * sizeof(ColumnOffset), sizeof(ColumnOffset));
+
+        // rec_offset keeps track of start of column, so end-start = total size
+        uint32_t fieldSize = (endPointer & ~LOB_COLUMN_FLAG) - rec_offset;
+
+        // Special case for varchar, we must give data the size of varchar first
+        if (recordDescriptor[i].type == TypeVarChar)
+        {
+            uint32_t length;
+            RC rc = readVarcharValue(fileHandle, start + rec_offset, fieldSize, endPointer & LOB_COLUMN_FLAG, (char*) data + data_offset, length);
+            if (rc)
+                return rc;
+            rec_offset += fieldSize;
+            data_offset += VARCHAR_LENGTH_SIZE + length;
+            continue;
+        }
+        // Next we copy bytes equal to the size of the field and increase our offsets
+        memcpy((char*) data + data_offset, start + rec_offset, fieldSize);
+        rec_offset += fieldSize;
+        data_offset += fieldSize;
+    }
     return SUCCESS;
 }
 
-// Scan returns an iterator to allow the caller to go through the results one by one. 
-  RC RecordBasedFileManager::scan(FileHandle &fileHandle,
-      const vector<Attribute> &recordDescriptor,
-      const string &conditionAttribute,
-      const CompOp compOp,                  // comparision type such as "<" and "="
-      const void *value,                    // used in the comparison
-      const vector<string> &attributeNames, // a list of projected attributes
-      RBFM_ScanIterator &rbfm_ScanIterator)
+SlotStatus RecordBasedFileManager::getSlotStatus(SlotDirectoryRecordEntry slot)
 {
-    return rbfm_ScanIterator.scanInit(fileHandle, recordDescriptor, conditionAttribute, compOp, value, attributeNames);
+    if (slot.length == 0 && slot.offset == 0)
+        return DEAD;
+    if (slot.offset <= 0)
+        return MOVED;
+    return VALID;
 }
 
-RBFM_ScanIterator::RBFM_ScanIterator()
-: currPage(0), currSlot(0), totalPage(0), totalSlot(0)
+// Get first unused slot in page. Slot is considered unused if dead
+// If not dead slots returns recordEntriesNumber
+unsigned RecordBasedFileManager::getOpenSlot(void *page)
 {
-    rbfm = RecordBasedFileManager::instance();
+    // v2 pages keep their dead slots chained from the header
+    if (getPageFormat(page) == PAGE_FORMAT_V2)
+    {
+        SlotDirectoryHeaderV2 header = getSlotDirectoryHeaderV2(page);
+        return header.freeSlotHead == NO_FREE_SLOT ? header.recordEntriesNumber : header.freeSlotHead;
+    }
+
+    SlotDirectoryHeader header = getSlotDirectoryHeader(page);
+    unsigned i;
+    for (i = 0; i < header.recordEntriesNumber; i++)
+    {
+        SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(page, i);
+        SlotStatus status = getSlotStatus(recordEntry);
+        if (status == DEAD)
+            return i;
+    }
+    return i;
 }
 
-RC RBFM_ScanIterator::close()
+// Mark slot header as dead (all 0s)
+void RecordBasedFileManager::markSlotDeleted(void *page, unsigned i)
 {
-    free(pageData);
-    return SUCCESS;
+    SlotDirectoryRecordEntry recordEntry;
+    recordEntry.length = 0;
+    recordEntry.offset = 0;
+    setSlotDirectoryRecordEntry(page, i, recordEntry);
 }
 
-// Initialize the scanIterator with all necessary state
-RC RBFM_ScanIterator::scanInit(FileHandle &fh,
-        const vector<Attribute> rd,
-        const string &ca, 
-        const CompOp co, 
-        const void *v, 
-        const vector<string> &an)
+// Copies an already formatted record into page and returns the slot it was given.
+// The caller makes sure the page has room for the record and a new slot entry.
+unsigned RecordBasedFileManager::placeRecordOnPage(void *page, const void *record, unsigned length)
 {
-    // Start at page 0 slot 0
-    currPage = 0;
-    currSlot = 0;
-    totalPage = 0;
-    totalSlot = 0;
-    // Keep a buffer to hold the current page
-    pageData = malloc(PAGE_SIZE);
+    unsigned slotNum = getOpenSlot(page);
+    SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(page);
+    bool newSlot = slotNum == slotHeader.recordEntriesNumber;
 
-    // Store the variables passed in to
-    fileHandle = fh;
-    conditionAttribute = ca;
-    recordDescriptor = rd;
-    compOp = co;
-    value = v;
-    attributeNames = an;
+    SlotDirectoryRecordEntry newRecordEntry = allocateRecordSpace(page, length, newSlot);
+    setSlotDirectoryRecordEntry(page, slotNum, newRecordEntry);
+    if (newSlot)
+    {
+        slotHeader = getSlotDirectoryHeader(page);
+        slotHeader.recordEntriesNumber += 1;
+        setSlotDirectoryHeader(page, slotHeader);
+    }
 
-    skipList.clear();
+    memcpy((char*)page + newRecordEntry.offset, record, length);
+    return slotNum;
+}
 
-    // Get total number of pages
-    totalPage = fh.getNumberOfPages();
-    if (totalPage > 0)
+// Reserves room for a record below the free space pointer, compacting the page first if the
+// contiguous free space is too small. The caller sets the slot entry to the returned entry.
+SlotDirectoryRecordEntry RecordBasedFileManager::allocateRecordSpace(void *page, unsigned recordSize, bool newSlot)
+{
+    unsigned needed = getRecordSpaceNeeded(page, recordSize, newSlot);
+    SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(page);
+    unsigned directoryEnd = getPageFormat(page) == PAGE_FORMAT_V1
+        ? sizeof(SlotDirectoryHeader) + slotHeader.recordEntriesNumber * sizeof(SlotDirectoryRecordEntry)
+        : sizeof(SlotDirectoryHeaderV2) + slotHeader.recordEntriesNumber * sizeof(SlotDirectoryRecordEntryV2);
+    if (slotHeader.freeSpaceOffset - directoryEnd < needed)
     {
-        if (fh.readPage(0, pageData))
-            return RBFM_READ_FAILED;
+        reorganizePage(page);
+        slotHeader = getSlotDirectoryHeader(page);
+    }
+
+    SlotDirectoryRecordEntry recordEntry;
+    recordEntry.length = getRecordSpaceNeeded(page, recordSize, false);
+    recordEntry.offset = slotHeader.freeSpaceOffset - recordEntry.length;
+    slotHeader.freeSpaceOffset = recordEntry.offset;
+    setSlotDirectoryHeader(page, slotHeader);
+    return recordEntry;
+}
+
+// Compacts a v2 page only once enough of it is fragmented. v1 pages are always compacted.
+void RecordBasedFileManager::reorganizePageIfFragmented(void *page)
+{
+    if (getPageFormat(page) == PAGE_FORMAT_V1 || getSlotDirectoryHeaderV2(page).fragmentedBytes > PAGE_COMPACTION_THRESHOLD)
+        reorganizePage(page);
+}
+
+// Consolidates free space in center of page
+void RecordBasedFileManager::reorganizePage(void *page)
+{
+    if (getPageFormat(page) == PAGE_FORMAT_V2)
+    {
+        // Walk the slots, packing record and forwarding stub space against the end of the page.
+        // Records are kept in place order so each memmove only ever shifts data toward the end.
+        SlotDirectoryHeaderV2 header = getSlotDirectoryHeaderV2(page);
+        vector<pair<uint16_t, uint16_t>> owned;
+        for (unsigned i = 0; i < header.recordEntriesNumber; i++)
+        {
+            SlotDirectoryRecordEntryV2 entry = getSlotDirectoryRecordEntryV2(page, i);
+            if ((entry.offset & SLOT_V2_STATUS_MASK) != SLOT_V2_DEAD)
+                owned.push_back(make_pair(entry.offset & ~SLOT_V2_STATUS_MASK, i));
+        }
+        sort(owned.begin(), owned.end(), greater<pair<uint16_t, uint16_t>>());
+
+        uint16_t pageOffset = PAGE_SIZE;
+        for (unsigned i = 0; i < owned.size(); i++)
+        {
+            SlotDirectoryRecordEntryV2 entry = getSlotDirectoryRecordEntryV2(page, owned[i].second);
+            pageOffset -= entry.length;
+            memmove((char*)page + pageOffset, (char*)page + owned[i].first, entry.length);
+            entry.offset = (entry.offset & SLOT_V2_STATUS_MASK) | pageOffset;
+            setSlotDirectoryRecordEntryV2(page, owned[i].second, entry);
+        }
+        header.freeSpaceOffset = pageOffset;
+        header.fragmentedBytes = 0;
+        setSlotDirectoryHeaderV2(page, header);
+        return;
+    }
+
+    SlotDirectoryHeader header = getSlotDirectoryHeader(page);
+
+    // Add all live records to vector, keeping track of slot numbers
+    vector<IndexedRecordEntry> liveRecords;
+    for (unsigned i = 0; i < header.recordEntriesNumber; i++)
+    {
+        IndexedRecordEntry entry;
+        entry.slotNum = i;
+        entry.recordEntry = getSlotDirectoryRecordEntry(page, i);
+        if (getSlotStatus(entry.recordEntry) == VALID)
+            liveRecords.push_back(entry);
+    }
+    // Sort records by offset, descending
+    auto comp = [](IndexedRecordEntry first, IndexedRecordEntry second) 
+        {return first.recordEntry.offset > second.recordEntry.offset;};
+    sort(liveRecords.begin(), liveRecords.end(), comp);
+
+    // Move each record back filling in any gap preceding the record
+    uint16_t pageOffset = PAGE_SIZE;
+    SlotDirectoryRecordEntry current;
+    for (unsigned i = 0; i < liveRecords.size(); i++)
+    {
+        current = liveRecords[i].recordEntry;
+        pageOffset -= current.length;
+
+        // Use memmove rather than memcpy because locations may overlap
+        memmove((char*)page + pageOffset, (char*)page + current.offset, current.length);
+        current.offset = pageOffset;
+        setSlotDirectoryRecordEntry(page, liveRecords[i].slotNum, current);
     }
+    header.freeSpaceOffset = pageOffset;
+    setSlotDirectoryHeader(page, header);
+}
+
+RC RecordBasedFileManager::getAttributeFromRecord(FileHandle &fileHandle, void *page, unsigned offset, unsigned attrIndex, AttrType type, void *data)
+{
+    char *start = (char*)page + offset;
+    unsigned data_offset = 0;
+
+    // Get number of columns
+    RecordLength n;
+    memcpy (&n, start, sizeof(RecordLength));
+
+    // Get null indicator
+    int recordNullIndicatorSize = getNullIndicatorSize(n);
+    char recordNullIndicator[recordNullIndicatorSize];
+    memcpy (recordNullIndicator, start + sizeof(RecordLength), recordNullIndicatorSize);
+
+    // Set null indicator for result
+    char resultNullIndicator = 0;
+    if (fieldIsNull(recordNullIndicator, attrIndex))
+        resultNullIndicator |= (1 << 7);
+    memcpy(data, &resultNullIndicator, 1);
+    data_offset += 1;
+    if (resultNullIndicator) return SUCCESS;
+
+    // Now we know the result isn't null, so we grab it
+    unsigned header_offset = sizeof(RecordLength) + recordNullIndicatorSize;
+    // attrEnd points to end of attribute, attrStart points to the beginning
+    // Our directory at the beginning of each record contains pointers to the ends of each attribute,
+    // so we can pull attrEnd from that
+    ColumnOffset attrEnd, attrStart;
+    memcpy(&attrEnd, start + header_offset + attrIndex * sizeof(ColumnOffset), sizeof(ColumnOffset));
+    // The start is either the end of the previous attribute, or the start of the data section of the
+    // record if we are after the 0th attribute
+    if (attrIndex > 0)
+        memcpy(&attrStart, start + header_offset + (attrIndex - 1) * sizeof(ColumnOffset), sizeof(ColumnOffset));
     else
-        return SUCCESS;
+        attrStart = header_offset + n * sizeof(ColumnOffset);
+    // The length of any attribute is just the difference between its start and end
+    uint32_t len = (attrEnd & ~LOB_COLUMN_FLAG) - (attrStart & ~LOB_COLUMN_FLAG);
+    if (type == TypeVarChar)
+    {
+        // For varchars we have to return this length in the result
+        uint32_t length;
+        return readVarcharValue(fileHandle, start + (attrStart & ~LOB_COLUMN_FLAG), len, attrEnd & LOB_COLUMN_FLAG, (char*)data + data_offset, length);
+    }
+    // For all types, we then copy the data into the result
+    memcpy((char*)data + data_offset, start + attrStart, len);
+    return SUCCESS;
+}
+
+// Reads the page holding the record at rid into pageData, following forwarding addresses.
+// location receives where the record is stored, recordEntry its slot there.
+RC RecordBasedFileManager::readRecordPage(FileHandle &fileHandle, const RID &rid, void *pageData, RID &location,
+        SlotDirectoryRecordEntry &recordEntry)
+{
+    location = rid;
+    while (true)
+    {
+        if (fileHandle.readPage(location.pageNum, pageData))
+            return RBFM_READ_FAILED;
+        SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(pageData);
+        if (slotHeader.recordEntriesNumber <= location.slotNum)
+            return RBFM_SLOT_DN_EXIST;
+        recordEntry = getSlotDirectoryRecordEntry(pageData, location.slotNum);
+        switch (getSlotStatus(recordEntry))
+        {
+            case DEAD:
+                return RBFM_READ_AFTER_DEL;
+            case MOVED:
+                location.pageNum = recordEntry.length;
+                location.slotNum = -recordEntry.offset;
+                break;
+            case VALID:
+                return SUCCESS;
+        }
+    }
+}
+
+// Resolves attribute names to their positions in the record descriptor
+RC RecordBasedFileManager::getAttributeIndexes(const vector<Attribute> &recordDescriptor, const vector<string> &attributeNames,
+        vector<unsigned> &indexes)
+{
+    indexes.clear();
+    for (const string &name : attributeNames)
+    {
+        auto pred = [&](const Attribute &a) {return a.name == name;};
+        auto iterPos = find_if(recordDescriptor.begin(), recordDescriptor.end(), pred);
+        if (iterPos == recordDescriptor.end())
+            return RBFM_NO_SUCH_ATTR;
+        indexes.push_back(distance(recordDescriptor.begin(), iterPos));
+    }
+    return SUCCESS;
+}
+
+// Bytes getProjectedRecord() writes for the record at offset, including values stored out of line
+unsigned RecordBasedFileManager::getProjectedRecordSize(void *page, unsigned offset, const vector<Attribute> &recordDescriptor,
+        const vector<unsigned> &projection)
+{
+    unsigned size = getNullIndicatorSize(projection.size());
+    for (unsigned index : projection)
+    {
+        char *attrStart;
+        uint32_t attrLength;
+        bool isLob;
+        if (!findAttributeInRecord(page, offset, index, attrStart, attrLength, isLob))
+            continue;
+        if (recordDescriptor[index].type != TypeVarChar)
+            size += attrLength;
+        else if (isLob)
+        {
+            LobPointer pointer;
+            memcpy(&pointer, attrStart, sizeof(LobPointer));
+            size += VARCHAR_LENGTH_SIZE + pointer.length;
+        }
+        else
+            size += VARCHAR_LENGTH_SIZE + attrLength;
+    }
+    return size;
+}
+
+// Writes the attributes at positions projection of the record at offset into data, in the format of
+// readRecord() holding only those attributes. Attributes the record predates are null.
+RC RecordBasedFileManager::getProjectedRecord(FileHandle &fileHandle, void *page, unsigned offset, const vector<Attribute> &recordDescriptor,
+        const vector<unsigned> &projection, void *data)
+{
+    unsigned nullIndicatorSize = getNullIndicatorSize(projection.size());
+    char *nullIndicator = (char*) data;
+    memset(nullIndicator, 0, nullIndicatorSize);
+
+    // Keep track of offset into data
+    unsigned dataOffset = nullIndicatorSize;
+    for (unsigned i = 0; i < projection.size(); i++)
+    {
+        char *attrStart;
+        uint32_t attrLength;
+        bool isLob;
+        if (!findAttributeInRecord(page, offset, projection[i], attrStart, attrLength, isLob))
+        {
+            int indicatorIndex = i / CHAR_BIT;
+            char indicatorMask  = 1 << (CHAR_BIT - 1 - (i % CHAR_BIT));
+            nullIndicator[indicatorIndex] |= indicatorMask;
+        }
+        else if (recordDescriptor[projection[i]].type == TypeVarChar)
+        {
+            uint32_t varcharSize;
+            RC rc = readVarcharValue(fileHandle, attrStart, attrLength, isLob, (char*) data + dataOffset, varcharSize);
+            if (rc)
+                return rc;
+            dataOffset += VARCHAR_LENGTH_SIZE + varcharSize;
+        }
+        else
+        {
+            memcpy((char*) data + dataOffset, attrStart, attrLength);
+            dataOffset += attrLength;
+        }
+    }
+    return SUCCESS;
+}
+
+// Reads the records at rids in passes. Each pass visits its RIDs in page order, reading every page once,
+// decodes the records it finds into one buffer and follows moved records into the next pass.
+// The callback runs once every RID is resolved, so the records come out in the order of rids.
+RC RecordBasedFileManager::fetchRecords(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID *rids, unsigned n,
+        const vector<unsigned> &projection, const RecordBatchCallback &callback)
+{
+    void *pageData = malloc(PAGE_SIZE);
+    if (pageData == NULL)
+        return RBFM_MALLOC_FAILED;
+
+    // Where each record is looked for next, and where it ended up in records
+    vector<RID> location(rids, rids + n);
+    vector<RC> results(n, SUCCESS);
+    vector<size_t> recordOffsets(n, 0);
+    vector<char> records;
+
+    vector<unsigned> pending(n);
+    for (unsigned i = 0; i < n; i++)
+        pending[i] = i;
+
+    // A projection of the whole record decodes like readRecord(), which knows the fixed-width layouts
+    bool wholeRecord = projection.size() == recordDescriptor.size();
+    for (unsigned i = 0; wholeRecord && i < projection.size(); i++)
+        wholeRecord = projection[i] == i;
+
+    auto pageOrder = [&](unsigned first, unsigned second)
+    {
+        if (location[first].pageNum != location[second].pageNum)
+            return location[first].pageNum < location[second].pageNum;
+        return location[first].slotNum < location[second].slotNum;
+    };
+    while (!pending.empty())
+    {
+        sort(pending.begin(), pending.end(), pageOrder);
+        vector<unsigned> forwarded;
+        bool loaded = false;
+        PageNum loadedPage = 0;
+        for (unsigned i : pending)
+        {
+            const RID &rid = location[i];
+            if (!loaded || loadedPage != rid.pageNum)
+            {
+                loaded = fileHandle.readPage(rid.pageNum, pageData) == SUCCESS;
+                loadedPage = rid.pageNum;
+                if (!loaded)
+                {
+                    results[i] = RBFM_READ_FAILED;
+                    continue;
+                }
+            }
+
+            SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(pageData);
+            if (slotHeader.recordEntriesNumber <= rid.slotNum)
+            {
+                results[i] = RBFM_SLOT_DN_EXIST;
+                continue;
+            }
+            SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(pageData, rid.slotNum);
+            switch (getSlotStatus(recordEntry))
+            {
+                case DEAD:
+                    results[i] = RBFM_READ_AFTER_DEL;
+                    break;
+                // Look for it at the forwarding address in the next pass
+                case MOVED:
+                    location[i].pageNum = recordEntry.length;
+                    location[i].slotNum = -recordEntry.offset;
+                    forwarded.push_back(i);
+                    break;
+                case VALID:
+                    recordOffsets[i] = records.size();
+                    records.resize(records.size() + getProjectedRecordSize(pageData, recordEntry.offset, recordDescriptor, projection));
+                    if (wholeRecord)
+                        results[i] = getRecordAtOffset(fileHandle, pageData, recordEntry.offset, recordDescriptor,
+                            records.data() + recordOffsets[i]);
+                    else
+                        results[i] = getProjectedRecord(fileHandle, pageData, recordEntry.offset, recordDescriptor, projection,
+                            records.data() + recordOffsets[i]);
+                    break;
+            }
+        }
+        pending.swap(forwarded);
+    }
+    free(pageData);
+
+    for (unsigned i = 0; i < n; i++)
+        callback(i, results[i], results[i] == SUCCESS ? records.data() + recordOffsets[i] : NULL);
+    return SUCCESS;
+}
+
+// Points attrStart at the data of attribute attrIndex in the record at offset, without copying it.
+// Returns false if the attribute is null, or if the record predates the attribute being added.
+bool RecordBasedFileManager::findAttributeInRecord(void *page, unsigned offset, unsigned attrIndex, char *&attrStart, uint32_t &attrLength, bool &isLob)
+{
+    char *start = (char*)page + offset;
 
-    // Get number of slots on first page
-    SlotDirectoryHeader header = rbfm->getSlotDirectoryHeader(pageData);
-    totalSlot = header.recordEntriesNumber;
+    // Get number of columns
+    RecordLength n;
+    memcpy (&n, start, sizeof(RecordLength));
+    if (attrIndex >= n)
+        return false;
 
-    // If we don't need to do any comparisons, we can ignore the condition attribute
-    if (co == NO_OP)
-        return SUCCESS;
+    // Check the null indicator
+    int recordNullIndicatorSize = getNullIndicatorSize(n);
+    if (fieldIsNull(start + sizeof(RecordLength), attrIndex))
+        return false;
 
-    // Else, we need to find the condition attribute's index in the record descriptor
-    auto pred = [&](Attribute a) {return a.name == conditionAttribute;};
-    auto iterPos = find_if(recordDescriptor.begin(), recordDescriptor.end(), pred);
-    attrIndex = distance(recordDescriptor.begin(), iterPos);
-    if (attrIndex == recordDescriptor.size())
-        return RBFM_NO_SUCH_ATTR;
+    // The directory holds the end of each attribute, the start is the end of the previous one
+    unsigned header_offset = sizeof(RecordLength) + recordNullIndicatorSize;
+    ColumnOffset attrEnd, attrBegin;
+    memcpy(&attrEnd, start + header_offset + attrIndex * sizeof(ColumnOffset), sizeof(ColumnOffset));
+    if (attrIndex > 0)
+        memcpy(&attrBegin, start + header_offset + (attrIndex - 1) * sizeof(ColumnOffset), sizeof(ColumnOffset));
+    else
+        attrBegin = header_offset + n * sizeof(ColumnOffset);
+
+    // A large varchar holds a LobPointer in the record
+    isLob = attrEnd & LOB_COLUMN_FLAG;
+    attrBegin &= ~LOB_COLUMN_FLAG;
+    attrStart = start + attrBegin;
+    attrLength = (attrEnd & ~LOB_COLUMN_FLAG) - attrBegin;
+    return true;
+}
 
-    return SUCCESS;
+// Configures an empty overflow page: no slots, and no free space for records
+void RecordBasedFileManager::newOverflowPage(void *page)
+{
+    newRecordBasedPage(page);
+    SlotDirectoryHeaderV2 slotHeader = getSlotDirectoryHeaderV2(page);
+    slotHeader.flags = PAGE_FLAG_OVERFLOW;
+    slotHeader.freeSpaceOffset = sizeof(SlotDirectoryHeaderV2);
+    setSlotDirectoryHeaderV2(page, slotHeader);
+
+    OverflowPageHeader header;
+    header.nextPage = NO_NEXT_PAGE;
+    header.dataLength = 0;
+    memcpy((char*) page + sizeof(SlotDirectoryHeaderV2), &header, sizeof(OverflowPageHeader));
 }
 
-RC RBFM_ScanIterator::getNextRecord(RID &rid, void *data)
+bool RecordBasedFileManager::isOverflowPage(void *page)
 {
-    RC rc = getNextSlot();
+    return getPageFormat(page) == PAGE_FORMAT_V2 && (getSlotDirectoryHeaderV2(page).flags & PAGE_FLAG_OVERFLOW);
+}
+
+RC RecordBasedFileManager::writeLob(FileHandle &fileHandle, const void *value, uint32_t length, LobPointer &pointer)
+{
+    LobWriter writer;
+    createLob(fileHandle, writer);
+    RC rc = writer.write(value, length);
     if (rc)
         return rc;
+    return writer.close(pointer);
+}
 
-    // If we are not returning any results, we can just set the RID and return
-    if (attributeNames.size() == 0)
-    {
-        rid.pageNum = currPage;
-        rid.slotNum = currSlot++;
-        return SUCCESS;
-    }
-
-    // Prepare null indicator
-    unsigned nullIndicatorSize = rbfm->getNullIndicatorSize(attributeNames.size());
-    char nullIndicator[nullIndicatorSize];
-    memset(nullIndicator, 0, nullIndicatorSize);
-
-    SlotDirectoryRecordEntry recordEntry = rbfm->getSlotDirectoryRecordEntry(pageData, currSlot);
+// Reads the whole value into value, which must have room for pointer.length bytes
+RC RecordBasedFileManager::readLob(FileHandle &fileHandle, const LobPointer &pointer, void *value)
+{
+    LobReader reader;
+    reader.fileHandle = &fileHandle;
+    reader.isInline = false;
+    reader.pointer = pointer;
+    reader.nextPage = pointer.firstPage;
+    uint32_t bytesRead;
+    RC rc = reader.read(value, pointer.length, bytesRead);
+    if (rc == SUCCESS && bytesRead != pointer.length)
+        return RBFM_READ_FAILED;
+    return rc;
+}
 
-    // Unsure how large each attribute will be, set to size of page to be safe
-    void *buffer = malloc(PAGE_SIZE);
-    if (buffer == NULL)
+// Turns every page of the chain back into an empty record page, for inserts to reuse
+RC RecordBasedFileManager::freeLob(FileHandle &fileHandle, const LobPointer &pointer)
+{
+    void *pageData = malloc(PAGE_SIZE);
+    if (pageData == NULL)
         return RBFM_MALLOC_FAILED;
 
-    // Keep track of offset into data
-    unsigned dataOffset = nullIndicatorSize;
-
-    for (unsigned i = 0; i < attributeNames.size(); i++)
+    RC rc = SUCCESS;
+    PageNum pageNum = pointer.firstPage;
+    while (pageNum != NO_NEXT_PAGE)
     {
-        // Get index and type of attribute in record
-        auto pred = [&](Attribute a) {return a.name == attributeNames[i];};
-        auto iterPos = find_if(recordDescriptor.begin(), recordDescriptor.end(), pred);
-        unsigned index = distance(recordDescriptor.begin(), iterPos);
-        if (index == recordDescriptor.size())
-            return RBFM_NO_SUCH_ATTR;
-        AttrType type = recordDescriptor[index].type;
-
-        // Read attribute into buffer
-        rbfm->getAttributeFromRecord(pageData, recordEntry.offset, index, type, buffer);
-        // Determine if null
-        char null;
-        memcpy (&null, buffer, 1);
-        if (null)
-        {
-            int indicatorIndex = i / CHAR_BIT;
-            char indicatorMask  = 1 << (CHAR_BIT - 1 - (i % CHAR_BIT));
-            nullIndicator[indicatorIndex] |= indicatorMask;
-        }
-        // Read from buffer into data
-        else if (type == TypeInt)
+        if (fileHandle.readPage(pageNum, pageData) || !isOverflowPage(pageData))
         {
-            memcpy ((char*)data + dataOffset, (char*)buffer + 1, INT_SIZE);
-            dataOffset += INT_SIZE;
+            rc = RBFM_READ_FAILED;
+            break;
         }
-        else if (type == TypeReal)
+        OverflowPageHeader header;
+        memcpy(&header, (char*) pageData + sizeof(SlotDirectoryHeaderV2), sizeof(OverflowPageHeader));
+        newRecordBasedPage(pageData);
+        if (fileHandle.writePage(pageNum, pageData))
         {
-            memcpy ((char*)data + dataOffset, (char*)buffer + 1, REAL_SIZE);
-            dataOffset += REAL_SIZE;
+            rc = RBFM_WRITE_FAILED;
+            break;
         }
-        else if (type == TypeVarChar)
+        pageNum = header.nextPage;
+    }
+    free(pageData);
+    return rc;
+}
+
+// Collects the pointers of the values the stored record keeps out of line
+void RecordBasedFileManager::getRecordLobs(const void *record, vector<LobPointer> &lobs)
+{
+    const char *start = (const char*) record;
+    RecordLength n;
+    memcpy(&n, start, sizeof(RecordLength));
+    unsigned header_offset = sizeof(RecordLength) + getNullIndicatorSize(n);
+
+    ColumnOffset attrBegin = header_offset + n * sizeof(ColumnOffset);
+    for (unsigned i = 0; i < n; i++)
+    {
+        ColumnOffset attrEnd;
+        memcpy(&attrEnd, start + header_offset + i * sizeof(ColumnOffset), sizeof(ColumnOffset));
+        if (attrEnd & LOB_COLUMN_FLAG)
         {
-            uint32_t varcharSize;
-            memcpy(&varcharSize, (char*)buffer + 1, VARCHAR_LENGTH_SIZE);
-            memcpy((char*)data + dataOffset, &varcharSize, VARCHAR_LENGTH_SIZE);
-            dataOffset += VARCHAR_LENGTH_SIZE;
-            memcpy((char*)data + dataOffset, (char*)buffer + 1 + VARCHAR_LENGTH_SIZE, varcharSize);
-            dataOffset += varcharSize;
+            LobPointer pointer;
+            memcpy(&pointer, start + attrBegin, sizeof(LobPointer));
+            lobs.push_back(pointer);
         }
+        attrBegin = attrEnd & ~LOB_COLUMN_FLAG;
     }
-    // Finally set null indicator of data, clean up and return
-    memcpy((char*)data, nullIndicator, nullIndicatorSize);
-
-    free (buffer);
-    rid.pageNum = currPage;
-    rid.slotNum = currSlot++;
-    return SUCCESS;
 }
 
-// Private helper methods ///////////////////////////////////////////////////////////////////
-
-RC RBFM_ScanIterator::getNextSlot()
+RC RecordBasedFileManager::freeLobs(FileHandle &fileHandle, const vector<LobPointer> &lobs)
 {
-    // If we're done with the current page, or we've read the last page
-    if (currSlot >= totalSlot || currPage >= totalPage)
+    for (const LobPointer &pointer : lobs)
     {
-        // Reinitialize the current slot and increment page number
-        currSlot = 0;
-        currPage++;
-        // If we're done with last page, return EOF
-        if (currPage >= totalPage)
-            return RBFM_EOF;
-        // Otherwise get next page ready
-        RC rc = getNextPage();
+        RC rc = freeLob(fileHandle, pointer);
         if (rc)
             return rc;
     }
+    return SUCCESS;
+}
 
-    // Get slot header, check to see if valid and meets scan condition
-    SlotDirectoryRecordEntry recordEntry = rbfm->getSlotDirectoryRecordEntry(pageData, currSlot);
-
-    if (rbfm->getSlotStatus(recordEntry) != VALID || !checkScanCondition())
+// Writes a varchar in API format ([length][characters]) to data, reading it from its overflow pages if isLob
+RC RecordBasedFileManager::readVarcharValue(FileHandle &fileHandle, const char *attrStart, uint32_t attrLength, bool isLob,
+        void *data, uint32_t &length)
+{
+    if (!isLob)
     {
-        // If not, try next slot
-        currSlot++;
-        return getNextSlot();
+        length = attrLength;
+        memcpy(data, &length, VARCHAR_LENGTH_SIZE);
+        memcpy((char*) data + VARCHAR_LENGTH_SIZE, attrStart, length);
+        return SUCCESS;
     }
-    return SUCCESS;
+    LobPointer pointer;
+    memcpy(&pointer, attrStart, sizeof(LobPointer));
+    length = pointer.length;
+    memcpy(data, &length, VARCHAR_LENGTH_SIZE);
+    return readLob(fileHandle, pointer, (char*) data + VARCHAR_LENGTH_SIZE);
 }
 
-RC RBFM_ScanIterator::getNextPage()
+// Configures an empty record page of a clustered file
+void RecordBasedFileManager::newClusteredPage(void *page)
 {
-    // Read in page
-    if (fileHandle.readPage(currPage, pageData))
-        return RBFM_READ_FAILED;
+    newRecordBasedPage(page);
+    SlotDirectoryHeaderV2 slotHeader = getSlotDirectoryHeaderV2(page);
+    slotHeader.flags = PAGE_FLAG_CLUSTERED;
+    setSlotDirectoryHeaderV2(page, slotHeader);
+}
 
-    // Update slot total
-    SlotDirectoryHeader header = rbfm->getSlotDirectoryHeader(pageData);
-    totalSlot = header.recordEntriesNumber;
-    return SUCCESS;
+bool RecordBasedFileManager::isClusterHeaderPage(void *page)
+{
+    return getPageFormat(page) == PAGE_FORMAT_V2 && (getSlotDirectoryHeaderV2(page).flags & PAGE_FLAG_CLUSTER_HEADER);
 }
 
-bool RBFM_ScanIterator::checkScanCondition()
+// Loads the directory of the clustered file whose header page is in headerPage
+RC RecordBasedFileManager::readClusterDirectory(FileHandle &fileHandle, void *headerPage, ClusterHeader &header,
+        vector<ClusterDirectoryEntry> &entries)
 {
-    if (compOp == NO_OP) return true;
-    if (value == NULL) return false;
-    Attribute attr = recordDescriptor[attrIndex];
-    // Allocate enough memory to hold attribute and 1 byte null indicator
-    void *data = malloc(1 + attr.length);
-    // Get record entry to get offset
-    SlotDirectoryRecordEntry recordEntry = rbfm->getSlotDirectoryRecordEntry(pageData, currSlot);
-    // Grab the given attribute and store it in data
-    rbfm->getAttributeFromRecord(pageData, recordEntry.offset, attrIndex, attr.type, data);
+    memcpy(&header, (char*) headerPage + sizeof(SlotDirectoryHeaderV2), sizeof(ClusterHeader));
 
-    char null;
-    memcpy(&null, data, 1);
+    string bytes((char*) headerPage + CLUSTER_DIRECTORY_OFFSET, min(header.directoryLength, (uint32_t) CLUSTER_HEADER_CAPACITY));
+    if (bytes.size() < header.directoryLength)
+    {
+        void *pageData = malloc(PAGE_SIZE);
+        if (pageData == NULL)
+            return RBFM_MALLOC_FAILED;
+        PageNum pageNum = header.nextPage;
+        while (pageNum != NO_NEXT_PAGE && bytes.size() < header.directoryLength)
+        {
+            if (fileHandle.readPage(pageNum, pageData) || !isOverflowPage(pageData))
+                break;
+            OverflowPageHeader overflowHeader;
+            memcpy(&overflowHeader, (char*) pageData + sizeof(SlotDirectoryHeaderV2), sizeof(OverflowPageHeader));
+            bytes.append((char*) pageData + OVERFLOW_DATA_OFFSET, overflowHeader.dataLength);
+            pageNum = overflowHeader.nextPage;
+        }
+        free(pageData);
+    }
+    if (bytes.size() != header.directoryLength)
+        return RBFM_READ_FAILED;
 
-    bool result = false;
-    if (null)
+    entries.clear();
+    unsigned offset = 0;
+    while (offset < bytes.size())
     {
-        result = false;
+        ClusterDirectoryEntry entry;
+        uint32_t keyLength;
+        memcpy(&entry.pageNum, bytes.data() + offset, sizeof(PageNum));
+        memcpy(&keyLength, bytes.data() + offset + sizeof(PageNum), sizeof(uint32_t));
+        offset += sizeof(PageNum) + sizeof(uint32_t);
+        entry.key = bytes.substr(offset, keyLength);
+        offset += keyLength;
+        entries.push_back(entry);
     }
-    // Checkscan condition on record data and scan value
-    else if (attr.type == TypeInt)
+    return SUCCESS;
+}
+
+// Stores the directory and header, then writes the header page. The continuation pages are rewritten in place
+// and new ones appended as the directory grows (it never shrinks, pages are only ever added to it).
+RC RecordBasedFileManager::writeClusterDirectory(FileHandle &fileHandle, void *headerPage, ClusterHeader &header,
+        const vector<ClusterDirectoryEntry> &entries)
+{
+    string bytes;
+    for (const ClusterDirectoryEntry &entry : entries)
     {
-        int32_t recordInt;
-        memcpy(&recordInt, (char*)data + 1, INT_SIZE);
-        result = checkScanCondition(recordInt, compOp, value);
+        uint32_t keyLength = entry.key.size();
+        bytes.append((const char*) &entry.pageNum, sizeof(PageNum));
+        bytes.append((const char*) &keyLength, sizeof(uint32_t));
+        bytes.append(entry.key);
     }
-    else if (attr.type == TypeReal)
+    header.directoryLength = bytes.size();
+
+    void *pageData = malloc(PAGE_SIZE);
+    if (pageData == NULL)
+        return RBFM_MALLOC_FAILED;
+
+    // Find the pages already in the chain, and add as many as the rest of the directory needs
+    vector<PageNum> chain;
+    PageNum pageNum = header.nextPage;
+    while (pageNum != NO_NEXT_PAGE)
     {
-        float recordReal;
-        memcpy(&recordReal, (char*)data + 1, REAL_SIZE);
-        result = checkScanCondition(recordReal, compOp, value);
+        if (fileHandle.readPage(pageNum, pageData))
+        {
+            free(pageData);
+            return RBFM_READ_FAILED;
+        }
+        chain.push_back(pageNum);
+        OverflowPageHeader overflowHeader;
+        memcpy(&overflowHeader, (char*) pageData + sizeof(SlotDirectoryHeaderV2), sizeof(OverflowPageHeader));
+        pageNum = overflowHeader.nextPage;
     }
-    else if (attr.type == TypeVarChar)
+    unsigned existing = chain.size();
+    unsigned rest = bytes.size() > CLUSTER_HEADER_CAPACITY ? bytes.size() - CLUSTER_HEADER_CAPACITY : 0;
+    unsigned needed = (rest + OVERFLOW_PAGE_CAPACITY - 1) / OVERFLOW_PAGE_CAPACITY;
+    for (unsigned i = existing; i < needed; i++)
+        chain.push_back(fileHandle.getNumberOfPages() + i - existing);
+
+    unsigned offset = min((unsigned) bytes.size(), (unsigned) CLUSTER_HEADER_CAPACITY);
+    RC rc = SUCCESS;
+    for (unsigned i = 0; i < chain.size() && rc == SUCCESS; i++)
     {
-        uint32_t varcharSize;
-        memcpy(&varcharSize, (char*)data + 1, VARCHAR_LENGTH_SIZE);
-        char recordString[varcharSize + 1];
-        memcpy(recordString, (char*)data + 1 + VARCHAR_LENGTH_SIZE, varcharSize);
-        recordString[varcharSize] = '\0';
-
-        result = checkScanCondition(recordString, compOp, value);
+        newOverflowPage(pageData);
+        OverflowPageHeader overflowHeader;
+        overflowHeader.nextPage = i + 1 < chain.size() ? chain[i + 1] : NO_NEXT_PAGE;
+        overflowHeader.dataLength = min((unsigned) bytes.size() - offset, (unsigned) OVERFLOW_PAGE_CAPACITY);
+        memcpy((char*) pageData + sizeof(SlotDirectoryHeaderV2), &overflowHeader, sizeof(OverflowPageHeader));
+        memcpy((char*) pageData + OVERFLOW_DATA_OFFSET, bytes.data() + offset, overflowHeader.dataLength);
+        offset += overflowHeader.dataLength;
+
+        if (i < existing)
+            rc = fileHandle.writePage(chain[i], pageData) ? RBFM_WRITE_FAILED : SUCCESS;
+        else
+            rc = fileHandle.appendPage(pageData) ? RBFM_APPEND_FAILED : SUCCESS;
     }
-    free (data);
-    return result;
+    free(pageData);
+    if (rc)
+        return rc;
+
+    header.nextPage = chain.empty() ? NO_NEXT_PAGE : chain[0];
+    memcpy((char*) headerPage + sizeof(SlotDirectoryHeaderV2), &header, sizeof(ClusterHeader));
+    memcpy((char*) headerPage + CLUSTER_DIRECTORY_OFFSET, bytes.data(), min((unsigned) bytes.size(), (unsigned) CLUSTER_HEADER_CAPACITY));
+    if (fileHandle.writePage(0, headerPage))
+        return RBFM_WRITE_FAILED;
+    return SUCCESS;
 }
 
-bool RBFM_ScanIterator::checkScanCondition(int recordInt, CompOp compOp, const void *value)
+// Copies the key of a stored record into key, in the format of a scan value. A null key leaves key empty.
+RC RecordBasedFileManager::getClusterKey(const void *record, const ClusterHeader &header, string &key)
 {
-    int32_t intValue;
-    memcpy (&intValue, value, INT_SIZE);
+    key.clear();
+    char *attrStart;
+    uint32_t attrLength;
+    bool isLob;
+    if (!findAttributeInRecord((void*) record, 0, header.keyIndex, attrStart, attrLength, isLob))
+        return SUCCESS;
+    // Keys are compared in place, they have to be stored in the record
+    if (isLob)
+        return RBFM_BAD_FIELD;
+    if (header.keyType == TypeVarChar)
+        key.append((const char*) &attrLength, VARCHAR_LENGTH_SIZE);
+    key.append(attrStart, attrLength);
+    return SUCCESS;
+}
 
-    switch (compOp)
+// Returns a negative number, zero or a positive number as first sorts before, with or after second
+int RecordBasedFileManager::compareClusterKeys(AttrType type, const string &first, const string &second)
+{
+    if (first.empty() || second.empty())
+        return (int) !first.empty() - (int) !second.empty();
+
+    switch (type)
     {
-        case EQ_OP: return recordInt == intValue;
-        case LT_OP: return recordInt < intValue;
-        case GT_OP: return recordInt > intValue;
-        case LE_OP: return recordInt <= intValue;
-        case GE_OP: return recordInt >= intValue;
-        case NE_OP: return recordInt != intValue;
-        case NO_OP: return true;
-        // Should never happen
-        default: return false;
+        case TypeInt:
+        {
+            int32_t a, b;
+            memcpy(&a, first.data(), INT_SIZE);
+            memcpy(&b, second.data(), INT_SIZE);
+            return (a > b) - (a < b);
+        }
+        case TypeReal:
+        {
+            float a, b;
+            memcpy(&a, first.data(), REAL_SIZE);
+            memcpy(&b, second.data(), REAL_SIZE);
+            return (a > b) - (a < b);
+        }
+        case TypeVarChar:
+            return first.compare(VARCHAR_LENGTH_SIZE, string::npos, second, VARCHAR_LENGTH_SIZE, string::npos);
     }
+    return 0;
 }
 
-bool RBFM_ScanIterator::checkScanCondition(float recordReal, CompOp compOp, const void *value)
+// Index of the directory entry a record with key goes to: the last one whose key is not above it
+unsigned RecordBasedFileManager::findClusterEntry(AttrType type, const vector<ClusterDirectoryEntry> &entries, const string &key)
 {
-    float realValue;
-    memcpy (&realValue, value, REAL_SIZE);
+    auto comp = [&](const string &value, const ClusterDirectoryEntry &entry) {return compareClusterKeys(type, value, entry.key) < 0;};
+    unsigned after = distance(entries.begin(), upper_bound(entries.begin(), entries.end(), key, comp));
+    return after == 0 ? 0 : after - 1;
+}
 
-    switch (compOp)
+// True if a record with key may stay on pageNum without breaking the directory's key ranges
+bool RecordBasedFileManager::clusterKeyBelongsOnPage(const ClusterHeader &header, const vector<ClusterDirectoryEntry> &entries,
+        const string &key, PageNum pageNum)
+{
+    AttrType type = (AttrType) header.keyType;
+    for (unsigned i = 0; i < entries.size(); i++)
     {
-        case EQ_OP: return recordReal == realValue;
-        case LT_OP: return recordReal < realValue;
-        case GT_OP: return recordReal > realValue;
-        case LE_OP: return recordReal <= realValue;
-        case GE_OP: return recordReal >= realValue;
-        case NE_OP: return recordReal != realValue;
-        case NO_OP: return true;
-        // Should never happen
-        default: return false;
+        if (entries[i].pageNum != pageNum)
+            continue;
+        bool aboveStart = i == 0 || compareClusterKeys(type, entries[i].key, key) <= 0;
+        bool belowEnd = i + 1 == entries.size() || compareClusterKeys(type, key, entries[i + 1].key) <= 0;
+        return aboveStart && belowEnd;
     }
+    return false;
 }
 
-bool RBFM_ScanIterator::checkScanCondition(char *recordString, CompOp compOp, const void *value)
+// Places a record on the page covering its key, splitting that page until the record fits
+RC RecordBasedFileManager::insertClusteredRecord(FileHandle &fileHandle, void *headerPage, const void *record, unsigned recordSize, RID &rid)
 {
-    if (compOp == NO_OP)
-        return true;
+    ClusterHeader header;
+    vector<ClusterDirectoryEntry> entries;
+    RC rc = readClusterDirectory(fileHandle, headerPage, header, entries);
+    if (rc)
+        return rc;
+    string key;
+    rc = getClusterKey(record, header, key);
+    if (rc)
+        return rc;
 
-    int32_t valueSize;
-    memcpy(&valueSize, value, VARCHAR_LENGTH_SIZE);
-    char valueStr[valueSize + 1];
-    valueStr[valueSize] = '\0';
-    memcpy(valueStr, (char*) value + VARCHAR_LENGTH_SIZE, valueSize);
+    void *pageData = malloc(PAGE_SIZE);
+    if (pageData == NULL)
+        return RBFM_MALLOC_FAILED;
 
-    int cmp = strcmp(recordString, valueStr);
-    switch (compOp)
+    // The first record starts the directory
+    if (entries.empty())
     {
-        case EQ_OP: return cmp == 0;
-        case LT_OP: return cmp <  0;
-        case GT_OP: return cmp >  0;
-        case LE_OP: return cmp <= 0;
-        case GE_OP: return cmp >= 0;
-        case NE_OP: return cmp != 0;
-        // Should never happen
-        default: return false;
+        ClusterDirectoryEntry entry;
+        entry.key = key;
+        entry.pageNum = fileHandle.getNumberOfPages();
+        newClusteredPage(pageData);
+        if (fileHandle.appendPage(pageData))
+            rc = RBFM_APPEND_FAILED;
+        else
+        {
+            entries.push_back(entry);
+            rc = writeClusterDirectory(fileHandle, headerPage, header, entries);
+        }
     }
-}
 
-// Configures a new record based page, and puts it in "page".
-void RecordBasedFileManager::newRecordBasedPage(void * page)
-{
-    memset(page, 0, PAGE_SIZE);
-    // Writes the slot directory header.
-    SlotDirectoryHeader slotHeader;
-    slotHeader.freeSpaceOffset = PAGE_SIZE;
-    slotHeader.recordEntriesNumber = 0;
-    setSlotDirectoryHeader(page, slotHeader);
-}
+    while (rc == SUCCESS)
+    {
+        unsigned entryIndex = findClusterEntry((AttrType) header.keyType, entries, key);
+        PageNum pageNum = entries[entryIndex].pageNum;
+        if (fileHandle.readPage(pageNum, pageData))
+        {
+            rc = RBFM_READ_FAILED;
+            break;
+        }
 
-SlotDirectoryHeader RecordBasedFileManager::getSlotDirectoryHeader(void * page)
-{
-    // Getting the slot directory header.
-    SlotDirectoryHeader slotHeader;
-    memcpy (&slotHeader, page, sizeof(SlotDirectoryHeader));
-    return slotHeader;
-}
+        if (getPageFreeSpaceSize(pageData) >= getRecordSpaceNeeded(pageData, recordSize, true))
+        {
+            rid.pageNum = pageNum;
+            rid.slotNum = placeRecordOnPage(pageData, record, recordSize);
+            rc = fileHandle.writePage(pageNum, pageData) ? RBFM_WRITE_FAILED : SUCCESS;
+            break;
+        }
 
-void RecordBasedFileManager::setSlotDirectoryHeader(void * page, SlotDirectoryHeader slotHeader)
-{
-    // Setting the slot directory header.
-    memcpy (page, &slotHeader, sizeof(SlotDirectoryHeader));
+        // Every split leaves the page covering key with fewer records, so this ends with the record
+        // on a page it fits on, at worst one of its own
+        rc = splitClusteredPage(fileHandle, headerPage, header, entries, entryIndex, pageData, key);
+    }
+    free(pageData);
+    return rc;
 }
 
-SlotDirectoryRecordEntry RecordBasedFileManager::getSlotDirectoryRecordEntry(void * page, unsigned recordEntryNumber)
+// Splits the full page of entries[entryIndex], held in pageData, for a record with key to be inserted.
+// The upper half of its records by key move to a new page, leaving forwarding stubs so their RIDs stay valid.
+// When all its records share one key, they either stay put and key gets a new page, or all move so that
+// key, which sorts before them, has this page to itself. On the last page, a key not below any on it starts
+// a new page instead, taking only the records with that key along: with ever increasing keys, splitting at
+// the median would leave every page half empty.
+RC RecordBasedFileManager::splitClusteredPage(FileHandle &fileHandle, void *headerPage, ClusterHeader &header,
+        vector<ClusterDirectoryEntry> &entries, unsigned entryIndex, void *pageData, const string &key)
 {
-    // Getting the slot directory entry data.
-    SlotDirectoryRecordEntry recordEntry;
-    memcpy  (
-            &recordEntry,
-            ((char*) page + sizeof(SlotDirectoryHeader) + recordEntryNumber * sizeof(SlotDirectoryRecordEntry)),
-            sizeof(SlotDirectoryRecordEntry)
-            );
+    AttrType type = (AttrType) header.keyType;
 
-    return recordEntry;
-}
+    // Sort the records on the page by key
+    vector<pair<string, unsigned>> records;
+    SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(pageData);
+    for (unsigned slotNum = 0; slotNum < slotHeader.recordEntriesNumber; slotNum++)
+    {
+        SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(pageData, slotNum);
+        if (getSlotStatus(recordEntry) != VALID)
+            continue;
+        string recordKey;
+        RC rc = getClusterKey((char*) pageData + recordEntry.offset, header, recordKey);
+        if (rc)
+            return rc;
+        records.push_back(make_pair(recordKey, slotNum));
+    }
+    auto comp = [&](const pair<string, unsigned> &first, const pair<string, unsigned> &second)
+        {return compareClusterKeys(type, first.first, second.first) < 0;};
+    stable_sort(records.begin(), records.end(), comp);
+    auto sameKey = [&](unsigned i) {return compareClusterKeys(type, records[i - 1].first, records[i].first) == 0;};
+
+    // Records from position split on move. Records with the same key stay together.
+    unsigned count = records.size();
+    unsigned split;
+    ClusterDirectoryEntry newEntry;
+    unsigned tail = 0;
+    if (entryIndex + 1 == entries.size() && count > 0 && compareClusterKeys(type, key, records.back().first) >= 0)
+    {
+        tail = count;
+        while (tail > 0 && compareClusterKeys(type, records[tail - 1].first, key) == 0)
+            tail--;
+    }
+    if (tail > 0)
+    {
+        split = tail;
+        newEntry.key = key;
+    }
+    else if (count > 0 && !comp(records.front(), records.back()))
+    {
+        bool keyFirst = compareClusterKeys(type, key, records.front().first) < 0;
+        split = keyFirst ? 0 : count;
+        newEntry.key = keyFirst ? records.front().first : key;
+    }
+    else if (count == 0)
+    {
+        split = 0;
+        newEntry.key = key;
+    }
+    else
+    {
+        split = count / 2;
+        while (split < count && sameKey(split))
+            split++;
+        if (split == count)
+        {
+            split = count / 2;
+            while (sameKey(split))
+                split--;
+        }
+        newEntry.key = records[split].first;
+    }
 
-void RecordBasedFileManager::setSlotDirectoryRecordEntry(void * page, unsigned recordEntryNumber, SlotDirectoryRecordEntry recordEntry)
-{
-    // Setting the slot directory entry data.
-    memcpy  (
-            ((char*) page + sizeof(SlotDirectoryHeader) + recordEntryNumber * sizeof(SlotDirectoryRecordEntry)),
-            &recordEntry,
-            sizeof(SlotDirectoryRecordEntry)
-            );
-}
+    void *newPage = malloc(PAGE_SIZE);
+    if (newPage == NULL)
+        return RBFM_MALLOC_FAILED;
+    newClusteredPage(newPage);
+    newEntry.pageNum = fileHandle.getNumberOfPages();
+
+    for (unsigned i = split; i < count; i++)
+    {
+        SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(pageData, records[i].second);
+        unsigned newSlot = placeRecordOnPage(newPage, (char*) pageData + recordEntry.offset, recordEntry.length);
+        recordEntry.length = newEntry.pageNum;
+        recordEntry.offset = -newSlot;
+        setSlotDirectoryRecordEntry(pageData, records[i].second, recordEntry);
+    }
+    reorganizePageIfFragmented(pageData);
+
+    // The new page goes out before any record points at it
+    RC rc = SUCCESS;
+    if (fileHandle.appendPage(newPage))
+        rc = RBFM_APPEND_FAILED;
+    else if (split < count && fileHandle.writePage(entries[entryIndex].pageNum, pageData))
+        rc = RBFM_WRITE_FAILED;
+    free(newPage);
+    if (rc)
+        return rc;
 
-// Computes the free space of a page (function of the free space pointer and the slot directory size).
-unsigned RecordBasedFileManager::getPageFreeSpaceSize(void * page) 
-{
-    SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(page);
-    return slotHeader.freeSpaceOffset - slotHeader.recordEntriesNumber * sizeof(SlotDirectoryRecordEntry) - sizeof(SlotDirectoryHeader);
+    // The first page takes anything below the second page's key, keep its key no greater
+    if (entryIndex == 0 && compareClusterKeys(type, newEntry.key, entries[0].key) < 0)
+        entries[0].key = newEntry.key;
+    entries.insert(entries.begin() + entryIndex + 1, newEntry);
+    return writeClusterDirectory(fileHandle, headerPage, header, entries);
 }
 
-unsigned RecordBasedFileManager::getRecordSize(const vector<Attribute> &recordDescriptor, const void *data) 
+// After a clustered insert, reloads the page of rid into pageData. If a split moved the record at rid
+// to another page, the moved copy is dropped, as rid is about to point at the record's new version.
+RC RecordBasedFileManager::dropSplitCopy(FileHandle &fileHandle, void *pageData, const RID &rid)
 {
-    // Read in the null indicator
-    int nullIndicatorSize = getNullIndicatorSize(recordDescriptor.size());
-    char nullIndicator[nullIndicatorSize];
-    memset(nullIndicator, 0, nullIndicatorSize);
-    memcpy(nullIndicator, (char*) data, nullIndicatorSize);
-
-    // Offset into *data. Start just after null indicator
-    unsigned offset = nullIndicatorSize;
-    // Running count of size. Initialize to size of header
-    unsigned size = sizeof (RecordLength) + (recordDescriptor.size()) * sizeof(ColumnOffset) + nullIndicatorSize;
+    if (fileHandle.readPage(rid.pageNum, pageData))
+        return RBFM_READ_FAILED;
+    SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(pageData, rid.slotNum);
+    if (getSlotStatus(recordEntry) != MOVED)
+        return SUCCESS;
 
-    for (unsigned i = 0; i < (unsigned) recordDescriptor.size(); i++)
+    void *copyPage = malloc(PAGE_SIZE);
+    if (copyPage == NULL)
+        return RBFM_MALLOC_FAILED;
+    RC rc = SUCCESS;
+    PageNum copyPageNum = recordEntry.length;
+    if (fileHandle.readPage(copyPageNum, copyPage))
+        rc = RBFM_READ_FAILED;
+    else
     {
-        // Skip null fields
-        if (fieldIsNull(nullIndicator, i))
-            continue;
-        switch (recordDescriptor[i].type)
-        {
-            case TypeInt:
-                size += INT_SIZE;
-                offset += INT_SIZE;
-            break;
-            case TypeReal:
-                size += REAL_SIZE;
-                offset += REAL_SIZE;
-            break;
-            case TypeVarChar:
-                uint32_t varcharSize;
-                // We have to get the size of the VarChar field by reading the integer that precedes the string value itself
-                memcpy(&varcharSize, (char*) data + offset, VARCHAR_LENGTH_SIZE);
-                size += varcharSize;
-                offset += varcharSize + VARCHAR_LENGTH_SIZE;
-            break;
-        }
+        markSlotDeleted(copyPage, -recordEntry.offset);
+        reorganizePageIfFragmented(copyPage);
+        if (fileHandle.writePage(copyPageNum, copyPage))
+            rc = RBFM_WRITE_FAILED;
     }
-
-    return size;
+    free(copyPage);
+    return rc;
 }
 
-// Calculate actual bytes for nulls-indicator for the given field counts
-int RecordBasedFileManager::getNullIndicatorSize(int fieldCount) 
+// Configures an empty page of an append-only file
+void RecordBasedFileManager::newAppendOnlyPage(void *page)
 {
-    return int(ceil((double) fieldCount / CHAR_BIT));
+    newRecordBasedPage(page);
+    SlotDirectoryHeaderV2 slotHeader = getSlotDirectoryHeaderV2(page);
+    slotHeader.flags = PAGE_FLAG_APPEND_ONLY;
+    setSlotDirectoryHeaderV2(page, slotHeader);
 }
 
-bool RecordBasedFileManager::fieldIsNull(char *nullIndicator, int i)
+bool RecordBasedFileManager::isAppendOnlyPage(void *page)
 {
-    int indicatorIndex = i / CHAR_BIT;
-    int indicatorMask  = 1 << (CHAR_BIT - 1 - (i % CHAR_BIT));
-    return (nullIndicator[indicatorIndex] & indicatorMask) != 0;
+    return getPageFormat(page) == PAGE_FORMAT_V2 && (getSlotDirectoryHeaderV2(page).flags & PAGE_FLAG_APPEND_ONLY);
 }
 
-void RecordBasedFileManager::setRecordAtOffset(void *page, unsigned offset, const vector<Attribute> &recordDescriptor, const void *data)
+// Copies a record into a new slot at the end of the slot directory and returns the slot.
+// The caller makes sure the page has room for the record and a new slot entry.
+unsigned RecordBasedFileManager::appendRecordToPage(void *page, const void *record, unsigned recordSize)
 {
-    // Read in the null indicator
-    int nullIndicatorSize = getNullIndicatorSize(recordDescriptor.size());
-    char nullIndicator[nullIndicatorSize];
-    memset (nullIndicator, 0, nullIndicatorSize);
-    memcpy(nullIndicator, (char*) data, nullIndicatorSize);
+    SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(page);
+    unsigned slotNum = slotHeader.recordEntriesNumber;
+    SlotDirectoryRecordEntry recordEntry = allocateRecordSpace(page, recordSize, true);
+    setSlotDirectoryRecordEntry(page, slotNum, recordEntry);
 
-    // Points to start of record
-    char *start = (char*) page + offset;
+    slotHeader = getSlotDirectoryHeader(page);
+    slotHeader.recordEntriesNumber += 1;
+    setSlotDirectoryHeader(page, slotHeader);
 
-    // Offset into *data
-    unsigned data_offset = nullIndicatorSize;
-    // Offset into page header
-    unsigned header_offset = 0;
+    memcpy((char*) page + recordEntry.offset, record, recordSize);
+    return slotNum;
+}
 
-    RecordLength len = recordDescriptor.size();
-    memcpy(start + header_offset, &len, sizeof(len));
-    header_offset += sizeof(len);
+// Adds a record to the last page of an append-only file, or to a new page after it.
+// pageData holds page 0 on entry and is used as the buffer for the last page.
+RC RecordBasedFileManager::appendEncodedRecord(FileHandle &fileHandle, void *pageData, const void *record, unsigned recordSize, RID &rid)
+{
+    PageNum lastPage = fileHandle.getNumberOfPages() - 1;
+    if (lastPage != 0 && fileHandle.readPage(lastPage, pageData))
+        return RBFM_READ_FAILED;
 
-    memcpy(start + header_offset, nullIndicator, nullIndicatorSize);
-    header_offset += nullIndicatorSize;
+    // The last page may be a large value's, which takes no records
+    if (isAppendOnlyPage(pageData) && getPageFreeSpaceSize(pageData) >= getRecordSpaceNeeded(pageData, recordSize, true))
+    {
+        rid.pageNum = lastPage;
+        rid.slotNum = appendRecordToPage(pageData, record, recordSize);
+        return fileHandle.writePage(lastPage, pageData) ? RBFM_WRITE_FAILED : SUCCESS;
+    }
 
-    // Keeps track of the offset of each record
-    // Offset is relative to the start of the record and points to the END of a field
-    ColumnOffset rec_offset = header_offset + (recordDescriptor.size()) * sizeof(ColumnOffset);
+    newAppendOnlyPage(pageData);
+    rid.pageNum = lastPage + 1;
+    rid.slotNum = appendRecordToPage(pageData, record, recordSize);
+    return fileHandle.appendPage(pageData) ? RBFM_APPEND_FAILED : SUCCESS;
+}
+
+// Parses one line of delimited text into data, in the format of insertRecord(). Returns false if the line
+// does not hold one valid field per attribute. hasLob is set if a varchar will be stored out of line.
+bool RecordBasedFileManager::parseDelimitedRow(const vector<Attribute> &recordDescriptor, const char *line, size_t length,
+        char delimiter, vector<char> &data, bool &hasLob)
+{
+    hasLob = false;
+    int nullIndicatorSize = getNullIndicatorSize(recordDescriptor.size());
+    data.assign(nullIndicatorSize, 0);
 
-    unsigned i = 0;
-    for (i = 0; i < recordDescriptor.size(); i++)
+    size_t pos = 0;
+    string value;
+    for (unsigned i = 0; i < recordDescriptor.size(); i++)
     {
-        if (!fieldIsNull(nullIndicator, i))
+        if (i > 0)
         {
-            // Points to current position in *data
-            char *data_start = (char*) data + data_offset;
+            if (pos >= length || line[pos] != delimiter)
+                return false;
+            pos++;
+        }
 
-            // Read in the data for the next column, point rec_offset to end of newly inserted data
-            switch (recordDescriptor[i].type)
+        value.clear();
+        bool quoted = pos < length && line[pos] == '"';
+        if (quoted)
+        {
+            pos++;
+            while (true)
             {
-                case TypeInt:
-                    memcpy (start + rec_offset, data_start, INT_SIZE);
-                    rec_offset += INT_SIZE;
-                    data_offset += INT_SIZE;
+                if (pos >= length)
+                    return false;
+                if (line[pos] == '"')
+                {
+                    if (pos + 1 < length && line[pos + 1] == '"')
+                    {
+                        value += '"';
+                        pos += 2;
+                        continue;
+                    }
+                    pos++;
+                    break;
+                }
+                value += line[pos++];
+            }
+        }
+        else
+        {
+            size_t fieldStart = pos;
+            while (pos < length && line[pos] != delimiter)
+                pos++;
+            value.assign(line + fieldStart, pos - fieldStart);
+        }
+
+        if (value.empty() && !quoted)
+        {
+            data[i / CHAR_BIT] |= 1 << (CHAR_BIT - 1 - i % CHAR_BIT);
+            continue;
+        }
+
+        char *end;
+        errno = 0;
+        switch (recordDescriptor[i].type)
+        {
+            case TypeInt:
+            {
+                long number = strtol(value.c_str(), &end, 10);
+                if (*end != '\0' || errno || number < INT32_MIN || number > INT32_MAX)
+                    return false;
+                int32_t field = number;
+                data.insert(data.end(), (char*) &field, (char*) &field + INT_SIZE);
                 break;
-                case TypeReal:
-                    memcpy (start + rec_offset, data_start, REAL_SIZE);
-                    rec_offset += REAL_SIZE;
-                    data_offset += REAL_SIZE;
+            }
+            case TypeReal:
+            {
+                float field = strtof(value.c_str(), &end);
+                if (*end != '\0' || errno)
+                    return false;
+                data.insert(data.end(), (char*) &field, (char*) &field + REAL_SIZE);
                 break;
-                case TypeVarChar:
-                    unsigned varcharSize;
-                    // We have to get the size of the VarChar field by reading the integer that precedes the string value itself
-                    memcpy(&varcharSize, data_start, VARCHAR_LENGTH_SIZE);
-                    memcpy(start + rec_offset, data_start + VARCHAR_LENGTH_SIZE, varcharSize);
-                    // We also have to account for the overhead given by that integer.
-                    rec_offset += varcharSize;
-                    data_offset += VARCHAR_LENGTH_SIZE + varcharSize;
+            }
+            case TypeVarChar:
+            {
+                uint32_t fieldLength = value.size();
+                data.insert(data.end(), (char*) &fieldLength, (char*) &fieldLength + VARCHAR_LENGTH_SIZE);
+                data.insert(data.end(), value.begin(), value.end());
+                hasLob = hasLob || fieldLength > LOB_INLINE_LIMIT;
                 break;
             }
         }
-        // Copy offset into record header
-        // Offset is relative to the start of the record and points to END of field
-        memcpy(start + header_offset, &rec_offset, sizeof(ColumnOffset));
-        header_offset += sizeof(ColumnOffset);
     }
+    return pos == length;
 }
 
-void RecordBasedFileManager::getRecordAtOffset(void *page, int32_t offset, const vector<Attribute> &recordDescriptor, void *data)
+// Gathers the statistics of the records on pages. Row and null counts, minimums and maximums are exact for
+// those pages, histograms are built from a reservoir sample of each attribute and distinct counts come from HyperLogLog.
+RC RecordBasedFileManager::analyzePages(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const vector<PageNum> &pages,
+        TableStats &stats)
 {
-    // Pointer to start of record
-    char *start = (char*) page + offset;
-
-    // Allocate space for null indicator. The returned null indicator may be larger than
-    // the null indicator in the table has had fields added to it
-    int nullIndicatorSize = getNullIndicatorSize(recordDescriptor.size());
-    char nullIndicator[nullIndicatorSize];
-    memset(nullIndicator, 0, nullIndicatorSize);
-
-    // Get number of columns and size of the null indicator for this record
-    RecordLength len = 0;
-    memcpy (&len, (char*)page + offset, sizeof(RecordLength));
-    int recordNullIndicatorSize = getNullIndicatorSize(len);
+    unsigned columns = recordDescriptor.size();
+    stats.rowCount = 0;
+    stats.columns.assign(columns, ColumnStats());
+    stats.sampled = false;
+
+    vector<unsigned> nulls(columns, 0);
+    vector<unsigned> seen(columns, 0);
+    vector<vector<string>> samples(columns);
+    vector<vector<uint8_t>> registers(columns, vector<uint8_t>(1 << STATS_HLL_BITS, 0));
+    // A fixed seed keeps the histograms of an unchanged file stable
+    mt19937 random(STATS_SAMPLE_SIZE);
 
-    // Read in the existing null indicator
-    memcpy (nullIndicator, start + sizeof(RecordLength), nullIndicatorSize);
-
-    // If this new recordDescriptor has had fields added to it, we set all of the new fields to null
-    for (unsigned i = len; i < recordDescriptor.size(); i++)
-    {
-        int indicatorIndex = (i+1) / CHAR_BIT;
-        int indicatorMask  = 1 << (CHAR_BIT - 1 - (i % CHAR_BIT));
-        nullIndicator[indicatorIndex] |= indicatorMask;
-    }
-    // Write out null indicator
-    memcpy(data, nullIndicator, nullIndicatorSize);
+    void *pageData = malloc(PAGE_SIZE);
+    if (pageData == NULL)
+        return RBFM_MALLOC_FAILED;
 
-    // Initialize some offsets
-    // rec_offset: points to data in the record. We move this forward as we read data from our record
-    unsigned rec_offset = sizeof(RecordLength) + recordNullIndicatorSize + len * sizeof(ColumnOffset);
-    // data_offset: points to our current place in the output data. We move this forward as we write data to data.
-    unsigned data_offset = nullIndicatorSize;
-    // directory_base: points to the start of our directory of indices
-    char *directory_base = start + sizeof(RecordLength) + recordNullIndicatorSize;
-    
-    for (unsigned i = 0; i < recordDescriptor.size(); i++)
+    string value;
+    for (PageNum pageNum : pages)
     {
-        if (fieldIsNull(nullIndicator, i))
-            continue;
-        
-        // Grab pointer to end of this column
-        ColumnOffset endPointer;
-        memcpy(&endPointer, directory_base + i * sizeof(ColumnOffset), sizeof(ColumnOffset));
-
-        // rec_offset keeps track of start of column, so end-start = total size
-        uint32_t fieldSize = endPointer - rec_offset;
-
-        // Special case for varchar, we must give data the size of varchar first
-        if (recordDescriptor[i].type == TypeVarChar)
+        if (fileHandle.readPage(pageNum, pageData))
         {
-            memcpy((char*) data + data_offset, &fieldSize, VARCHAR_LENGTH_SIZE);
-            data_offset += VARCHAR_LENGTH_SIZE;
+            free(pageData);
+            return RBFM_READ_FAILED;
         }
-        // Next we copy bytes equal to the size of the field and increase our offsets
-        memcpy((char*) data + data_offset, start + rec_offset, fieldSize);
-        rec_offset += fieldSize;
-        data_offset += fieldSize;
-    }
-}
+        SlotDirectoryHeader slotHeader = getSlotDirectoryHeader(pageData);
+        for (unsigned slot = 0; slot < slotHeader.recordEntriesNumber; slot++)
+        {
+            // Forwarded records are counted on the page they were moved to
+            SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(pageData, slot);
+            if (getSlotStatus(recordEntry) != VALID)
+                continue;
+            stats.rowCount++;
 
-SlotStatus RecordBasedFileManager::getSlotStatus(SlotDirectoryRecordEntry slot)
-{
-    if (slot.length == 0 && slot.offset == 0)
-        return DEAD;
-    if (slot.offset <= 0)
-        return MOVED;
-    return VALID;
-}
+            for (unsigned i = 0; i < columns; i++)
+            {
+                char *attrStart;
+                uint32_t attrLength;
+                bool isLob;
+                if (!findAttributeInRecord(pageData, recordEntry.offset, i, attrStart, attrLength, isLob))
+                {
+                    nulls[i]++;
+                    continue;
+                }
+
+                // Build the value in scan value format
+                value.clear();
+                if (recordDescriptor[i].type == TypeVarChar)
+                {
+                    uint32_t length = attrLength;
+                    if (isLob)
+                    {
+                        LobPointer pointer;
+                        memcpy(&pointer, attrStart, sizeof(LobPointer));
+                        length = pointer.length;
+                    }
+                    value.resize(VARCHAR_LENGTH_SIZE + length);
+                    RC rc = readVarcharValue(fileHandle, attrStart, attrLength, isLob, &value[0], length);
+                    if (rc)
+                    {
+                        free(pageData);
+                        return rc;
+                    }
+                }
+                else
+                    value.assign(attrStart, attrLength);
+
+                ColumnStats &column = stats.columns[i];
+                AttrType type = recordDescriptor[i].type;
+                if (column.minValue.empty() || compareClusterKeys(type, value, column.minValue) < 0)
+                    column.minValue = value;
+                if (column.maxValue.empty() || compareClusterKeys(type, value, column.maxValue) > 0)
+                    column.maxValue = value;
+
+                // The low bits of the hash pick a register, which keeps the longest run of zeros above them
+                uint64_t hash = hashValue(value);
+                uint8_t rank = 1;
+                for (uint64_t rest = hash >> STATS_HLL_BITS; !(rest & 1) && rank <= 64 - STATS_HLL_BITS; rest >>= 1)
+                    rank++;
+                uint8_t &reg = registers[i][hash & ((1 << STATS_HLL_BITS) - 1)];
+                reg = max(reg, rank);
+
+                // Reservoir sample: the n-th value replaces a random sampled one with probability size / n
+                seen[i]++;
+                if (samples[i].size() < STATS_SAMPLE_SIZE)
+                    samples[i].push_back(value);
+                else
+                {
+                    unsigned j = random() % seen[i];
+                    if (j < STATS_SAMPLE_SIZE)
+                        samples[i][j] = value;
+                }
+            }
+        }
+    }
+    free(pageData);
 
-// Get first unused slot in page. Slot is considered unused if dead
-// If not dead slots returns recordEntriesNumber
-unsigned RecordBasedFileManager::getOpenSlot(void *page)
-{
-    SlotDirectoryHeader header = getSlotDirectoryHeader(page);
-    unsigned i;
-    for (i = 0; i < header.recordEntriesNumber; i++)
+    for (unsigned i = 0; i < columns; i++)
     {
-        SlotDirectoryRecordEntry recordEntry = getSlotDirectoryRecordEntry(page, i);
-        SlotStatus status = getSlotStatus(recordEntry);
-        if (status == DEAD)
-            return i;
+        ColumnStats &column = stats.columns[i];
+        column.nullFraction = stats.rowCount ? (float) nulls[i] / stats.rowCount : 0;
+        column.distinctCount = min(estimateDistinct(registers[i]), seen[i]);
+
+        // Equi-depth buckets: bucket b ends at the value b / STATS_HISTOGRAM_BUCKETS of the way through the sample
+        vector<string> &sample = samples[i];
+        AttrType type = recordDescriptor[i].type;
+        sort(sample.begin(), sample.end(),
+            [&](const string &first, const string &second) {return compareClusterKeys(type, first, second) < 0;});
+        if (sample.empty())
+            continue;
+        for (unsigned b = 1; b <= STATS_HISTOGRAM_BUCKETS; b++)
+            column.histogram.push_back(sample[(b * sample.size() - 1) / STATS_HISTOGRAM_BUCKETS]);
     }
-    return i;
+    return SUCCESS;
 }
 
-// Mark slot header as dead (all 0s)
-void RecordBasedFileManager::markSlotDeleted(void *page, unsigned i)
+// Keeps count of pages, picked uniformly at random using seed, in the order they had
+void RecordBasedFileManager::samplePageList(vector<PageNum> &pages, unsigned count, unsigned seed)
 {
-    memset  (
-            ((char*) page + sizeof(SlotDirectoryHeader) + i * sizeof(SlotDirectoryRecordEntry)),
-            0,
-            sizeof(SlotDirectoryRecordEntry)
-            );
+    if (count >= pages.size())
+        return;
+
+    // Partial Fisher-Yates shuffle of the positions
+    vector<unsigned> positions(pages.size());
+    for (unsigned i = 0; i < positions.size(); i++)
+        positions[i] = i;
+    mt19937 random(seed);
+    for (unsigned i = 0; i < count; i++)
+        swap(positions[i], positions[i + random() % (positions.size() - i)]);
+    positions.resize(count);
+    sort(positions.begin(), positions.end());
+
+    vector<PageNum> sample;
+    for (unsigned position : positions)
+        sample.push_back(pages[position]);
+    pages.swap(sample);
 }
 
-// Consolidates free space in center of page
-void RecordBasedFileManager::reorganizePage(void *page)
+// FNV-1a, finished with a 64-bit mixer so that every bit of the hash depends on every byte
+uint64_t RecordBasedFileManager::hashValue(const string &value)
 {
-    SlotDirectoryHeader header = getSlotDirectoryHeader(page);
-
-    // Add all live records to vector, keeping track of slot numbers
-    vector<IndexedRecordEntry> liveRecords;
-    for (unsigned i = 0; i < header.recordEntriesNumber; i++)
-    {
-        IndexedRecordEntry entry;
-        entry.slotNum = i;
-        entry.recordEntry = getSlotDirectoryRecordEntry(page, i);
-        if (getSlotStatus(entry.recordEntry) == VALID)
-            liveRecords.push_back(entry);
-    }
-    // Sort records by offset, descending
-    auto comp = [](IndexedRecordEntry first, IndexedRecordEntry second) 
-        {return first.recordEntry.offset > second.recordEntry.offset;};
-    sort(liveRecords.begin(), liveRecords.end(), comp);
-
-    // Move each record back filling in any gap preceding the record
-    uint16_t pageOffset = PAGE_SIZE;
-    SlotDirectoryRecordEntry current;
-    for (unsigned i = 0; i < liveRecords.size(); i++)
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : value)
     {
-        current = liveRecords[i].recordEntry;
-        pageOffset -= current.length;
-
-        // Use memmove rather than memcpy because locations may overlap
-        memmove((char*)page + pageOffset, (char*)page + current.offset, current.length);
-        current.offset = pageOffset;
-        setSlotDirectoryRecordEntry(page, liveRecords[i].slotNum, current);
+        hash ^= c;
+        hash *= 1099511628211ULL;
     }
-    header.freeSpaceOffset = pageOffset;
-    setSlotDirectoryHeader(page, header);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
 }
 
-void RecordBasedFileManager::getAttributeFromRecord(void *page, unsigned offset, unsigned attrIndex, AttrType type, void *data)
+// HyperLogLog estimate, with linear counting while many registers are still empty
+unsigned RecordBasedFileManager::estimateDistinct(const vector<uint8_t> &registers)
 {
-    char *start = (char*)page + offset;
-    unsigned data_offset = 0;
-
-    // Get number of columns
-    RecordLength n;
-    memcpy (&n, start, sizeof(RecordLength));
-
-    // Get null indicator
-    int recordNullIndicatorSize = getNullIndicatorSize(n);
-    char recordNullIndicator[recordNullIndicatorSize];
-    memcpy (recordNullIndicator, start + sizeof(RecordLength), recordNullIndicatorSize);
-
-    // Set null indicator for result
-    char resultNullIndicator = 0;
-    if (fieldIsNull(recordNullIndicator, attrIndex))
-        resultNullIndicator |= (1 << 7);
-    memcpy(data, &resultNullIndicator, 1);
-    data_offset += 1;
-    if (resultNullIndicator) return;
-
-    // Now we know the result isn't null, so we grab it
-    unsigned header_offset = sizeof(RecordLength) + recordNullIndicatorSize;
-    // attrEnd points to end of attribute, attrStart points to the beginning
-    // Our directory at the beginning of each record contains pointers to the ends of each attribute,
-    // so we can pull attrEnd from that
-    ColumnOffset attrEnd, attrStart;
-    memcpy(&attrEnd, start + header_offset + attrIndex * sizeof(ColumnOffset), sizeof(ColumnOffset));
-    // The start is either the end of the previous attribute, or the start of the data section of the
-    // record if we are after the 0th attribute
-    if (attrIndex > 0)
-        memcpy(&attrStart, start + header_offset + (attrIndex - 1) * sizeof(ColumnOffset), sizeof(ColumnOffset));
-    else
-        attrStart = header_offset + n * sizeof(ColumnOffset);
-    // The length of any attribute is just the difference between its start and end
-    uint32_t len = attrEnd - attrStart;
-    if (type == TypeVarChar)
+    double m = registers.size();
+    double sum = 0;
+    unsigned zeros = 0;
+    for (uint8_t reg : registers)
     {
-        // For varchars we have to return this length in the result
-        memcpy((char*)data + data_offset, &len, sizeof(VARCHAR_LENGTH_SIZE));
-        data_offset += VARCHAR_LENGTH_SIZE;
+        sum += ldexp(1.0, -reg);
+        if (reg == 0)
+            zeros++;
     }
-    // For all types, we then copy the data into the result
-    memcpy((char*)data + data_offset, start + attrStart, len);
-}
\ No newline at end of file
+    double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+    if (estimate <= 2.5 * m && zeros > 0)
+        estimate = m * log(m / zeros);
+    return (unsigned) llround(estimate);
+}
@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 #include <climits>
+#include <cstring>
+#include <functional>
 
 #include "../rbf/pfm.h"
 
@@ -22,6 +24,32 @@
 #define RBFM_SLOT_DN_EXIST  7
 #define RBFM_READ_AFTER_DEL 8
 #define RBFM_NO_SUCH_ATTR   9
+#define RBFM_RECORD_TOO_LARGE 10
+#define RBFM_BAD_FIELD      11
+#define RBFM_CLUSTERED_FILE 12  // the operation would break the key order of a clustered file
+#define RBFM_APPEND_ONLY_FILE 13 // records of an append-only file are only removed by discardPages()
+#define RBFM_BAD_SCAN_TOKEN 14  // the continuation token was taken from a different scan
+#define RBFM_BAD_FILL_FACTOR 15 // fill factors are percentages from 1 to 100
+#define RBFM_BAD_SAMPLE     16  // sample percentages are from 0 to 100
+
+// Inserts fill pages up to this percentage unless told otherwise
+#define DEFAULT_FILL_FACTOR 100
+
+// Number of consecutive pages handed to a parallel scan worker at a time
+#define PARALLEL_SCAN_MORSEL_PAGES 16
+
+// Bytes of delimited text handed to a bulk load worker at a time
+#define BULK_LOAD_MORSEL_SIZE (1 << 20)
+
+// Pages a bulk load worker fills before appending them to the file with one write
+#define BULK_LOAD_BATCH_PAGES 32
+
+// analyzeFile() builds histograms of STATS_HISTOGRAM_BUCKETS buckets from a uniform sample of at most
+// STATS_SAMPLE_SIZE values per attribute. Distinct counts are estimated with 2^STATS_HLL_BITS registers,
+// for a standard error of about 3%.
+#define STATS_HISTOGRAM_BUCKETS 16
+#define STATS_SAMPLE_SIZE       4096
+#define STATS_HLL_BITS          10
 
 using namespace std;
 
@@ -33,6 +61,53 @@ typedef struct
 } RID;
 
 
+// A record that was given a new RID, e.g. by vacuumFile()
+typedef struct RIDRemap
+{
+    RID oldRid;
+    RID newRid;
+} RIDRemap;
+
+// What vacuumFile() achieved. A full scan reads every page of the file,
+// so scanPagesSaved is the number of page reads each later full scan no longer does.
+typedef struct VacuumStats
+{
+    unsigned pagesBefore;
+    unsigned pagesAfter;
+    unsigned emptyPagesRemaining;   // pages before the end of the file that still hold no records
+    unsigned recordsRelocated;
+    unsigned bytesReclaimed;
+    unsigned scanPagesSaved;
+} VacuumStats;
+
+// What bulkLoad() did
+typedef struct BulkLoadStats
+{
+    unsigned rows;          // rows inserted
+    unsigned rejectedRows;  // rows that did not parse against the record descriptor, or did not fit on a page
+    unsigned pages;         // pages appended to the file, not counting large values
+    double seconds;
+    double rowsPerSecond;
+} BulkLoadStats;
+
+// Statistics of one attribute, see RecordBasedFileManager::analyzeFile().
+// Values are in the format of a scan value, an empty value is null.
+typedef struct ColumnStats
+{
+    float nullFraction;
+    unsigned distinctCount;     // HyperLogLog estimate over the non-null values
+    string minValue;            // null if every value is null
+    string maxValue;
+    vector<string> histogram;   // upper bounds of equi-depth buckets, ascending
+} ColumnStats;
+
+typedef struct TableStats
+{
+    unsigned rowCount;
+    vector<ColumnStats> columns;    // in record descriptor order
+    bool sampled;                   // gathered from a sample of the pages, see RecordBasedFileManager::analyzeFile()
+} TableStats;
+
 // Attribute
 typedef enum { TypeInt = 0, TypeReal, TypeVarChar } AttrType;
 // 
@@ -58,6 +133,18 @@ typedef enum
     NO_OP       // no condition
 } CompOp;
 
+// A single comparison of one attribute against a value, used by multi-predicate scans
+// value follows the same format as the value passed to scan() (no null indicator)
+typedef struct ScanPredicate
+{
+    string attribute;
+    CompOp compOp;
+    const void *value;
+} ScanPredicate;
+
+// Predicates within a group are ORed together, the groups of a scan are ANDed together
+typedef vector<ScanPredicate> ScanPredicateGroup;
+
 // Slot directory headers for page organization
 // See chapter 9.6.2 of the cow book or lecture 3 slide 16 for more information
 typedef struct SlotDirectoryHeader
@@ -74,6 +161,105 @@ typedef struct SlotDirectoryRecordEntry
     int32_t offset;
 } SlotDirectoryRecordEntry;
 
+// Page format v2: a 10 byte header and 4 byte slots.
+// Byte 1 of a v1 page is the high byte of freeSpaceOffset, which never exceeds 0x10, so a v2 page
+// marks itself by storing PAGE_FORMAT_V2 there. Pages without the mark are read as v1.
+#define PAGE_FORMAT_V1 1
+#define PAGE_FORMAT_V2 0xF2
+
+// Once this many bytes on a v2 page are held by dead or shrunk records, the page is compacted
+#define PAGE_COMPACTION_THRESHOLD (PAGE_SIZE / 4)
+
+// A moved record on a v2 page leaves a stub with its new RID in its old space, so every record
+// on a v2 page takes up at least this much room
+#define FORWARD_STUB_SIZE (2 * sizeof(uint32_t))
+
+// Largest record that fits on an empty page
+#define MAX_RECORD_SIZE (PAGE_SIZE - sizeof(SlotDirectoryHeaderV2) - sizeof(SlotDirectoryRecordEntryV2))
+
+// Ends the chain of free slots
+#define NO_FREE_SLOT 0xFFFF
+
+typedef struct SlotDirectoryHeaderV2
+{
+    uint8_t  flags;                 // page flags, none defined yet
+    uint8_t  version;               // PAGE_FORMAT_V2
+    uint16_t freeSpaceOffset;
+    uint16_t recordEntriesNumber;
+    uint16_t freeSlotHead;          // first DEAD slot, or NO_FREE_SLOT
+    uint16_t fragmentedBytes;       // bytes in the record area not owned by a live slot
+} SlotDirectoryHeaderV2;
+
+// The top two bits of offset hold the slot status.
+// VALID: offset/length of the record. MOVED: offset/length of the forwarding stub.
+// DEAD: length is the next slot in the free slot chain.
+#define SLOT_V2_MOVED       0x4000
+#define SLOT_V2_DEAD        0x8000
+#define SLOT_V2_STATUS_MASK 0xC000
+
+typedef struct SlotDirectoryRecordEntryV2
+{
+    uint16_t offset;
+    uint16_t length;
+} SlotDirectoryRecordEntryV2;
+
+// Varchar values longer than LOB_INLINE_LIMIT are stored out of line, in a chain of overflow pages.
+// The record holds a LobPointer in place of the value, and sets LOB_COLUMN_FLAG in the column's end offset
+// (end offsets never reach it, as they are below PAGE_SIZE).
+#define LOB_INLINE_LIMIT (PAGE_SIZE / 4)
+#define LOB_COLUMN_FLAG  0x8000
+
+typedef struct LobPointer
+{
+    uint32_t firstPage;
+    uint32_t length;
+} LobPointer;
+
+// An overflow page is a v2 page with PAGE_FLAG_OVERFLOW set, no slots and no free space, so scans and
+// inserts pass it by. An OverflowPageHeader follows the slot directory header, then the data.
+#define PAGE_FLAG_OVERFLOW 0x01
+#define NO_NEXT_PAGE 0xFFFFFFFF
+
+typedef struct OverflowPageHeader
+{
+    uint32_t nextPage;      // next page of the chain, or NO_NEXT_PAGE
+    uint32_t dataLength;    // bytes of the value on this page
+} OverflowPageHeader;
+
+#define OVERFLOW_DATA_OFFSET (sizeof(SlotDirectoryHeaderV2) + sizeof(OverflowPageHeader))
+#define OVERFLOW_PAGE_CAPACITY (PAGE_SIZE - OVERFLOW_DATA_OFFSET)
+
+// A clustered file keeps its records roughly in the order of a key attribute. Page 0 is its header page:
+// a v2 page with PAGE_FLAG_CLUSTER_HEADER set and no room for records, holding a ClusterHeader followed by
+// the start of the key directory. The rest of the directory continues in a chain of overflow pages.
+// The pages holding records set PAGE_FLAG_CLUSTERED.
+#define PAGE_FLAG_CLUSTER_HEADER 0x02
+#define PAGE_FLAG_CLUSTERED      0x04
+
+// Every page of an append-only file sets PAGE_FLAG_APPEND_ONLY. Records only ever go to the last page,
+// in a new slot, so an insert never searches for free space or reuses a slot.
+#define PAGE_FLAG_APPEND_ONLY    0x08
+
+typedef struct ClusterHeader
+{
+    uint32_t keyIndex;          // position of the key in the record descriptor
+    uint32_t keyType;           // AttrType of the key
+    uint32_t directoryLength;   // bytes of the serialized directory
+    uint32_t nextPage;          // first continuation page of the directory, or NO_NEXT_PAGE
+} ClusterHeader;
+
+#define CLUSTER_DIRECTORY_OFFSET (sizeof(SlotDirectoryHeaderV2) + sizeof(ClusterHeader))
+#define CLUSTER_HEADER_CAPACITY (PAGE_SIZE - CLUSTER_DIRECTORY_OFFSET)
+
+// The key directory is sparse: one entry per record page, in key order. Page i holds keys between its own
+// key and the key of page i + 1 (the first page also holds anything smaller). Keys are in the format of a
+// scan value, an empty key is null and sorts first. Serialized as pageNum, key length, key bytes.
+typedef struct ClusterDirectoryEntry
+{
+    string key;
+    PageNum pageNum;
+} ClusterDirectoryEntry;
+
 typedef struct IndexedRecordEntry
 {
     int32_t slotNum;
@@ -86,6 +272,169 @@ typedef uint16_t ColumnOffset;
 
 typedef uint16_t RecordLength;
 
+// Fixed-width records hold only TypeInt and TypeReal columns, which are all FIXED_WIDTH_FIELD_SIZE bytes.
+// When such a record has no null fields its layout never changes: every column offset is a constant,
+// and the API-format data after the null indicator is byte for byte the data stored on the page.
+#define FIXED_WIDTH_FIELD_SIZE 4
+
+// Column counts up to this are encoded through a specialized FixedWidthLayout, wider records use the generic path
+#define FIXED_WIDTH_MAX_SPECIALIZED 16
+
+template <unsigned N>
+struct FixedWidthLayout
+{
+    static constexpr unsigned columns = N;
+    static constexpr unsigned nullIndicatorSize = (N + CHAR_BIT - 1) / CHAR_BIT;
+    static constexpr unsigned headerSize = sizeof(RecordLength) + nullIndicatorSize + N * sizeof(ColumnOffset);
+    static constexpr unsigned dataSize = N * FIXED_WIDTH_FIELD_SIZE;
+    // Size of the record on the page, and of the record in API format
+    static constexpr unsigned recordSize = headerSize + dataSize;
+    static constexpr unsigned apiSize = nullIndicatorSize + dataSize;
+
+    // True if any field of the API-format record is null, such records take the generic path
+    static bool hasNulls(const void *data)
+    {
+        for (unsigned i = 0; i < nullIndicatorSize; i++)
+            if (((const char*) data)[i])
+                return true;
+        return false;
+    }
+
+    // True if the record on the page was stored with this layout
+    static bool isStoredWith(const void *record)
+    {
+        RecordLength len;
+        memcpy(&len, record, sizeof(RecordLength));
+        return len == N && !hasNulls((const char*) record + sizeof(RecordLength));
+    }
+
+    // Encodes an API-format record without nulls into recordSize bytes at dest
+    static void encode(void *dest, const void *data)
+    {
+        char *start = (char*) dest;
+        RecordLength len = N;
+        memcpy(start, &len, sizeof(RecordLength));
+        memset(start + sizeof(RecordLength), 0, nullIndicatorSize);
+        ColumnOffset offsets[N];
+        for (unsigned i = 0; i < N; i++)
+            offsets[i] = headerSize + (i + 1) * FIXED_WIDTH_FIELD_SIZE;
+        memcpy(start + sizeof(RecordLength) + nullIndicatorSize, offsets, sizeof(offsets));
+        memcpy(start + headerSize, (const char*) data + nullIndicatorSize, dataSize);
+    }
+
+    // Decodes a record for which isStoredWith() holds into apiSize bytes at data
+    static void decode(const void *record, void *data)
+    {
+        memset(data, 0, nullIndicatorSize);
+        memcpy((char*) data + nullIndicatorSize, (const char*) record + headerSize, dataSize);
+    }
+};
+
+// Tries the specialized layouts from N down to 1 for a record of columns columns
+template <unsigned N>
+struct FixedWidthDispatch
+{
+    // Returns the size of the encoded record, or 0 if the record has to take the generic path
+    static unsigned encode(unsigned columns, void *dest, const void *data)
+    {
+        if (columns != N)
+            return FixedWidthDispatch<N - 1>::encode(columns, dest, data);
+        if (FixedWidthLayout<N>::hasNulls(data))
+            return 0;
+        FixedWidthLayout<N>::encode(dest, data);
+        return FixedWidthLayout<N>::recordSize;
+    }
+
+    static bool decode(unsigned columns, const void *record, void *data)
+    {
+        if (columns != N)
+            return FixedWidthDispatch<N - 1>::decode(columns, record, data);
+        if (!FixedWidthLayout<N>::isStoredWith(record))
+            return false;
+        FixedWidthLayout<N>::decode(record, data);
+        return true;
+    }
+};
+
+template <>
+struct FixedWidthDispatch<0>
+{
+    static unsigned encode(unsigned, void *, const void *) { return 0; }
+    static bool decode(unsigned, const void *, void *) { return false; }
+};
+
+constexpr bool isFixedWidthType(AttrType type)
+{
+    return type == TypeInt || type == TypeReal;
+}
+
+constexpr bool allFixedWidthTypes()
+{
+    return true;
+}
+
+template <typename... Types>
+constexpr bool allFixedWidthTypes(AttrType type, Types... types)
+{
+    return isFixedWidthType(type) && allFixedWidthTypes(types...);
+}
+
+// A fixed-width schema declared in C++, e.g.
+//   typedef FixedWidthSchema<TypeInt, TypeReal> PointSchema;
+//   PointSchema::encode(page + offset, data);
+template <AttrType... Types>
+struct FixedWidthSchema : public FixedWidthLayout<sizeof...(Types)>
+{
+    static_assert(sizeof...(Types) > 0, "A schema needs at least one column");
+    static_assert(allFixedWidthTypes(Types...), "Fixed-width schemas cannot hold varchar columns");
+
+    // True if recordDescriptor has exactly the column types of this schema
+    static bool matches(const vector<Attribute> &recordDescriptor)
+    {
+        static const AttrType types[] = {Types...};
+        if (recordDescriptor.size() != sizeof...(Types))
+            return false;
+        for (unsigned i = 0; i < sizeof...(Types); i++)
+            if (recordDescriptor[i].type != types[i])
+                return false;
+        return true;
+    }
+};
+
+
+// A ScanPredicate resolved against a record descriptor
+// cost estimates how expensive the predicate is to evaluate, selectivity how likely it is to pass
+typedef struct CompiledPredicate
+{
+    unsigned attrIndex;
+    AttrType type;
+    CompOp compOp;
+    const void *value;
+    unsigned cost;
+    float selectivity;
+} CompiledPredicate;
+
+typedef vector<CompiledPredicate> CompiledPredicateGroup;
+
+// Where a scan stopped, see RBFM_ScanIterator::getContinuation(). It holds no pointers, so it can be
+// kept or sent as its raw bytes and handed to a new iterator over the same file.
+typedef struct ScanToken
+{
+    uint64_t fingerprint;   // hash of the scan's record descriptor, conditions and projection
+    uint32_t pageNum;       // next slot to look at
+    uint32_t slotNum;
+    uint32_t pageListPos;   // position of pageNum in the pages of a clustered scan
+} ScanToken;
+
+// Receives the records of a parallel scan. worker is the index of the calling worker thread.
+// Calls from the same worker are sequential, calls from different workers run concurrently.
+// data follows the same format as RBFM_ScanIterator::getNextRecord() and is only valid during the call.
+typedef function<void(unsigned worker, const RID &rid, const void *data)> ParallelScanCallback;
+
+// Receives the records of a batch read. i is the position of the RID in the caller's list, and the calls come
+// in that order. rc is the result of reading that RID (as readRecord() would return it), data holds the record
+// when rc is 0 and is only valid during the call.
+typedef function<void(unsigned i, RC rc, const void *data)> RecordBatchCallback;
 
 /********************************************************************************
 The scan iterator is NOT required to be implemented for the part 1 of the project 
@@ -114,6 +463,20 @@ public:
   RC getNextRecord(RID &rid, void *data);
   RC close();
 
+  // Return RBFM_EOF once limit more records have been returned, 0 removes the limit
+  void setLimit(unsigned limit);
+  // Where the scan continues from, right after the last record returned
+  RC getContinuation(ScanToken &token);
+  // Continues from token, which must come from a scan with the same record descriptor, conditions and
+  // projection (otherwise RBFM_BAD_SCAN_TOKEN). Call it right after starting the scan.
+  RC resume(const ScanToken &token);
+
+  // Visit only count pages, picked uniformly at random (using seed) from those the scan would visit, and return
+  // the records on them that satisfy the conditions. Call it right after starting the scan, before resume().
+  RC samplePages(unsigned count, unsigned seed);
+  // Same, with count a percentage of the pages
+  RC samplePercent(float percent, unsigned seed);
+
   friend class RecordBasedFileManager;
 
 private:
@@ -127,33 +490,199 @@ private:
 
   void *pageData;
 
-  AttrType type;
-  unsigned attrIndex;
-
   FileHandle fileHandle;
   vector<Attribute> recordDescriptor;
-  string conditionAttribute;
-  CompOp compOp;
-  const void* value;
+  // Groups are ANDed, predicates in a group ORed. Ordered so the cheapest, most selective checks run first
+  vector<CompiledPredicateGroup> conditions;
   vector<string> attributeNames;
+  // Positions of attributeNames in the record descriptor
+  vector<unsigned> projection;
 
   vector<RID> skipList;
 
+  // Pages to visit in order instead of the whole file, set up by initClusteredScan()
+  vector<PageNum> pageList;
+  unsigned pageListPos;
+
+  unsigned limit;
+  unsigned returned;
+  uint64_t fingerprint;
+
+  void computeFingerprint();
+
   RC scanInit(FileHandle &fh,
         const vector<Attribute> rd,
         const string &ca, 
         const CompOp compOp, 
         const void *v, 
         const vector<string> &an);
+  RC scanInit(FileHandle &fh,
+        const vector<Attribute> rd,
+        const vector<ScanPredicateGroup> &conds,
+        const vector<string> &an);
+  RC compilePredicate(const ScanPredicate &predicate, CompiledPredicate &compiled);
+  // Restrict the scan to pages [firstPage, endPage)
+  RC setPageRange(uint32_t firstPage, uint32_t endPage);
+  // On a clustered file, visit only the pages the key conditions can match, in key order
+  RC initClusteredScan();
 
   RC getNextSlot();
   RC getNextPage();
+  // Same as getNextRecord(), growing data to fit the projected record, for callers without a buffer of their own
+  RC getNextRecord(RID &rid, vector<char> &data);
+  // Move to the next record satisfying the conditions and find its slot
+  RC nextRecordEntry(SlotDirectoryRecordEntry &recordEntry);
   RC handleMovedRecord(bool &status, const RID rid, void *data);
   bool checkScanCondition();
+  bool checkScanCondition(const CompiledPredicate &predicate, unsigned recordOffset);
   RC checkScanCondition(bool &result, const RID rid);
   bool checkScanCondition(int, CompOp, const void*);
   bool checkScanCondition(float, CompOp, const void*);
-  bool checkScanCondition(char*, CompOp, const void*);
+  bool checkScanCondition(const char*, uint32_t, CompOp, const void*);
+};
+
+// Read-only view of a record as it is stored on its page, filled by RecordBasedFileManager::readRecordView().
+// The view keeps its own copy of the page, and the accessors read fields straight out of it using the
+// record's column offset directory, so nothing is decoded that is not asked for.
+// Pointers returned by getVarchar() stay valid until the view is reused or destroyed.
+// i is the position of the attribute in the record descriptor.
+class RecordView {
+public:
+  RecordView();
+  ~RecordView();
+
+  bool isNull(unsigned i) const;
+  int32_t getInt(unsigned i) const;
+  float getReal(unsigned i) const;
+  // Returns the characters of the varchar (not null terminated), length receives how many there are.
+  // Values stored out of line return NULL with their full length, read them with openLob().
+  const char *getVarchar(unsigned i, uint32_t &length) const;
+
+  friend class RecordBasedFileManager;
+
+private:
+  RecordBasedFileManager *rbfm;
+
+  void *pageData;
+  unsigned recordOffset;
+
+  // A view owns its page buffer, don't let copies share it
+  RecordView(const RecordView &) = delete;
+  RecordView &operator=(const RecordView &) = delete;
+};
+
+
+// Streams a large value into a new chain of overflow pages, see RecordBasedFileManager::createLob()
+class LobWriter {
+public:
+  LobWriter();
+  ~LobWriter();
+
+  RC write(const void *data, uint32_t size);
+  // Writes out the last page, pointer receives where the value was stored
+  RC close(LobPointer &pointer);
+
+  friend class RecordBasedFileManager;
+
+private:
+  FileHandle *fileHandle;
+  void *pageData;
+  PageNum currentPage;
+  LobPointer pointer;
+
+  LobWriter(const LobWriter &) = delete;
+  LobWriter &operator=(const LobWriter &) = delete;
+};
+
+// Reads a varchar value chunk by chunk, see RecordBasedFileManager::openLob().
+// The file must stay open while the reader is in use.
+class LobReader {
+public:
+  LobReader();
+  ~LobReader();
+
+  uint32_t length() const;
+  // Reads up to size bytes from the current position, bytesRead receives how many were read (0 at the end)
+  RC read(void *buffer, uint32_t size, uint32_t &bytesRead);
+
+  friend class RecordBasedFileManager;
+
+private:
+  FileHandle *fileHandle;
+  void *pageData;
+  // A value stored in the record is copied here, otherwise it is read page by page
+  string inlineValue;
+  bool isInline;
+  LobPointer pointer;
+  uint32_t position;
+  PageNum nextPage;
+  uint32_t pageLength;
+  uint32_t pageOffset;
+
+  LobReader(const LobReader &) = delete;
+  LobReader &operator=(const LobReader &) = delete;
+};
+
+// Keeps the last page of an append-only file in memory, see RecordBasedFileManager::openAppendWriter().
+// A record reaches the file when its page fills up, on flush() and on close(); other handles and scans
+// only see it after that. Don't insert into the file by other means while the writer is open.
+class AppendWriter {
+public:
+  AppendWriter();
+  ~AppendWriter();
+
+  RC insertRecord(const vector<Attribute> &recordDescriptor, const void *data, RID &rid);
+  RC flush();
+  RC close();
+
+  friend class RecordBasedFileManager;
+
+private:
+  FileHandle *fileHandle;
+  void *pageData;
+  PageNum tailPage;
+  bool dirty;
+
+  AppendWriter(const AppendWriter &) = delete;
+  AppendWriter &operator=(const AppendWriter &) = delete;
+};
+
+// Builds a record directly in the stored format, so inserting or updating it skips encoding.
+// Fields are set in column order. Columns skipped over, or never set, are null.
+class RecordBuilder {
+public:
+  RecordBuilder(const vector<Attribute> &recordDescriptor);
+  ~RecordBuilder();
+
+  // Each setter returns RBFM_BAD_FIELD if column i is out of range, already passed, or of another type,
+  // and RBFM_RECORD_TOO_LARGE if the value would not fit on a page
+  RC setInt(unsigned i, int32_t value);
+  RC setReal(unsigned i, float value);
+  RC setVarchar(unsigned i, const char *value, uint32_t length);
+  // Sets a varchar to a value already stored out of line by a LobWriter
+  RC setLob(unsigned i, const LobPointer &pointer);
+  RC setNull(unsigned i);
+
+  // Starts a new record with every column null
+  void reset();
+
+  friend class RecordBasedFileManager;
+
+private:
+  vector<AttrType> types;
+  unsigned nullIndicatorSize;
+  unsigned headerSize;
+  unsigned nextColumn;
+  unsigned dataEnd;
+  char *record;
+
+  RC setField(unsigned i, AttrType type, const void *value, uint32_t length);
+  // Fills in the offsets of the columns not set yet, and returns the size of the record
+  unsigned finish();
+
+  // A builder owns its record buffer, don't let copies share it
+  RecordBuilder(const RecordBuilder &) = delete;
+  RecordBuilder &operator=(const RecordBuilder &) = delete;
 };
 
 
@@ -165,6 +694,17 @@ public:
   RC createFile(const string &fileName);
   
   RC destroyFile(const string &fileName);
+
+  // Creates a file whose records are kept close to the order of keyAttribute. Inserts go to the page
+  // covering their key, splitting it when it is full (the records moved off it keep their RIDs through
+  // forwarding). Scans with range or equality conditions on the key read only the pages that can match.
+  // Records are not ordered within a page, and vacuumForwardedRecords() / vacuumFile() are not supported.
+  RC createClusteredFile(const string &fileName, const vector<Attribute> &recordDescriptor, const string &keyAttribute);
+
+  // Creates a file for insert-only data such as logs. Inserts always go to the last page, deleteRecord(),
+  // deleteWhere() and vacuumFile() return RBFM_APPEND_ONLY_FILE, and old records are dropped a page range at
+  // a time by discardPages().
+  RC createAppendOnlyFile(const string &fileName);
   
   RC openFile(const string &fileName, FileHandle &fileHandle);
   
@@ -186,7 +726,27 @@ public:
   // For example, refer to the Q6 of Project 1 Environment document.
   RC insertRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, RID &rid);
 
+  // Like insertRecord(), but only puts the record on a page that stays at most fillFactor percent full, leaving the
+  // rest for the page's records to grow into when updated, so they are not forwarded. A new page always takes it.
+  // Clustered and append-only files choose the page by other means and ignore it, see checkFillFactor().
+  RC insertRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, RID &rid, unsigned fillFactor);
+
+  // Whether inserts into the file can keep to fillFactor: RBFM_BAD_FILL_FACTOR if it is not from 1 to 100, and
+  // RBFM_CLUSTERED_FILE or RBFM_APPEND_ONLY_FILE if it is below 100 on a file of that kind
+  RC checkFillFactor(FileHandle &fileHandle, unsigned fillFactor);
+
+  // Inserts a record that was built in the stored format
+  RC insertRecord(FileHandle &fileHandle, RecordBuilder &builder, RID &rid);
+
   RC readRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, void *data);
+
+  // Reads the n records at rids. The RIDs are sorted by page so each page is read once (forwarded records in
+  // a second sorted pass), and the callback receives the records in the order of rids, in readRecord() format.
+  RC readRecords(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID *rids, unsigned n,
+      const RecordBatchCallback &callback);
+
+  // Like readRecord(), but instead of decoding every field the record is left on its page for the view to read
+  RC readRecordView(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, RecordView &view);
   
   // This method will be mainly used for debugging/testing. 
   // The format is as follows:
@@ -202,9 +762,54 @@ IMPORTANT, PLEASE READ: All methods below this comment (other than the construct
 
   // Assume the RID does not change after an update
   RC updateRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, const RID &rid);
+  RC updateRecord(FileHandle &fileHandle, RecordBuilder &builder, const RID &rid);
 
   RC readAttribute(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, const string &attributeName, void *data);
 
+  // Sets one attribute of a record. value has the format of a scan value (no null indicator), NULL sets it to null.
+  // An int or real, or a varchar of the same length, is overwritten in place on the record's page, so the
+  // update costs one page read and one page write. Anything else, and the key of a clustered file, goes
+  // through updateRecord().
+  RC updateAttribute(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid,
+      const string &attributeName, const void *value);
+
+  // Number of records updateRecord() has moved to another page, leaving a forwarding address behind
+  unsigned getForwardedRecordCount();
+
+  // Reads several attributes of one record from a single page read. data receives them in the order of
+  // attributeNames, in the format of a scan with that projection.
+  RC readAttributes(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid,
+      const vector<string> &attributeNames, void *data);
+
+  // Deletes every record satisfying the conditions (see scan()), a page at a time: each page is read once,
+  // has all its matching slots freed, and is written once. Forwarded records are deleted together with
+  // the slots pointing at them. deleted is set to the number of records deleted.
+  RC deleteWhere(FileHandle &fileHandle,
+      const vector<Attribute> &recordDescriptor,
+      const vector<ScanPredicateGroup> &conditions,
+      unsigned &deleted);
+
+  // Deletes every record on pages [firstPage, endPage) of an append-only file, along with the records
+  // forwarded out of them and the forwarding slots of records forwarded into them, so no RID of a deleted
+  // record can later read another. Pages at the end of the file are truncated, the others are left empty.
+  // deleted is set to the number of records deleted.
+  RC discardPages(FileHandle &fileHandle, PageNum firstPage, PageNum endPage, unsigned &deleted);
+
+  // Starts appending to an append-only file through a page kept in memory
+  RC openAppendWriter(FileHandle &fileHandle, AppendWriter &writer);
+
+  // Shortens forwarding chains left behind by updateRecord. A forwarded record is moved back to its
+  // original slot when that page has room for it again, otherwise its original slot is pointed straight
+  // at the record's final location. hopsRemoved is set to the number of forwarding hops eliminated.
+  RC vacuumForwardedRecords(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, unsigned &hopsRemoved);
+
+  // Shrinks the file by truncating the empty pages at its end. With relocate set, records are first moved
+  // off the last pages into free space earlier in the file, for as long as a whole page can be emptied.
+  // Every record whose RID changed is appended to remapped, in the order the moves happened, so that
+  // anything holding RIDs (e.g. an index) can apply them one after the other.
+  RC vacuumFile(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, bool relocate,
+      vector<RIDRemap> &remapped, VacuumStats &stats);
+
   // Scan returns an iterator to allow the caller to go through the results one by one. 
   RC scan(FileHandle &fileHandle,
       const vector<Attribute> &recordDescriptor,
@@ -214,8 +819,78 @@ IMPORTANT, PLEASE READ: All methods below this comment (other than the construct
       const vector<string> &attributeNames, // a list of projected attributes
       RBFM_ScanIterator &rbfm_ScanIterator);
 
+  // Scan with several conditions. A record is returned only if every group has at least one
+  // satisfied predicate. Predicates are evaluated on the page, failing records are never copied out.
+  RC scan(FileHandle &fileHandle,
+      const vector<Attribute> &recordDescriptor,
+      const vector<ScanPredicateGroup> &conditions,
+      const vector<string> &attributeNames,
+      RBFM_ScanIterator &rbfm_ScanIterator);
+
+  // Scan that returns the RIDs of the records satisfying the conditions along with only the attributes the
+  // conditions refer to, in record descriptor order. Pass the surviving RIDs to fetchProjected() for the rest,
+  // so wide attributes are only read for the records that are kept.
+  RC filterScan(FileHandle &fileHandle,
+      const vector<Attribute> &recordDescriptor,
+      const vector<ScanPredicateGroup> &conditions,
+      RBFM_ScanIterator &rbfm_ScanIterator);
+
+  // Reads attributeNames of the records at rids, in the format of a scan with that projection. The RIDs are
+  // sorted by page so each page is read once, forwarded records are read in a second sorted pass, and the
+  // callback then receives the records in the order of rids.
+  RC fetchProjected(FileHandle &fileHandle,
+      const vector<Attribute> &recordDescriptor,
+      const vector<RID> &rids,
+      const vector<string> &attributeNames,
+      const RecordBatchCallback &callback);
+
+  // Scan fileName with numWorkers threads (0 picks one per core). The pages are split into morsels of
+  // PARALLEL_SCAN_MORSEL_PAGES pages that idle workers claim, each worker opening its own file handle.
+  // Returns once every page has been scanned.
+  RC parallelScan(const string &fileName,
+      const vector<Attribute> &recordDescriptor,
+      const vector<ScanPredicateGroup> &conditions,
+      const vector<string> &attributeNames,
+      unsigned numWorkers,
+      const ParallelScanCallback &callback);
+
+  // Loads the rows of a delimited text file (e.g. CSV with ',' or TSV with '\t') into fileHandle.
+  // Each line is a row, with one field per attribute of recordDescriptor in order. An empty field is null,
+  // and a field in double quotes may hold the delimiter (a doubled quote stands for a quote), but no line
+  // breaks. With hasHeader set the first line is skipped. The file is mapped into memory and parsed by
+  // numWorkers threads (0 picks one per core) in morsels of BULK_LOAD_MORSEL_SIZE bytes, each filling
+  // whole pages that are appended BULK_LOAD_BATCH_PAGES at a time, so rows do not keep the order of the file.
+  // Clustered files are not supported.
+  RC bulkLoad(FileHandle &fileHandle,
+      const vector<Attribute> &recordDescriptor,
+      const string &dataFileName,
+      char delimiter,
+      bool hasHeader,
+      unsigned numWorkers,
+      BulkLoadStats &stats);
+
+  // Reads every record of the file to gather its row count and, for each attribute, the fraction of nulls,
+  // the smallest and largest values, an equi-depth histogram and an estimate of the number of distinct values.
+  RC analyzeFile(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, TableStats &stats);
+
+  // Like analyzeFile(), but only reads sampledPages pages picked at random using seed, and sets stats.sampled
+  // if that leaves any page out. Only the row count is scaled up to the whole file. The null fractions and
+  // histograms estimate those of the file, but the smallest and largest values are those of the sampled pages,
+  // and the distinct counts only cover the values seen there.
+  RC analyzeFile(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, unsigned sampledPages, unsigned seed,
+      TableStats &stats);
+
+  // Starts streaming a large value into fileHandle. Attach the finished value to a record with RecordBuilder::setLob().
+  RC createLob(FileHandle &fileHandle, LobWriter &writer);
+
+  // Streams the value of a varchar attribute, whether it is stored in the record or out of line
+  RC openLob(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, const string &attributeName, LobReader &reader);
+
 public:
   friend class RBFM_ScanIterator;
+  friend class RecordView;
+  friend class LobWriter;
+  friend class AppendWriter;
 
 protected:
   RecordBasedFileManager();
@@ -225,10 +900,20 @@ private:
   static RecordBasedFileManager *_rbf_manager;
   static PagedFileManager *_pf_manager;
 
+  unsigned forwardedRecords;
+
   // Private helper methods
 
   void newRecordBasedPage(void * page);
 
+  // Slot directory accessors present every page as v1 entries, whatever its format
+  unsigned getPageFormat(void * page);
+  unsigned getRecordSpaceNeeded(void * page, unsigned recordSize, bool newSlot);
+  SlotDirectoryHeaderV2 getSlotDirectoryHeaderV2(void * page);
+  void setSlotDirectoryHeaderV2(void * page, SlotDirectoryHeaderV2 slotHeader);
+  SlotDirectoryRecordEntryV2 getSlotDirectoryRecordEntryV2(void * page, unsigned recordEntryNumber);
+  void setSlotDirectoryRecordEntryV2(void * page, unsigned recordEntryNumber, SlotDirectoryRecordEntryV2 recordEntry);
+
   SlotDirectoryHeader getSlotDirectoryHeader(void * page);
   void setSlotDirectoryHeader(void * page, SlotDirectoryHeader slotHeader);
 
@@ -236,13 +921,15 @@ private:
   void setSlotDirectoryRecordEntry(void * page, unsigned recordEntryNumber, SlotDirectoryRecordEntry recordEntry);
 
   unsigned getPageFreeSpaceSize(void * page);
-  unsigned getRecordSize(const vector<Attribute> &recordDescriptor, const void *data);
 
   int getNullIndicatorSize(int fieldCount);
   bool fieldIsNull(char *nullIndicator, int i);
+  bool isFixedWidth(const vector<Attribute> &recordDescriptor);
 
-  void setRecordAtOffset(void *page, unsigned offset, const vector<Attribute> &recordDescriptor, const void *data);
-  void getRecordAtOffset(void *record, int32_t offset, const vector<Attribute> &recordDescriptor, void *data);
+  RC encodeRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, void *record, unsigned &recordSize);
+  RC insertEncodedRecord(FileHandle &fileHandle, const void *record, unsigned recordSize, RID &rid, unsigned fillFactor);
+  RC updateEncodedRecord(FileHandle &fileHandle, const void *record, unsigned recordSize, const RID &rid);
+  RC getRecordAtOffset(FileHandle &fileHandle, void *record, int32_t offset, const vector<Attribute> &recordDescriptor, void *data);
 
   SlotStatus getSlotStatus (SlotDirectoryRecordEntry slot);
   unsigned getOpenSlot(void *page);
@@ -250,8 +937,59 @@ private:
   void markSlotDeleted(void *page, unsigned i);
 
   void reorganizePage(void *page);
-
-  void getAttributeFromRecord(void *page, unsigned offset, unsigned attrIndex, AttrType type,void *data);
+  void reorganizePageIfFragmented(void *page);
+  SlotDirectoryRecordEntry allocateRecordSpace(void *page, unsigned recordSize, bool newSlot);
+  unsigned placeRecordOnPage(void *page, const void *record, unsigned length);
+
+  RC readRecordPage(FileHandle &fileHandle, const RID &rid, void *pageData, RID &location, SlotDirectoryRecordEntry &recordEntry);
+  RC getAttributeIndexes(const vector<Attribute> &recordDescriptor, const vector<string> &attributeNames, vector<unsigned> &indexes);
+  unsigned getProjectedRecordSize(void *page, unsigned offset, const vector<Attribute> &recordDescriptor, const vector<unsigned> &projection);
+  RC getProjectedRecord(FileHandle &fileHandle, void *page, unsigned offset, const vector<Attribute> &recordDescriptor,
+      const vector<unsigned> &projection, void *data);
+  RC fetchRecords(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID *rids, unsigned n,
+      const vector<unsigned> &projection, const RecordBatchCallback &callback);
+
+  RC getAttributeFromRecord(FileHandle &fileHandle, void *page, unsigned offset, unsigned attrIndex, AttrType type,void *data);
+  bool findAttributeInRecord(void *page, unsigned offset, unsigned attrIndex, char *&attrStart, uint32_t &attrLength, bool &isLob);
+
+  // Large object helpers
+  void newOverflowPage(void *page);
+  bool isOverflowPage(void *page);
+  RC writeLob(FileHandle &fileHandle, const void *value, uint32_t length, LobPointer &pointer);
+  RC readLob(FileHandle &fileHandle, const LobPointer &pointer, void *value);
+  RC freeLob(FileHandle &fileHandle, const LobPointer &pointer);
+  void getRecordLobs(const void *record, vector<LobPointer> &lobs);
+  RC freeLobs(FileHandle &fileHandle, const vector<LobPointer> &lobs);
+  RC readVarcharValue(FileHandle &fileHandle, const char *attrStart, uint32_t attrLength, bool isLob, void *data, uint32_t &length);
+
+  // Statistics helpers
+  RC analyzePages(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const vector<PageNum> &pages, TableStats &stats);
+  void samplePageList(vector<PageNum> &pages, unsigned count, unsigned seed);
+  uint64_t hashValue(const string &value);
+  unsigned estimateDistinct(const vector<uint8_t> &registers);
+
+  bool parseDelimitedRow(const vector<Attribute> &recordDescriptor, const char *line, size_t length, char delimiter,
+      vector<char> &data, bool &hasLob);
+
+  // Append-only file helpers
+  void newAppendOnlyPage(void *page);
+  bool isAppendOnlyPage(void *page);
+  unsigned appendRecordToPage(void *page, const void *record, unsigned recordSize);
+  RC appendEncodedRecord(FileHandle &fileHandle, void *pageData, const void *record, unsigned recordSize, RID &rid);
+
+  // Clustered file helpers
+  void newClusteredPage(void *page);
+  bool isClusterHeaderPage(void *page);
+  RC readClusterDirectory(FileHandle &fileHandle, void *headerPage, ClusterHeader &header, vector<ClusterDirectoryEntry> &entries);
+  RC writeClusterDirectory(FileHandle &fileHandle, void *headerPage, ClusterHeader &header, const vector<ClusterDirectoryEntry> &entries);
+  RC getClusterKey(const void *record, const ClusterHeader &header, string &key);
+  int compareClusterKeys(AttrType type, const string &first, const string &second);
+  unsigned findClusterEntry(AttrType type, const vector<ClusterDirectoryEntry> &entries, const string &key);
+  bool clusterKeyBelongsOnPage(const ClusterHeader &header, const vector<ClusterDirectoryEntry> &entries, const string &key, PageNum pageNum);
+  RC insertClusteredRecord(FileHandle &fileHandle, void *headerPage, const void *record, unsigned recordSize, RID &rid);
+  RC dropSplitCopy(FileHandle &fileHandle, void *pageData, const RID &rid);
+  RC splitClusteredPage(FileHandle &fileHandle, void *headerPage, ClusterHeader &header, vector<ClusterDirectoryEntry> &entries,
+      unsigned entryIndex, void *pageData, const string &key);
 };
 
 #endif
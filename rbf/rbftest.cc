@@ -7,6 +7,8 @@
 #include <stdexcept>
 #include <stdio.h>
 #include <fstream>
+#include <set>
+#include <algorithm>
 
 #include "pfm.h"
 #include "rbfm.h"
@@ -751,6 +753,2289 @@ int RBFTest_10(RecordBasedFileManager *rbfm) {
     return 0;
 }
 
+int RBFTest_11(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Scan with several ANDed / ORed conditions
+    cout << endl << "***** In RBF Test Case 11 *****" << endl;
+
+    RC rc;
+    string fileName = "test11";
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    RID rid;
+    int recordSize = 0;
+    void *record = malloc(100);
+    void *returnedData = malloc(100);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+
+    // Every 7th record has a NULL age, which never satisfies a condition
+    int numRecords = 1000;
+    int expected = 0;
+    for (int i = 0; i < numRecords; i++)
+    {
+        memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+        if (i % 7 == 0)
+            nullsIndicator[0] = 1 << 6;
+        string name = "Emp" + to_string(i % 10);
+        int age = i % 50;
+        int salary = i * 10;
+        prepareRecord(recordDescriptor.size(), nullsIndicator, name.length(), name, age, 170.0, salary, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+
+        // Age >= 40 AND (Salary < 3000 OR EmpName = "Emp3")
+        if (i % 7 != 0 && age >= 40 && (salary < 3000 || i % 10 == 3))
+            expected++;
+    }
+
+    int ageValue = 40;
+    int salaryValue = 3000;
+    void *nameValue = malloc(8);
+    int nameLength = 4;
+    memcpy(nameValue, &nameLength, sizeof(int));
+    memcpy((char *)nameValue + sizeof(int), "Emp3", nameLength);
+
+    vector<ScanPredicateGroup> conditions(2);
+    conditions[0].push_back({"Age", GE_OP, &ageValue});
+    conditions[1].push_back({"Salary", LT_OP, &salaryValue});
+    conditions[1].push_back({"EmpName", EQ_OP, nameValue});
+
+    vector<string> attributeNames;
+    attributeNames.push_back("Age");
+    attributeNames.push_back("EmpName");
+    attributeNames.push_back("Salary");
+
+    RBFM_ScanIterator rbfmScanIterator;
+    rc = rbfm->scan(fileHandle, recordDescriptor, conditions, attributeNames, rbfmScanIterator);
+    assert(rc == success && "Scanning a file should not fail.");
+
+    int count = 0;
+    while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+    {
+        int age, salary, length;
+        memcpy(&age, (char *)returnedData + 1, sizeof(int));
+        memcpy(&length, (char *)returnedData + 1 + sizeof(int), sizeof(int));
+        memcpy(&salary, (char *)returnedData + 1 + 2 * sizeof(int) + length, sizeof(int));
+        string name((char *)returnedData + 1 + 2 * sizeof(int), length);
+        if (age < ageValue || (salary >= salaryValue && name != "Emp3"))
+        {
+            cout << "[FAIL] Test Case 11 Failed!" << endl << endl;
+            rbfmScanIterator.close();
+            return -1;
+        }
+        count++;
+    }
+    rbfmScanIterator.close();
+
+    cout << "Matching records: " << count << ", expected: " << expected << endl;
+    assert(count == expected && "The scan should return every matching record.");
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(nameValue);
+    free(nullsIndicator);
+    free(record);
+    free(returnedData);
+
+    cout << "RBF Test Case 11 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_12(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Parallel scan
+    cout << endl << "***** In RBF Test Case 12 *****" << endl;
+
+    RC rc;
+    string fileName = "test12";
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    RID rid;
+    int recordSize = 0;
+    void *record = malloc(100);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    // Enough records to span several morsels
+    int numRecords = 20000;
+    long long expectedSum = 0;
+    int expectedCount = 0;
+    for (int i = 0; i < numRecords; i++)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i % 100, 170.0, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        if (i % 100 < 25)
+        {
+            expectedSum += i;
+            expectedCount++;
+        }
+    }
+    cout << "Pages in file: " << fileHandle.getNumberOfPages() << endl;
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    int ageValue = 25;
+    vector<ScanPredicateGroup> conditions(1);
+    conditions[0].push_back({"Age", LT_OP, &ageValue});
+
+    vector<string> attributeNames;
+    attributeNames.push_back("Salary");
+
+    // Each worker accumulates into its own slot, no locking needed
+    unsigned numWorkers = 4;
+    vector<long long> sums(numWorkers, 0);
+    vector<int> counts(numWorkers, 0);
+    auto callback = [&](unsigned worker, const RID &rid, const void *data)
+    {
+        int salary;
+        memcpy(&salary, (char *)data + 1, sizeof(int));
+        sums[worker] += salary;
+        counts[worker]++;
+    };
+    rc = rbfm->parallelScan(fileName, recordDescriptor, conditions, attributeNames, numWorkers, callback);
+    assert(rc == success && "A parallel scan should not fail.");
+
+    long long sum = 0;
+    int count = 0;
+    for (unsigned w = 0; w < numWorkers; w++)
+    {
+        cout << "Worker " << w << " returned " << counts[w] << " records" << endl;
+        sum += sums[w];
+        count += counts[w];
+    }
+    assert(count == expectedCount && sum == expectedSum && "The parallel scan should return every matching record once.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(nullsIndicator);
+    free(record);
+
+    cout << "RBF Test Case 12 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_13(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Read Record View
+    cout << endl << "***** In RBF Test Case 13 *****" << endl;
+
+    RC rc;
+    string fileName = "test13";
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    int recordSize = 0;
+    void *record = malloc(100);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+
+    // One record with every field, one with a NULL height
+    RID rid1, rid2;
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+    prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", 25, 177.8, 6200, record, &recordSize);
+    rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid1);
+    assert(rc == success && "Inserting a record should not fail.");
+
+    nullsIndicator[0] = 1 << 5;
+    prepareRecord(recordDescriptor.size(), nullsIndicator, 6, "Peters", 31, 0, 7100, record, &recordSize);
+    rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid2);
+    assert(rc == success && "Inserting a record should not fail.");
+
+    RecordView view;
+    uint32_t length;
+    rc = rbfm->readRecordView(fileHandle, recordDescriptor, rid1, view);
+    assert(rc == success && "Reading a record view should not fail.");
+    const char *name = view.getVarchar(0, length);
+    cout << "EmpName: " << string(name, length) << " Age: " << view.getInt(1) << " Height: " << view.getReal(2) << " Salary: " << view.getInt(3) << endl;
+    assert(string(name, length) == "Anteater" && view.getInt(1) == 25 && view.getInt(3) == 6200 && "The view should match the inserted record.");
+    assert(view.getReal(2) == (float)177.8 && !view.isNull(2) && "The view should match the inserted record.");
+
+    // The same view can be reused for the next record
+    rc = rbfm->readRecordView(fileHandle, recordDescriptor, rid2, view);
+    assert(rc == success && "Reading a record view should not fail.");
+    name = view.getVarchar(0, length);
+    assert(string(name, length) == "Peters" && view.getInt(1) == 31 && view.getInt(3) == 7100 && "The view should match the inserted record.");
+    assert(view.isNull(2) && "A NULL field should read as NULL.");
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(nullsIndicator);
+    free(record);
+
+    cout << "RBF Test Case 13 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_14(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Vacuum forwarded records
+    cout << endl << "***** In RBF Test Case 14 *****" << endl;
+
+    RC rc;
+    string fileName = "test14";
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    int recordSize = 0;
+    void *record = malloc(2000);
+    void *returnedData = malloc(2000);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    // Fill a few pages with small records
+    vector<RID> rids;
+    RID rid;
+    for (int i = 0; i < 300; i++)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i, 170.0, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        rids.push_back(rid);
+    }
+
+    // Grow the first record so it is forwarded off its full page, fill the page it landed on,
+    // then grow it again so it is forwarded a second time
+    string name(300, 'a');
+    prepareRecord(recordDescriptor.size(), nullsIndicator, name.length(), name, 0, 170.0, 0, record, &recordSize);
+    rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[0]);
+    assert(rc == success && "Updating a record should not fail.");
+
+    unsigned numPages = fileHandle.getNumberOfPages();
+    while (fileHandle.getNumberOfPages() == numPages)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", 0, 170.0, 0, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+
+    name = string(1000, 'b');
+    prepareRecord(recordDescriptor.size(), nullsIndicator, name.length(), name, 0, 170.0, 0, record, &recordSize);
+    rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[0]);
+    assert(rc == success && "Updating a record should not fail.");
+
+    // The home page is still full, so the chain can only be shortened
+    unsigned hopsRemoved = 0;
+    rc = rbfm->vacuumForwardedRecords(fileHandle, recordDescriptor, hopsRemoved);
+    assert(rc == success && "Vacuuming forwarded records should not fail.");
+    cout << "Hops removed while the home page is full: " << hopsRemoved << endl;
+    assert(hopsRemoved == 1 && "The two hop chain should be collapsed to one hop.");
+
+    // Make room on the home page, the record can then move back
+    for (int i = 1; i <= 40; i++)
+    {
+        assert(rids[i].pageNum == rids[0].pageNum);
+        rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rids[i]);
+        assert(rc == success && "Deleting a record should not fail.");
+    }
+    rc = rbfm->vacuumForwardedRecords(fileHandle, recordDescriptor, hopsRemoved);
+    assert(rc == success && "Vacuuming forwarded records should not fail.");
+    cout << "Hops removed after making room: " << hopsRemoved << endl;
+    assert(hopsRemoved == 1 && "The record should be moved back home.");
+
+    // Reading it back now takes a single page read
+    unsigned readBefore, readAfter, writeCount, appendCount;
+    fileHandle.collectCounterValues(readBefore, writeCount, appendCount);
+    rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[0], returnedData);
+    assert(rc == success && "Reading a record should not fail.");
+    fileHandle.collectCounterValues(readAfter, writeCount, appendCount);
+    assert(readAfter - readBefore == 1 && "A record at home should be read with one page read.");
+    assert(memcmp(record, returnedData, recordSize) == 0 && "The vacuumed record should not change.");
+
+    // Every other record is untouched
+    for (int i = 41; i < 300; i++)
+    {
+        int age;
+        rc = rbfm->readAttribute(fileHandle, recordDescriptor, rids[i], "Age", returnedData);
+        assert(rc == success && "Reading an attribute should not fail.");
+        memcpy(&age, (char *)returnedData + 1, sizeof(int));
+        assert(age == i && "Vacuuming should not change other records.");
+    }
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(nullsIndicator);
+    free(record);
+    free(returnedData);
+
+    cout << "RBF Test Case 14 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_15(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Vacuum File
+    cout << endl << "***** In RBF Test Case 15 *****" << endl;
+
+    RC rc;
+    string fileName = "test15";
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    int recordSize = 0;
+    void *record = malloc(1000);
+    void *returnedData = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    int numRecords = 2000;
+    vector<RID> rids;
+    RID rid;
+    for (int i = 0; i < numRecords; i++)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i, 170.0, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        rids.push_back(rid);
+    }
+
+    // Forward the first record off its full page
+    string name(500, 'a');
+    prepareRecord(recordDescriptor.size(), nullsIndicator, name.length(), name, 0, 170.0, 0, record, &recordSize);
+    rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[0]);
+    assert(rc == success && "Updating a record should not fail.");
+
+    // Keep every fourth record
+    for (int i = 1; i < numRecords; i++)
+    {
+        if (i % 4 == 0)
+            continue;
+        rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rids[i]);
+        assert(rc == success && "Deleting a record should not fail.");
+    }
+
+    vector<RIDRemap> remapped;
+    VacuumStats stats;
+    rc = rbfm->vacuumFile(fileHandle, recordDescriptor, true, remapped, stats);
+    assert(rc == success && "Vacuuming a file should not fail.");
+    cout << "Pages before: " << stats.pagesBefore << " after: " << stats.pagesAfter << endl;
+    cout << "Records relocated: " << stats.recordsRelocated << " bytes reclaimed: " << stats.bytesReclaimed << endl;
+    assert(stats.pagesAfter < stats.pagesBefore && fileHandle.getNumberOfPages() == stats.pagesAfter && "Vacuuming should shrink the file.");
+
+    // Apply the remapping in order, then every surviving record must still be readable
+    for (RIDRemap &remap : remapped)
+    {
+        for (RID &r : rids)
+        {
+            if (r.pageNum == remap.oldRid.pageNum && r.slotNum == remap.oldRid.slotNum)
+                r = remap.newRid;
+        }
+    }
+    rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[0], returnedData);
+    assert(rc == success && memcmp(record, returnedData, recordSize) == 0 && "The forwarded record should survive vacuuming.");
+    for (int i = 4; i < numRecords; i += 4)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i, 170.0, i, record, &recordSize);
+        rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+        assert(rc == success && memcmp(record, returnedData, recordSize) == 0 && "Relocated records should not change.");
+    }
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(nullsIndicator);
+    free(record);
+    free(returnedData);
+
+    cout << "RBF Test Case 15 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_16(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Page format v2: 4 byte slots and dead slot reuse
+    cout << endl << "***** In RBF Test Case 16 *****" << endl;
+
+    RC rc;
+    string fileName = "test16";
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    vector<Attribute> recordDescriptor;
+    Attribute attr;
+    attr.name = "Value";
+    attr.type = TypeInt;
+    attr.length = (AttrLength)4;
+    recordDescriptor.push_back(attr);
+
+    char record[sizeof(char) + sizeof(int)];
+    char returnedData[sizeof(char) + sizeof(int)];
+    record[0] = 0;
+
+    // 300 small records fit on one v2 page, but would not with 8 byte slots
+    int numRecords = 300;
+    vector<RID> rids;
+    RID rid;
+    for (int i = 0; i < numRecords; i++)
+    {
+        memcpy(record + 1, &i, sizeof(int));
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        rids.push_back(rid);
+    }
+    assert(fileHandle.getNumberOfPages() == 1 && "All records should fit on one page.");
+
+    // Dead slots are handed out again, most recently deleted first
+    for (int i = 10; i <= 30; i += 10)
+    {
+        rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rids[i]);
+        assert(rc == success && "Deleting a record should not fail.");
+    }
+    for (int i = 30; i >= 10; i -= 10)
+    {
+        int value = numRecords + i;
+        memcpy(record + 1, &value, sizeof(int));
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        assert(rid.pageNum == 0 && rid.slotNum == rids[i].slotNum && "A dead slot should be reused.");
+    }
+
+    for (int i = 0; i < numRecords; i++)
+    {
+        int value = i % 10 == 0 && i >= 10 && i <= 30 ? numRecords + i : i;
+        memcpy(record + 1, &value, sizeof(int));
+        rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+        assert(rc == success && memcmp(record, returnedData, sizeof(returnedData)) == 0 && "Records should not change.");
+    }
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "RBF Test Case 16 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_17(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Fixed-width records, through a C++ schema and through insert/read
+    cout << endl << "***** In RBF Test Case 17 *****" << endl;
+
+    typedef FixedWidthSchema<TypeInt, TypeReal, TypeInt> PointSchema;
+    static_assert(PointSchema::columns == 3, "PointSchema has three columns");
+    static_assert(PointSchema::recordSize == sizeof(RecordLength) + 1 + 3 * sizeof(ColumnOffset) + 12, "PointSchema record size");
+
+    vector<Attribute> recordDescriptor;
+    Attribute attr;
+    attr.name = "X";
+    attr.type = TypeInt;
+    attr.length = (AttrLength)4;
+    recordDescriptor.push_back(attr);
+    attr.name = "Weight";
+    attr.type = TypeReal;
+    recordDescriptor.push_back(attr);
+    attr.name = "Y";
+    attr.type = TypeInt;
+    recordDescriptor.push_back(attr);
+    assert(PointSchema::matches(recordDescriptor) && "The schema should match its descriptor.");
+
+    char record[PointSchema::apiSize];
+    char encoded[PointSchema::recordSize];
+    char returnedData[PointSchema::apiSize];
+    int x = 3;
+    float weight = 1.5;
+    int y = -7;
+    record[0] = 0;
+    memcpy(record + 1, &x, sizeof(int));
+    memcpy(record + 5, &weight, sizeof(float));
+    memcpy(record + 9, &y, sizeof(int));
+    PointSchema::encode(encoded, record);
+    assert(PointSchema::isStoredWith(encoded) && "An encoded record should use the fixed-width layout.");
+    PointSchema::decode(encoded, returnedData);
+    assert(memcmp(record, returnedData, sizeof(record)) == 0 && "Decoding should return the encoded record.");
+
+    RC rc;
+    string fileName = "test17";
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    // Records with and without nulls must both round trip
+    RID rid;
+    rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+    assert(rc == success && "Inserting a record should not fail.");
+    rc = rbfm->readRecord(fileHandle, recordDescriptor, rid, returnedData);
+    assert(rc == success && memcmp(record, returnedData, sizeof(record)) == 0 && "Reading a fixed-width record should not change it.");
+
+    char nullRecord[1 + 2 * sizeof(int)];
+    nullRecord[0] = 0x40;
+    memcpy(nullRecord + 1, &x, sizeof(int));
+    memcpy(nullRecord + 5, &y, sizeof(int));
+    rc = rbfm->insertRecord(fileHandle, recordDescriptor, nullRecord, rid);
+    assert(rc == success && "Inserting a record should not fail.");
+    rc = rbfm->readRecord(fileHandle, recordDescriptor, rid, returnedData);
+    assert(rc == success && memcmp(nullRecord, returnedData, sizeof(nullRecord)) == 0 && "Reading a record with nulls should not change it.");
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "RBF Test Case 17 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_18(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Insert and update records built with RecordBuilder
+    cout << endl << "***** In RBF Test Case 18 *****" << endl;
+
+    RC rc;
+    string fileName = "test18";
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    int recordSize = 0;
+    void *record = malloc(100);
+    void *returnedData = malloc(100);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    RecordBuilder builder(recordDescriptor);
+    rc = builder.setVarchar(0, "Anteater", 8);
+    assert(rc == success && "Setting a field should not fail.");
+    rc = builder.setInt(1, 25);
+    assert(rc == success && "Setting a field should not fail.");
+    rc = builder.setReal(2, 177.8);
+    assert(rc == success && "Setting a field should not fail.");
+    rc = builder.setInt(3, 6200);
+    assert(rc == success && "Setting a field should not fail.");
+    assert(builder.setInt(1, 30) == RBFM_BAD_FIELD && "Fields must be set in column order.");
+
+    RID rid;
+    rc = rbfm->insertRecord(fileHandle, builder, rid);
+    assert(rc == success && "Inserting a built record should not fail.");
+
+    prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", 25, 177.8, 6200, record, &recordSize);
+    rc = rbfm->readRecord(fileHandle, recordDescriptor, rid, returnedData);
+    assert(rc == success && memcmp(record, returnedData, recordSize) == 0 && "A built record should read back like an encoded one.");
+
+    // Skipped and unset columns are null
+    builder.reset();
+    rc = builder.setInt(1, 40);
+    assert(rc == success && "Setting a field should not fail.");
+    rc = rbfm->updateRecord(fileHandle, builder, rid);
+    assert(rc == success && "Updating with a built record should not fail.");
+
+    nullsIndicator[0] = 0xB0;
+    prepareRecord(recordDescriptor.size(), nullsIndicator, 0, "", 40, 0, 0, record, &recordSize);
+    rc = rbfm->readRecord(fileHandle, recordDescriptor, rid, returnedData);
+    assert(rc == success && memcmp(record, returnedData, recordSize) == 0 && "Unset fields should read back as null.");
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(nullsIndicator);
+    free(record);
+    free(returnedData);
+
+    cout << "RBF Test Case 18 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_19(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Varchars stored out of line in overflow pages
+    // 2. Streaming large values in and out
+    cout << endl << "***** In RBF Test Case 19 *****" << endl;
+
+    RC rc;
+    string fileName = "test19";
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    int recordSize = 0;
+    void *record = malloc(12000);
+    void *returnedData = malloc(12000);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    // A value spanning several pages reads back whole
+    string name;
+    for (int i = 0; i < 10000; i++)
+        name += (char) ('a' + i % 26);
+    prepareRecord(recordDescriptor.size(), nullsIndicator, name.length(), name, 30, 180.5, 4000, record, &recordSize);
+    RID rid;
+    rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+    assert(rc == success && "Inserting a record with a large value should not fail.");
+    rc = rbfm->readRecord(fileHandle, recordDescriptor, rid, returnedData);
+    assert(rc == success && memcmp(record, returnedData, recordSize) == 0 && "A large value should read back whole.");
+
+    // Scans compare and project large values too
+    RBFM_ScanIterator rbfm_ScanIterator;
+    vector<string> attributeNames;
+    attributeNames.push_back("EmpName");
+    char *value = (char*) malloc(sizeof(int) + name.length());
+    int nameLength = name.length();
+    memcpy(value, &nameLength, sizeof(int));
+    memcpy(value + sizeof(int), name.c_str(), nameLength);
+    rc = rbfm->scan(fileHandle, recordDescriptor, "EmpName", EQ_OP, value, attributeNames, rbfm_ScanIterator);
+    assert(rc == success && "Scanning should not fail.");
+    RID scanRid;
+    rc = rbfm_ScanIterator.getNextRecord(scanRid, returnedData);
+    assert(rc == success && memcmp((char*) returnedData + 1, value, sizeof(int) + nameLength) == 0 && "The scan should return the large value.");
+    assert(rbfm_ScanIterator.getNextRecord(scanRid, returnedData) == RBFM_EOF && "The scan should return one record.");
+    rbfm_ScanIterator.close();
+    free(value);
+
+    // Read the value back in chunks
+    LobReader reader;
+    rc = rbfm->openLob(fileHandle, recordDescriptor, rid, "EmpName", reader);
+    assert(rc == success && reader.length() == name.length() && "Opening a large value should not fail.");
+    string streamed;
+    char chunk[1000];
+    uint32_t bytesRead;
+    do
+    {
+        rc = reader.read(chunk, sizeof(chunk), bytesRead);
+        assert(rc == success && "Reading a chunk should not fail.");
+        streamed.append(chunk, bytesRead);
+    } while (bytesRead > 0);
+    assert(streamed == name && "Streaming should return the whole value.");
+
+    // Shrinking the value frees its overflow pages
+    prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", 30, 180.5, 4000, record, &recordSize);
+    rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rid);
+    assert(rc == success && "Updating a record should not fail.");
+    rc = rbfm->readRecord(fileHandle, recordDescriptor, rid, returnedData);
+    assert(rc == success && memcmp(record, returnedData, recordSize) == 0 && "The updated record should read back.");
+
+    // Stream a value in, and attach it with a builder
+    LobWriter writer;
+    rc = rbfm->createLob(fileHandle, writer);
+    assert(rc == success && "Creating a large value should not fail.");
+    for (unsigned i = 0; i < name.length(); i += sizeof(chunk))
+    {
+        rc = writer.write(name.c_str() + i, min((size_t) sizeof(chunk), name.length() - i));
+        assert(rc == success && "Writing a chunk should not fail.");
+    }
+    LobPointer pointer;
+    rc = writer.close(pointer);
+    assert(rc == success && pointer.length == name.length() && "Closing a large value should not fail.");
+
+    RecordBuilder builder(recordDescriptor);
+    builder.setLob(0, pointer);
+    builder.setInt(1, 31);
+    builder.setReal(2, 181.5);
+    builder.setInt(3, 4100);
+    rc = rbfm->insertRecord(fileHandle, builder, rid);
+    assert(rc == success && "Inserting a built record should not fail.");
+    prepareRecord(recordDescriptor.size(), nullsIndicator, name.length(), name, 31, 181.5, 4100, record, &recordSize);
+    rc = rbfm->readRecord(fileHandle, recordDescriptor, rid, returnedData);
+    assert(rc == success && memcmp(record, returnedData, recordSize) == 0 && "A streamed value should read back whole.");
+
+    rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rid);
+    assert(rc == success && "Deleting a record should not fail.");
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(nullsIndicator);
+    free(record);
+    free(returnedData);
+
+    cout << "RBF Test Case 19 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_20(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Delete Where, including forwarded records
+    cout << endl << "***** In RBF Test Case 20 *****" << endl;
+
+    RC rc;
+    string fileName = "test20";
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    int recordSize = 0;
+    void *record = malloc(1000);
+    void *returnedData = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    int numRecords = 2000;
+    vector<RID> rids;
+    RID rid;
+    for (int i = 0; i < numRecords; i++)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i, 170.0, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        rids.push_back(rid);
+    }
+
+    // Make room on the first page, so a record from the last page is forwarded back to it
+    for (int i = 1; i <= 20; i++)
+    {
+        rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rids[i]);
+        assert(rc == success && "Deleting a record should not fail.");
+    }
+    string name(500, 'a');
+    int forwarded[] = {1996, 1990, 25};
+    for (int i : forwarded)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, name.length(), name, i, 170.0, i, record, &recordSize);
+        rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Updating a record should not fail.");
+    }
+
+    // Age < 1000 OR Age >= 1995
+    int low = 1000;
+    int high = 1995;
+    vector<ScanPredicateGroup> conditions(1);
+    ScanPredicate predicate;
+    predicate.attribute = "Age";
+    predicate.compOp = LT_OP;
+    predicate.value = &low;
+    conditions[0].push_back(predicate);
+    predicate.compOp = GE_OP;
+    predicate.value = &high;
+    conditions[0].push_back(predicate);
+
+    unsigned deleted;
+    rc = rbfm->deleteWhere(fileHandle, recordDescriptor, conditions, deleted);
+    assert(rc == success && "Delete where should not fail.");
+    assert(deleted == 1000 - 20 + 5 && "Delete where should delete every matching record.");
+
+    for (int i = 0; i < numRecords; i++)
+    {
+        rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+        if (i < low || i >= high)
+        {
+            assert(rc != success && "Deleted records should not be readable.");
+            continue;
+        }
+        if (i == 1990)
+            prepareRecord(recordDescriptor.size(), nullsIndicator, name.length(), name, i, 170.0, i, record, &recordSize);
+        else
+            prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i, 170.0, i, record, &recordSize);
+        assert(rc == success && memcmp(record, returnedData, recordSize) == 0 && "Other records should survive.");
+    }
+
+    // Every slot pointing at a deleted record was freed too, so a scan finds only the survivors
+    RBFM_ScanIterator rbfm_ScanIterator;
+    vector<string> attributeNames;
+    rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributeNames, rbfm_ScanIterator);
+    assert(rc == success && "Scanning should not fail.");
+    int count = 0;
+    while (rbfm_ScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+        count++;
+    rbfm_ScanIterator.close();
+    assert(count == high - low && "Only the surviving records should be left.");
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(nullsIndicator);
+    free(record);
+    free(returnedData);
+
+    cout << "RBF Test Case 20 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_21(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Create Clustered File
+    // 2. Insert Records out of key order, splitting pages
+    // 3. Range Scan on the key
+    // 4. Update the key of a record
+    cout << endl << "***** In RBF Test Case 21 *****" << endl;
+
+    RC rc;
+    string fileName = "test21";
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    rc = rbfm->createClusteredFile(fileName, recordDescriptor, "Age");
+    assert(rc == success && "Creating a clustered file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    int recordSize = 0;
+    void *record = malloc(1000);
+    void *returnedData = malloc(1000);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    // Every age once, in scrambled order
+    int numRecords = 3000;
+    vector<RID> rids(numRecords);
+    for (int i = 0; i < numRecords; i++)
+    {
+        int age = (i * 7919) % numRecords;
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", age, 170.0, age, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rids[age]);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+
+    // Records moved by page splits are still found through their original RIDs
+    for (int age = 0; age < numRecords; age++)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", age, 170.0, age, record, &recordSize);
+        rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[age], returnedData);
+        assert(rc == success && memcmp(record, returnedData, recordSize) == 0 && "Every record should read back.");
+    }
+
+    // A full scan visits the pages in key order, so their key ranges never overlap
+    RBFM_ScanIterator rbfm_ScanIterator;
+    vector<string> attributeNames;
+    attributeNames.push_back("Age");
+    rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributeNames, rbfm_ScanIterator);
+    assert(rc == success && "Scanning should not fail.");
+    RID rid;
+    int count = 0;
+    int previousMax = -1, pageMin = INT_MAX, pageMax = -1;
+    uint32_t page = UINT_MAX;
+    while (rbfm_ScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+    {
+        int age;
+        memcpy(&age, (char*) returnedData + 1, sizeof(int));
+        if (rid.pageNum != page)
+        {
+            assert(previousMax < pageMin && "Pages should be visited in key order.");
+            previousMax = max(previousMax, pageMax);
+            page = rid.pageNum;
+            pageMin = INT_MAX;
+            pageMax = -1;
+        }
+        pageMin = min(pageMin, age);
+        pageMax = max(pageMax, age);
+        count++;
+    }
+    assert(previousMax < pageMin && "Pages should be visited in key order.");
+    rbfm_ScanIterator.close();
+    assert(count == numRecords && "A full scan should return every record.");
+
+    // 1000 <= Age < 1100 reads only the few pages covering the range
+    int low = 1000;
+    int high = 1100;
+    vector<ScanPredicateGroup> conditions(2);
+    ScanPredicate predicate;
+    predicate.attribute = "Age";
+    predicate.compOp = GE_OP;
+    predicate.value = &low;
+    conditions[0].push_back(predicate);
+    predicate.compOp = LT_OP;
+    predicate.value = &high;
+    conditions[1].push_back(predicate);
+    rc = rbfm->scan(fileHandle, recordDescriptor, conditions, attributeNames, rbfm_ScanIterator);
+    assert(rc == success && "Scanning should not fail.");
+    set<uint32_t> pages;
+    count = 0;
+    while (rbfm_ScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+    {
+        int age;
+        memcpy(&age, (char*) returnedData + 1, sizeof(int));
+        assert(age >= low && age < high && "Only matching records should be returned.");
+        pages.insert(rid.pageNum);
+        count++;
+    }
+    rbfm_ScanIterator.close();
+    assert(count == high - low && "Every matching record should be returned.");
+    assert(pages.size() * 4 < fileHandle.getNumberOfPages() && "A range scan should stay on the pages of its range.");
+
+    // Change a key, and grow another record past what its page can hold
+    int newAge = 5000;
+    prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", newAge, 170.0, 7, record, &recordSize);
+    rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[5]);
+    assert(rc == success && "Updating a record should not fail.");
+    rc = rbfm->scan(fileHandle, recordDescriptor, "Age", EQ_OP, &newAge, attributeNames, rbfm_ScanIterator);
+    assert(rc == success && "Scanning should not fail.");
+    assert(rbfm_ScanIterator.getNextRecord(rid, returnedData) == success && "The new key should be found.");
+    assert(rbfm_ScanIterator.getNextRecord(rid, returnedData) == RBFM_EOF && "The new key should be found once.");
+    rbfm_ScanIterator.close();
+    rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[5], returnedData);
+    assert(rc == success && memcmp(record, returnedData, recordSize) == 0 && "The updated record should read back.");
+
+    string name(500, 'a');
+    prepareRecord(recordDescriptor.size(), nullsIndicator, name.length(), name, 1050, 170.0, 0, record, &recordSize);
+    rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[1050]);
+    assert(rc == success && "Updating a record should not fail.");
+    rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[1050], returnedData);
+    assert(rc == success && memcmp(record, returnedData, recordSize) == 0 && "The updated record should read back.");
+    rc = rbfm->scan(fileHandle, recordDescriptor, conditions, attributeNames, rbfm_ScanIterator);
+    assert(rc == success && "Scanning should not fail.");
+    count = 0;
+    while (rbfm_ScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+        count++;
+    rbfm_ScanIterator.close();
+    assert(count == high - low && "A grown record should still be found by a range scan.");
+
+    unsigned hopsRemoved;
+    rc = rbfm->vacuumForwardedRecords(fileHandle, recordDescriptor, hopsRemoved);
+    assert(rc == RBFM_CLUSTERED_FILE && "Vacuuming would break the key order.");
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(nullsIndicator);
+    free(record);
+    free(returnedData);
+
+    cout << "RBF Test Case 21 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_22(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Create Append-Only File
+    // 2. Insert Records, directly and through an AppendWriter
+    // 3. Delete Records (rejected)
+    // 4. Discard Pages
+    cout << endl << "***** In RBF Test Case 22 *****" << endl;
+
+    RC rc;
+    string fileName = "test22";
+
+    rc = rbfm->createAppendOnlyFile(fileName);
+    assert(rc == success && "Creating an append-only file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    int recordSize = 0;
+    void *record = malloc(1000);
+    void *returnedData = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    // Records always go after the last one
+    int numRecords = 1500;
+    int numDirect = 500;
+    vector<RID> rids(numRecords);
+    for (int i = 0; i < numDirect; i++)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i, 170.0, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+
+    rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rids[10]);
+    assert(rc == RBFM_APPEND_ONLY_FILE && "Deleting from an append-only file should be rejected.");
+    unsigned deleted;
+    rc = rbfm->deleteWhere(fileHandle, recordDescriptor, vector<ScanPredicateGroup>(), deleted);
+    assert(rc == RBFM_APPEND_ONLY_FILE && "Deleting from an append-only file should be rejected.");
+
+    AppendWriter writer;
+    rc = rbfm->openAppendWriter(fileHandle, writer);
+    assert(rc == success && "Opening an append writer should not fail.");
+    for (int i = numDirect; i < numRecords; i++)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i, 170.0, i, record, &recordSize);
+        rc = writer.insertRecord(recordDescriptor, record, rids[i]);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    rc = writer.close();
+    assert(rc == success && "Closing the append writer should not fail.");
+
+    for (int i = 0; i < numRecords; i++)
+    {
+        if (i > 0)
+            assert((rids[i].pageNum > rids[i - 1].pageNum || (rids[i].pageNum == rids[i - 1].pageNum && rids[i].slotNum == rids[i - 1].slotNum + 1))
+                && "Every record should take the next slot.");
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i, 170.0, i, record, &recordSize);
+        rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+        assert(rc == success && memcmp(record, returnedData, recordSize) == 0 && "Every record should read back.");
+    }
+
+    // Grow a record in the middle, forwarding it to the last page
+    int grown = 700;
+    string name(500, 'a');
+    prepareRecord(recordDescriptor.size(), nullsIndicator, name.length(), name, grown, 170.0, grown, record, &recordSize);
+    rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[grown]);
+    assert(rc == success && "Updating a record should not fail.");
+
+    // Drop the oldest pages, then the newest ones
+    PageNum oldEnd = rids[300].pageNum;
+    rc = rbfm->discardPages(fileHandle, 0, oldEnd, deleted);
+    assert(rc == success && "Discarding pages should not fail.");
+    PageNum newStart = rids[1200].pageNum;
+    unsigned deletedNew;
+    rc = rbfm->discardPages(fileHandle, newStart, UINT_MAX, deletedNew);
+    assert(rc == success && "Discarding pages should not fail.");
+    assert(fileHandle.getNumberOfPages() == newStart && "The pages at the end should be truncated.");
+
+    unsigned expectedOld = 0, expectedNew = 0;
+    for (int i = 0; i < numRecords; i++)
+    {
+        rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+        if (rids[i].pageNum < oldEnd || rids[i].pageNum >= newStart || i == grown)
+        {
+            rids[i].pageNum < oldEnd ? expectedOld++ : expectedNew++;
+            assert(rc != success && "Discarded records should not be readable.");
+        }
+        else
+            assert(rc == success && "Other records should survive.");
+    }
+    assert(deleted == expectedOld && deletedNew == expectedNew && "Every record on the pages should be counted.");
+
+    // The pages of the newest records fill up again, but the grown record's RID still reads nothing
+    RID rid;
+    for (int i = 0; i < 2 * (numRecords - 1200); i++)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i, 170.0, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    assert(fileHandle.getNumberOfPages() > newStart && "The discarded pages should be in use again.");
+    rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[grown], returnedData);
+    assert(rc != success && "A record forwarded into discarded pages should stay deleted.");
+
+    vector<RIDRemap> remapped;
+    VacuumStats vacuumStats;
+    rc = rbfm->vacuumFile(fileHandle, recordDescriptor, true, remapped, vacuumStats);
+    assert(rc == RBFM_APPEND_ONLY_FILE && "Relocating records would break the order of an append-only file.");
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(nullsIndicator);
+    free(record);
+    free(returnedData);
+
+    cout << "RBF Test Case 22 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_23(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Scan with a Limit
+    // 2. Resume a Scan from a Continuation Token
+    cout << endl << "***** In RBF Test Case 23 *****" << endl;
+
+    RC rc;
+    string fileName = "test23";
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    int recordSize = 0;
+    void *record = malloc(1000);
+    void *returnedData = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    int numRecords = 1000;
+    RID rid;
+    for (int i = 0; i < numRecords; i++)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i, 170.0, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+
+    // Page through Age >= 100 a few records at a time, each page with a new iterator
+    int low = 100;
+    unsigned pageSize = 37;
+    vector<string> attributeNames;
+    attributeNames.push_back("Age");
+    char token[sizeof(ScanToken)];
+    vector<int> ages;
+    bool first = true;
+    while (true)
+    {
+        RBFM_ScanIterator rbfm_ScanIterator;
+        rc = rbfm->scan(fileHandle, recordDescriptor, "Age", GE_OP, &low, attributeNames, rbfm_ScanIterator);
+        assert(rc == success && "Scanning should not fail.");
+        if (!first)
+        {
+            rc = rbfm_ScanIterator.resume(*(ScanToken*) token);
+            assert(rc == success && "Resuming the scan should not fail.");
+        }
+        first = false;
+        rbfm_ScanIterator.setLimit(pageSize);
+
+        unsigned count = 0;
+        while (rbfm_ScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+        {
+            int age;
+            memcpy(&age, (char*) returnedData + 1, sizeof(int));
+            ages.push_back(age);
+            count++;
+        }
+        assert(count <= pageSize && "A scan should stop at its limit.");
+
+        // The token is plain bytes, keep it the way a client would
+        ScanToken continuation;
+        rc = rbfm_ScanIterator.getContinuation(continuation);
+        assert(rc == success && "Getting the continuation should not fail.");
+        memcpy(token, &continuation, sizeof(ScanToken));
+        rbfm_ScanIterator.close();
+        if (count < pageSize)
+            break;
+    }
+    assert(ages.size() == (unsigned) (numRecords - low) && "Paging should return every matching record once.");
+    for (unsigned i = 0; i < ages.size(); i++)
+        assert(ages[i] == low + (int) i && "Paging should return the records in order.");
+
+    // A token only fits the scan it came from
+    RBFM_ScanIterator rbfm_ScanIterator;
+    int otherLow = 200;
+    rc = rbfm->scan(fileHandle, recordDescriptor, "Age", GE_OP, &otherLow, attributeNames, rbfm_ScanIterator);
+    assert(rc == success && "Scanning should not fail.");
+    rc = rbfm_ScanIterator.resume(*(ScanToken*) token);
+    assert(rc == RBFM_BAD_SCAN_TOKEN && "A token from another scan should be rejected.");
+    rbfm_ScanIterator.close();
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(nullsIndicator);
+    free(record);
+    free(returnedData);
+
+    cout << "RBF Test Case 23 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_24(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Bulk Load a CSV file with several workers
+    // 2. Scan the loaded records
+    cout << endl << "***** In RBF Test Case 24 *****" << endl;
+
+    RC rc;
+    string fileName = "test24";
+    string csvName = "test24.csv";
+
+    // Big enough for several morsels. Every tenth name is null, one is quoted, one is stored out of line,
+    // and one row does not parse.
+    int numRows = 100000;
+    ofstream csv(csvName.c_str());
+    csv << "EmpName,Age,Height,Salary\n";
+    long long ageSum = 0;
+    for (int i = 0; i < numRows; i++)
+    {
+        if (i % 10 == 0)
+            csv << "";
+        else if (i == 1)
+            csv << "\"Ant,\"\"eater\"\"\"";
+        else if (i == 2)
+            csv << string(2000, 'a');
+        else
+            csv << "Anteater";
+        csv << "," << i << "," << 170.5 << "," << i * 2 << "\r\n";
+        ageSum += i;
+    }
+    csv << "Anteater,notanumber,170.5,0\n";
+    csv.close();
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    BulkLoadStats stats;
+    rc = rbfm->bulkLoad(fileHandle, recordDescriptor, csvName, ',', true, 4, stats);
+    assert(rc == success && "Bulk loading should not fail.");
+    assert(stats.rows == (unsigned) numRows && stats.rejectedRows == 1 && "Every valid row should be loaded.");
+    cout << stats.rows << " rows loaded in " << stats.seconds << " s (" << (unsigned) stats.rowsPerSecond << " rows/s)" << endl;
+
+    RBFM_ScanIterator rbfm_ScanIterator;
+    vector<string> attributeNames;
+    attributeNames.push_back("EmpName");
+    attributeNames.push_back("Age");
+    rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributeNames, rbfm_ScanIterator);
+    assert(rc == success && "Scanning should not fail.");
+    RID rid;
+    char *returnedData = (char*) malloc(PAGE_SIZE);
+    int count = 0, nulls = 0;
+    long long scannedAgeSum = 0;
+    while (rbfm_ScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+    {
+        int age;
+        if (returnedData[0] & 0x80)
+        {
+            nulls++;
+            memcpy(&age, returnedData + 1, sizeof(int));
+        }
+        else
+        {
+            int nameLength;
+            memcpy(&nameLength, returnedData + 1, sizeof(int));
+            memcpy(&age, returnedData + 1 + sizeof(int) + nameLength, sizeof(int));
+            if (age == 1)
+                assert(string(returnedData + 1 + sizeof(int), nameLength) == "Ant,\"eater\"" && "Quoted fields should be unquoted.");
+            if (age == 2)
+                assert(nameLength == 2000 && "Long values should load whole.");
+        }
+        scannedAgeSum += age;
+        count++;
+    }
+    rbfm_ScanIterator.close();
+    assert(count == numRows && nulls == numRows / 10 && scannedAgeSum == ageSum && "The loaded records should match the file.");
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+    remove(csvName.c_str());
+
+    free(returnedData);
+
+    cout << "RBF Test Case 24 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_25(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Filter Scan returning RIDs and the filter columns
+    // 2. Fetch the projection of the surviving RIDs
+    cout << endl << "***** In RBF Test Case 25 *****" << endl;
+
+    RC rc;
+    string fileName = "test25";
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    int recordSize = 0;
+    void *record = malloc(1000);
+    void *returnedData = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    int numRecords = 1000;
+    vector<RID> rids;
+    RID rid;
+    for (int i = 0; i < numRecords; i++)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i, 170.0, i * 10, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        rids.push_back(rid);
+    }
+
+    // Grow every seventh record so many of them are forwarded to other pages
+    string longName(400, 'w');
+    for (int i = 0; i < numRecords; i += 7)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, longName.size(), longName, i, 170.0, i * 10, record, &recordSize);
+        rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Updating a record should not fail.");
+    }
+
+    // 100 <= Age < 300, the scan returns the Age column only
+    int low = 100, high = 300;
+    vector<ScanPredicateGroup> conditions(2);
+    ScanPredicate predicate;
+    predicate.attribute = "Age";
+    predicate.compOp = GE_OP;
+    predicate.value = &low;
+    conditions[0].push_back(predicate);
+    predicate.compOp = LT_OP;
+    predicate.value = &high;
+    conditions[1].push_back(predicate);
+
+    RBFM_ScanIterator rbfm_ScanIterator;
+    rc = rbfm->filterScan(fileHandle, recordDescriptor, conditions, rbfm_ScanIterator);
+    assert(rc == success && "Filter scanning should not fail.");
+    vector<RID> survivors;
+    vector<int> ages;
+    while (rbfm_ScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+    {
+        int age;
+        assert(((char*) returnedData)[0] == 0 && "The Age column should not be null.");
+        memcpy(&age, (char*) returnedData + 1, sizeof(int));
+        assert(age >= low && age < high && "Only qualifying records should be returned.");
+        survivors.push_back(rid);
+        ages.push_back(age);
+    }
+    rbfm_ScanIterator.close();
+    assert(survivors.size() == (unsigned) (high - low) && "Every qualifying record should be returned.");
+
+    // Ask for them back to front, along with one deleted record
+    reverse(survivors.begin(), survivors.end());
+    reverse(ages.begin(), ages.end());
+    rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rids[5]);
+    assert(rc == success && "Deleting a record should not fail.");
+    survivors.push_back(rids[5]);
+
+    vector<string> attributeNames;
+    attributeNames.push_back("Salary");
+    attributeNames.push_back("EmpName");
+    unsigned fetched = 0;
+    auto check = [&](unsigned i, RC recordRc, const void *data)
+    {
+        assert(i == fetched++ && "Records should come back in the order asked for.");
+        if (i == survivors.size() - 1)
+        {
+            assert(recordRc == RBFM_READ_AFTER_DEL && "A deleted record should not be fetched.");
+            return;
+        }
+        assert(recordRc == success && "Fetching a record should not fail.");
+        int salary, nameLength;
+        memcpy(&salary, (const char*) data + 1, sizeof(int));
+        memcpy(&nameLength, (const char*) data + 1 + sizeof(int), sizeof(int));
+        assert(salary == ages[i] * 10 && "The fetched salary should match.");
+        assert(nameLength == (ages[i] % 7 == 0 ? 400 : 8) && "The fetched name should match.");
+    };
+    rc = rbfm->fetchProjected(fileHandle, recordDescriptor, survivors, attributeNames, check);
+    assert(rc == success && "Fetching the projection should not fail.");
+    assert(fetched == survivors.size() && "Every RID should be answered.");
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(record);
+    free(returnedData);
+    free(nullsIndicator);
+
+    cout << "RBF Test Case 25 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_26(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Read a batch of Records in random order
+    // 2. Compare them with readRecord
+    cout << endl << "***** In RBF Test Case 26 *****" << endl;
+
+    RC rc;
+    string fileName = "test26";
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    int recordSize = 0;
+    void *record = malloc(1000);
+    void *returnedData = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    int numRecords = 2000;
+    vector<RID> rids;
+    RID rid;
+    for (int i = 0; i < numRecords; i++)
+    {
+        // Every fifth record has a null name
+        nullsIndicator[0] = i % 5 == 0 ? 0x80 : 0;
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i, 170.0, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        rids.push_back(rid);
+    }
+    // Forward some of them
+    nullsIndicator[0] = 0;
+    string longName(300, 'r');
+    for (int i = 3; i < numRecords; i += 11)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, longName.size(), longName, i, 170.0, i, record, &recordSize);
+        rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Updating a record should not fail.");
+    }
+
+    // Shuffle the RIDs, ask for some twice, and add one that does not exist
+    vector<RID> batch(rids);
+    srand(26);
+    for (unsigned i = batch.size() - 1; i > 0; i--)
+        swap(batch[i], batch[rand() % (i + 1)]);
+    batch.push_back(rids[42]);
+    RID missing;
+    missing.pageNum = rids.back().pageNum;
+    missing.slotNum = 1000;
+    batch.push_back(missing);
+
+    unsigned answered = 0;
+    auto check = [&](unsigned i, RC recordRc, const void *data)
+    {
+        assert(i == answered++ && "Records should come back in the order asked for.");
+        if (i == batch.size() - 1)
+        {
+            assert(recordRc == RBFM_SLOT_DN_EXIST && "A missing slot should be reported.");
+            return;
+        }
+        assert(recordRc == success && "Reading a record in a batch should not fail.");
+        RC readRc = rbfm->readRecord(fileHandle, recordDescriptor, batch[i], returnedData);
+        assert(readRc == success && "Reading a record should not fail.");
+        int age;
+        unsigned nameSize = 0;
+        if (!(((const char*) data)[0] & 0x80))
+        {
+            int nameLength;
+            memcpy(&nameLength, (const char*) data + 1, sizeof(int));
+            nameSize = sizeof(int) + nameLength;
+        }
+        memcpy(&age, (const char*) data + 1 + nameSize, sizeof(int));
+        assert(memcmp(data, returnedData, 1 + nameSize + 3 * sizeof(int)) == 0 && "The batch should match readRecord.");
+        assert(rids[age].pageNum == batch[i].pageNum && rids[age].slotNum == batch[i].slotNum && "Each RID should get its own record.");
+    };
+    rc = rbfm->readRecords(fileHandle, recordDescriptor, batch.data(), batch.size(), check);
+    assert(rc == success && "Reading a batch of records should not fail.");
+    assert(answered == batch.size() && "Every RID should be answered.");
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(record);
+    free(returnedData);
+    free(nullsIndicator);
+
+    cout << "RBF Test Case 26 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_27(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Read several Attributes of a Record
+    // 2. Read them from a forwarded Record
+    cout << endl << "***** In RBF Test Case 27 *****" << endl;
+
+    RC rc;
+    string fileName = "test27";
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    int recordSize = 0;
+    void *record = malloc(1000);
+    void *returnedData = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    // Fill a page, then grow its first record so it is forwarded
+    vector<RID> rids;
+    RID rid;
+    for (int i = 0; i < 300; i++)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i, 170.5, i * 3, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        rids.push_back(rid);
+    }
+    string longName(500, 'f');
+    nullsIndicator[0] = 0x20; // Height is null
+    prepareRecord(recordDescriptor.size(), nullsIndicator, longName.size(), longName, 0, 170.5, 77, record, &recordSize);
+    rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[0]);
+    assert(rc == success && "Updating a record should not fail.");
+
+    vector<string> attributeNames;
+    attributeNames.push_back("Salary");
+    attributeNames.push_back("Height");
+    attributeNames.push_back("EmpName");
+
+    rc = rbfm->readAttributes(fileHandle, recordDescriptor, rids[10], attributeNames, returnedData);
+    assert(rc == success && "Reading attributes should not fail.");
+    int salary, nameLength;
+    float height;
+    char *data = (char*) returnedData;
+    assert(data[0] == 0 && "No attribute should be null.");
+    memcpy(&salary, data + 1, sizeof(int));
+    memcpy(&height, data + 1 + sizeof(int), sizeof(float));
+    memcpy(&nameLength, data + 1 + sizeof(int) + sizeof(float), sizeof(int));
+    assert(salary == 30 && height == 170.5 && nameLength == 8 && "The attributes should match the record.");
+    assert(memcmp(data + 1 + 3 * sizeof(int), "Anteater", 8) == 0 && "The name should match the record.");
+
+    rc = rbfm->readAttributes(fileHandle, recordDescriptor, rids[0], attributeNames, returnedData);
+    assert(rc == success && "Reading attributes of a forwarded record should not fail.");
+    assert(data[0] == 0x40 && "Only Height should be null.");
+    memcpy(&salary, data + 1, sizeof(int));
+    memcpy(&nameLength, data + 1 + sizeof(int), sizeof(int));
+    assert(salary == 77 && nameLength == 500 && "The attributes should match the updated record.");
+
+    attributeNames.push_back("Weight");
+    rc = rbfm->readAttributes(fileHandle, recordDescriptor, rids[10], attributeNames, returnedData);
+    assert(rc == RBFM_NO_SUCH_ATTR && "An unknown attribute should be reported.");
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(record);
+    free(returnedData);
+    free(nullsIndicator);
+
+    cout << "RBF Test Case 27 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_28(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Update an Attribute in place
+    // 2. Update an Attribute that changes size
+    cout << endl << "***** In RBF Test Case 28 *****" << endl;
+
+    RC rc;
+    string fileName = "test28";
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    int recordSize = 0;
+    void *record = malloc(1000);
+    void *returnedData = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    vector<RID> rids;
+    RID rid;
+    for (int i = 0; i < 200; i++)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i, 170.5, 0, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        rids.push_back(rid);
+    }
+    // Bump a counter in place
+    unsigned readsBefore, writesBefore, appendsBefore, reads, writes, appends;
+    fileHandle.collectCounterValues(readsBefore, writesBefore, appendsBefore);
+    for (int salary = 1; salary <= 100; salary++)
+    {
+        rc = rbfm->updateAttribute(fileHandle, recordDescriptor, rids[7], "Salary", &salary);
+        assert(rc == success && "Updating an attribute should not fail.");
+    }
+    fileHandle.collectCounterValues(reads, writes, appends);
+    assert(reads - readsBefore == 100 && writes - writesBefore == 100 && "Each update should read and write one page.");
+
+    // A varchar of the same length is also overwritten in place
+    char name[sizeof(int) + 8];
+    int nameLength = 8;
+    memcpy(name, &nameLength, sizeof(int));
+    memcpy(name + sizeof(int), "Aardvark", 8);
+    rc = rbfm->updateAttribute(fileHandle, recordDescriptor, rids[7], "EmpName", name);
+    assert(rc == success && "Updating an attribute should not fail.");
+
+    rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[7], returnedData);
+    assert(rc == success && "Reading a record should not fail.");
+    prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Aardvark", 7, 170.5, 100, record, &recordSize);
+    assert(memcmp(record, returnedData, recordSize) == 0 && "The record should hold the new values.");
+
+    // Growing the name, and setting Height to null, rewrite the record
+    string longName(600, 'g');
+    vector<char> longValue(sizeof(int) + longName.size());
+    nameLength = longName.size();
+    memcpy(longValue.data(), &nameLength, sizeof(int));
+    memcpy(longValue.data() + sizeof(int), longName.c_str(), longName.size());
+    rc = rbfm->updateAttribute(fileHandle, recordDescriptor, rids[9], "EmpName", longValue.data());
+    assert(rc == success && "Updating an attribute should not fail.");
+    rc = rbfm->updateAttribute(fileHandle, recordDescriptor, rids[9], "Height", NULL);
+    assert(rc == success && "Setting an attribute to null should not fail.");
+    int salary = 5;
+    rc = rbfm->updateAttribute(fileHandle, recordDescriptor, rids[9], "Salary", &salary);
+    assert(rc == success && "Updating an attribute of a forwarded record should not fail.");
+
+    rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[9], returnedData);
+    assert(rc == success && "Reading a record should not fail.");
+    nullsIndicator[0] = 0x20;
+    prepareRecord(recordDescriptor.size(), nullsIndicator, longName.size(), longName, 9, 170.5, 5, record, &recordSize);
+    assert(memcmp(record, returnedData, recordSize) == 0 && "The record should hold the new values.");
+
+    rc = rbfm->updateAttribute(fileHandle, recordDescriptor, rids[9], "Weight", &salary);
+    assert(rc == RBFM_NO_SUCH_ATTR && "An unknown attribute should be reported.");
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(record);
+    free(returnedData);
+    free(nullsIndicator);
+
+    cout << "RBF Test Case 28 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_29(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Insert Records with a Fill Factor
+    // 2. Grow them without forwarding
+    cout << endl << "***** In RBF Test Case 29 *****" << endl;
+
+    RC rc;
+    string fileName = "test29";
+
+    int recordSize = 0;
+    void *record = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    // Fill the same records into a packed file and one kept 75% full, then grow every record by 8 bytes
+    unsigned forwarded[2];
+    unsigned pages[2];
+    unsigned fillFactors[2] = {DEFAULT_FILL_FACTOR, 75};
+    for (unsigned f = 0; f < 2; f++)
+    {
+        rc = rbfm->createFile(fileName);
+        assert(rc == success && "Creating the file should not fail.");
+
+        FileHandle fileHandle;
+        rc = rbfm->openFile(fileName, fileHandle);
+        assert(rc == success && "Opening the file should not fail.");
+
+        vector<RID> rids;
+        RID rid;
+        for (int i = 0; i < 1000; i++)
+        {
+            prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i, 170.5, i, record, &recordSize);
+            rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid, fillFactors[f]);
+            assert(rc == success && "Inserting a record should not fail.");
+            rids.push_back(rid);
+        }
+        pages[f] = fileHandle.getNumberOfPages();
+
+        unsigned before = rbfm->getForwardedRecordCount();
+        for (int i = 0; i < 1000; i++)
+        {
+            prepareRecord(recordDescriptor.size(), nullsIndicator, 16, "Anteater+Giraffe", i, 170.5, i, record, &recordSize);
+            rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[i]);
+            assert(rc == success && "Updating a record should not fail.");
+        }
+        forwarded[f] = rbfm->getForwardedRecordCount() - before;
+
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid, 0);
+        assert(rc == RBFM_BAD_FILL_FACTOR && "A fill factor of 0 should be rejected.");
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid, 101);
+        assert(rc == RBFM_BAD_FILL_FACTOR && "A fill factor above 100 should be rejected.");
+
+        rc = rbfm->closeFile(fileHandle);
+        assert(rc == success && "Closing the file should not fail.");
+
+        rc = rbfm->destroyFile(fileName);
+        assert(rc == success && "Destroying the file should not fail.");
+    }
+    cout << "Packed: " << pages[0] << " pages, " << forwarded[0] << " forwarded. 75% full: "
+         << pages[1] << " pages, " << forwarded[1] << " forwarded." << endl;
+    assert(forwarded[0] > 0 && forwarded[1] == 0 && "The headroom should absorb the growth.");
+    assert(pages[1] > pages[0] && "Leaving headroom should take more pages.");
+
+    free(record);
+    free(nullsIndicator);
+
+    cout << "RBF Test Case 29 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_30(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Analyze a File
+    // 2. Check the row count, null fractions, bounds, histograms and distinct counts
+    cout << endl << "***** In RBF Test Case 30 *****" << endl;
+
+    RC rc;
+    string fileName = "test30";
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    int recordSize = 0;
+    void *record = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+
+    // Every fourth name is null and there are 50 others, Age has 1000 values and Salary is unique
+    int numRecords = 10000;
+    vector<RID> rids;
+    RID rid;
+    for (int i = 0; i < numRecords; i++)
+    {
+        nullsIndicator[0] = i % 4 == 0 ? 0x80 : 0;
+        string name = "Name" + to_string(i % 50);
+        prepareRecord(recordDescriptor.size(), nullsIndicator, name.size(), name, i % 1000, 170.5, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        rids.push_back(rid);
+    }
+    // Forwarded records should be counted once
+    nullsIndicator[0] = 0;
+    string longName(200, 'z');
+    for (int i = 1; i < numRecords; i += 40)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, longName.size(), longName, i % 1000, 170.5, i, record, &recordSize);
+        rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Updating a record should not fail.");
+    }
+
+    TableStats stats;
+    rc = rbfm->analyzeFile(fileHandle, recordDescriptor, stats);
+    assert(rc == success && "Analyzing the file should not fail.");
+    assert(stats.rowCount == (unsigned) numRecords && stats.columns.size() == 4 && "Every record should be counted once.");
+
+    const ColumnStats &name = stats.columns[0];
+    const ColumnStats &age = stats.columns[1];
+    const ColumnStats &salary = stats.columns[3];
+    assert(name.nullFraction == 0.25 && age.nullFraction == 0 && "The null fractions should be exact.");
+
+    int value;
+    memcpy(&value, age.minValue.data(), sizeof(int));
+    assert(value == 0 && "The smallest age should be 0.");
+    memcpy(&value, age.maxValue.data(), sizeof(int));
+    assert(value == 999 && "The largest age should be 999.");
+    assert(name.maxValue.substr(sizeof(int)) == longName && "The largest name should be the long one.");
+
+    cout << "Distinct estimates: names " << name.distinctCount << ", ages " << age.distinctCount
+         << ", salaries " << salary.distinctCount << endl;
+    assert(name.distinctCount >= 48 && name.distinctCount <= 53 && "The name estimate should be close to 51.");
+    assert(age.distinctCount >= 900 && age.distinctCount <= 1100 && "The age estimate should be within 10%.");
+    assert(salary.distinctCount >= 9000 && salary.distinctCount <= 11000 && "The salary estimate should be within 10%.");
+
+    // Salaries are uniform over [0, 10000), so bucket b should end near b / 16 of the way
+    assert(salary.histogram.size() == STATS_HISTOGRAM_BUCKETS && "Every bucket should have a bound.");
+    for (unsigned b = 1; b <= STATS_HISTOGRAM_BUCKETS; b++)
+    {
+        memcpy(&value, salary.histogram[b - 1].data(), sizeof(int));
+        int expected = numRecords * b / STATS_HISTOGRAM_BUCKETS;
+        assert(abs(value - expected) < numRecords / 20 && "Histogram bounds should split the values evenly.");
+    }
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(record);
+    free(nullsIndicator);
+
+    cout << "RBF Test Case 30 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_31(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Scan a random Sample of the Pages
+    // 2. Analyze a Sample
+    cout << endl << "***** In RBF Test Case 31 *****" << endl;
+
+    RC rc;
+    string fileName = "test31";
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    int recordSize = 0;
+    void *record = malloc(1000);
+    void *returnedData = malloc(1000);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    int numRecords = 20000;
+    RID rid;
+    for (int i = 0; i < numRecords; i++)
+    {
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", i % 1000, 170.5, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    unsigned numPages = fileHandle.getNumberOfPages();
+
+    // Sample a quarter of the pages for ages below 500, twice with one seed and once with another
+    int high = 500;
+    vector<string> attributeNames;
+    attributeNames.push_back("Age");
+    vector<vector<RID>> samples;
+    unsigned seeds[3] = {7, 7, 8};
+    for (unsigned seed : seeds)
+    {
+        RBFM_ScanIterator rbfm_ScanIterator;
+        rc = rbfm->scan(fileHandle, recordDescriptor, "Age", LT_OP, &high, attributeNames, rbfm_ScanIterator);
+        assert(rc == success && "Scanning should not fail.");
+        rc = rbfm_ScanIterator.samplePercent(25, seed);
+        assert(rc == success && "Sampling should not fail.");
+
+        vector<RID> sample;
+        set<PageNum> pages;
+        while (rbfm_ScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+        {
+            int age;
+            memcpy(&age, (char*) returnedData + 1, sizeof(int));
+            assert(age < high && "Sampled records should satisfy the condition.");
+            sample.push_back(rid);
+            pages.insert(rid.pageNum);
+        }
+        rbfm_ScanIterator.close();
+        assert(pages.size() <= (numPages + 2) / 4 && "Only a quarter of the pages should be read.");
+        assert(sample.size() > numRecords / 2 / 4 * 0.8 && sample.size() < numRecords / 2 / 4 * 1.2
+            && "About a quarter of the matching records should be returned.");
+        samples.push_back(sample);
+    }
+    auto sameSample = [](const vector<RID> &first, const vector<RID> &second)
+    {
+        if (first.size() != second.size())
+            return false;
+        for (unsigned i = 0; i < first.size(); i++)
+            if (first[i].pageNum != second[i].pageNum || first[i].slotNum != second[i].slotNum)
+                return false;
+        return true;
+    };
+    assert(sameSample(samples[0], samples[1]) && "The same seed should give the same sample.");
+    assert(!sameSample(samples[0], samples[2]) && "Another seed should give another sample.");
+
+    RBFM_ScanIterator rbfm_ScanIterator;
+    rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributeNames, rbfm_ScanIterator);
+    assert(rc == success && "Scanning should not fail.");
+    rc = rbfm_ScanIterator.samplePercent(150, 1);
+    assert(rc == RBFM_BAD_SAMPLE && "Sampling more than every page should be rejected.");
+    rc = rbfm_ScanIterator.samplePages(0, 1);
+    assert(rc == success && "Sampling should not fail.");
+    assert(rbfm_ScanIterator.getNextRecord(rid, returnedData) == RBFM_EOF && "An empty sample should return nothing.");
+    rbfm_ScanIterator.close();
+
+    // Statistics from a tenth of the pages
+    TableStats stats;
+    rc = rbfm->analyzeFile(fileHandle, recordDescriptor, numPages / 10, 31, stats);
+    assert(rc == success && "Analyzing a sample should not fail.");
+    cout << "Estimated " << stats.rowCount << " rows from " << numPages / 10 << " of " << numPages << " pages" << endl;
+    assert(stats.rowCount > numRecords * 0.9 && stats.rowCount < numRecords * 1.1 && "The row count should be scaled up.");
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(record);
+    free(returnedData);
+    free(nullsIndicator);
+
+    cout << "RBF Test Case 31 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_32(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Parallel Scan projecting Varchars stored out of line
+    cout << endl << "***** In RBF Test Case 32 *****" << endl;
+
+    RC rc;
+    string fileName = "test32";
+
+    rc = rbfm->createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    int recordSize = 0;
+    void *record = malloc(20000);
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    // Values from a few bytes up to several pages long, record i holding a name of length nameLength(i)
+    auto nameLength = [](int i) { return i % 4 == 0 ? 8 : 1000 * (i % 15); };
+    int numRecords = 300;
+    RID rid;
+    for (int i = 0; i < numRecords; i++)
+    {
+        string name;
+        for (int j = 0; j < nameLength(i); j++)
+            name += (char) ('a' + (i + j) % 26);
+        prepareRecord(recordDescriptor.size(), nullsIndicator, name.length(), name, i, 170.0, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    vector<string> attributeNames;
+    attributeNames.push_back("Age");
+    attributeNames.push_back("EmpName");
+    vector<ScanPredicateGroup> conditions;
+
+    // Each worker checks its own records, and counts them in its own slot
+    unsigned numWorkers = 4;
+    vector<int> counts(numWorkers, 0);
+    vector<int> mismatches(numWorkers, 0);
+    auto callback = [&](unsigned worker, const RID &rid, const void *data)
+    {
+        int age, length;
+        memcpy(&age, (char *)data + 1, sizeof(int));
+        memcpy(&length, (char *)data + 1 + sizeof(int), sizeof(int));
+        const char *name = (char *)data + 1 + 2 * sizeof(int);
+        bool same = length == nameLength(age);
+        for (int j = 0; same && j < length; j++)
+            same = name[j] == (char) ('a' + (age + j) % 26);
+        if (!same)
+            mismatches[worker]++;
+        counts[worker]++;
+    };
+    rc = rbfm->parallelScan(fileName, recordDescriptor, conditions, attributeNames, numWorkers, callback);
+    assert(rc == success && "A parallel scan should not fail.");
+
+    int count = 0, mismatched = 0;
+    for (unsigned w = 0; w < numWorkers; w++)
+    {
+        count += counts[w];
+        mismatched += mismatches[w];
+    }
+    assert(count == numRecords && "The parallel scan should return every record once.");
+    assert(mismatched == 0 && "The parallel scan should return large values whole.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(nullsIndicator);
+    free(record);
+
+    cout << "RBF Test Case 32 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int RBFTest_33(RecordBasedFileManager *rbfm)
+{
+    // Functions tested
+    // 1. Insert into a Clustered File in increasing key order
+    // 2. Equality Scan on a key spread over two pages
+    cout << endl << "***** In RBF Test Case 33 *****" << endl;
+
+    RC rc;
+    string fileName = "test33";
+    string heapFileName = "test33heap";
+
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    rc = rbfm->createClusteredFile(fileName, recordDescriptor, "Age");
+    assert(rc == success && "Creating a clustered file should not fail.");
+    rc = rbfm->createFile(heapFileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle, heapFileHandle;
+    rc = rbfm->openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    rc = rbfm->openFile(heapFileName, heapFileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    int recordSize = 0;
+    void *record = malloc(1000);
+    void *returnedData = malloc(1000);
+
+    int nullFieldsIndicatorActualSize = getActualByteForNullsIndicator(recordDescriptor.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullFieldsIndicatorActualSize);
+    memset(nullsIndicator, 0, nullFieldsIndicatorActualSize);
+
+    // Increasing keys, five records each, like the entries of a catalog keyed on table id
+    int numRecords = 6000;
+    int perKey = 5;
+    RID rid;
+    for (int i = 0; i < numRecords; i++)
+    {
+        int age = i / perKey;
+        prepareRecord(recordDescriptor.size(), nullsIndicator, 8, "Anteater", age, 170.0, i, record, &recordSize);
+        rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        rc = rbfm->insertRecord(heapFileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+
+    // New keys start new pages instead of splitting full ones in half, so the pages stay about as full as a heap file's
+    unsigned pages = fileHandle.getNumberOfPages();
+    unsigned heapPages = heapFileHandle.getNumberOfPages();
+    cout << "Clustered file: " << pages << " pages, heap file: " << heapPages << " pages" << endl;
+    assert(pages <= heapPages * 11 / 10 + 2 && "Increasing keys should fill the pages of a clustered file.");
+
+    // Every key is found whole, even one whose records were split over two pages
+    vector<string> attributeNames;
+    attributeNames.push_back("Salary");
+    RBFM_ScanIterator rbfm_ScanIterator;
+    for (int age = 0; age < numRecords / perKey; age++)
+    {
+        rc = rbfm->scan(fileHandle, recordDescriptor, "Age", EQ_OP, &age, attributeNames, rbfm_ScanIterator);
+        assert(rc == success && "Scanning should not fail.");
+        int count = 0;
+        while (rbfm_ScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF)
+        {
+            int salary;
+            memcpy(&salary, (char*) returnedData + 1, sizeof(int));
+            assert(salary / perKey == age && "Only matching records should be returned.");
+            count++;
+        }
+        rbfm_ScanIterator.close();
+        assert(count == perKey && "Every record of the key should be returned.");
+    }
+
+    rc = rbfm->closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm->closeFile(heapFileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm->destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+    rc = rbfm->destroyFile(heapFileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    free(nullsIndicator);
+    free(record);
+    free(returnedData);
+
+    cout << "RBF Test Case 33 Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
 int main()
 {
     // To test the functionality of the paged file manager
@@ -770,6 +3055,30 @@ int main()
     remove("test9");
     remove("test9rids");
     remove("test9sizes");
+    remove("test11");
+    remove("test12");
+    remove("test13");
+    remove("test14");
+    remove("test15");
+    remove("test16");
+    remove("test17");
+    remove("test18");
+    remove("test19");
+    remove("test20");
+    remove("test21");
+    remove("test22");
+    remove("test23");
+    remove("test24");
+    remove("test25");
+    remove("test26");
+    remove("test27");
+    remove("test28");
+    remove("test29");
+    remove("test30");
+    remove("test31");
+    remove("test32");
+    remove("test33");
+    remove("test33heap");
 
     RBFTest_1(pfm);
     RBFTest_2(pfm);
@@ -785,6 +3094,30 @@ int main()
     vector<int> sizes;
     RBFTest_9(rbfm, rids, sizes);
     RBFTest_10(rbfm);
+
+    RBFTest_11(rbfm);
+    RBFTest_12(rbfm);
+    RBFTest_13(rbfm);
+    RBFTest_14(rbfm);
+    RBFTest_15(rbfm);
+    RBFTest_16(rbfm);
+    RBFTest_17(rbfm);
+    RBFTest_18(rbfm);
+    RBFTest_19(rbfm);
+    RBFTest_20(rbfm);
+    RBFTest_21(rbfm);
+    RBFTest_22(rbfm);
+    RBFTest_23(rbfm);
+    RBFTest_24(rbfm);
+    RBFTest_25(rbfm);
+    RBFTest_26(rbfm);
+    RBFTest_27(rbfm);
+    RBFTest_28(rbfm);
+    RBFTest_29(rbfm);
+    RBFTest_30(rbfm);
+    RBFTest_31(rbfm);
+    RBFTest_32(rbfm);
+    RBFTest_33(rbfm);
     
     return 0;
 }
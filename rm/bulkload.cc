@@ -0,0 +1,61 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "rm.h"
+
+using namespace std;
+
+// Loads a CSV or TSV file into an existing table of the catalog in the current directory
+//   bulkload [-t] [-H] [-j workers] <table> <file>
+//   -t          the file is tab separated (default: comma separated)
+//   -H          skip the first line, which holds column names
+//   -j workers  number of parser threads (default: one per core)
+static void usage()
+{
+    cerr << "usage: bulkload [-t] [-H] [-j workers] <table> <file>" << endl;
+}
+
+int main(int argc, char **argv)
+{
+    char delimiter = ',';
+    bool hasHeader = false;
+    unsigned numWorkers = 0;
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i++)
+    {
+        if (strcmp(argv[i], "-t") == 0)
+            delimiter = '\t';
+        else if (strcmp(argv[i], "-H") == 0)
+            hasHeader = true;
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+            numWorkers = atoi(argv[++i]);
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+    if (argc - i != 2)
+    {
+        usage();
+        return 1;
+    }
+    string tableName = argv[i];
+    string dataFileName = argv[i + 1];
+
+    RelationManager *rm = RelationManager::instance();
+    BulkLoadStats stats;
+    RC rc = rm->bulkLoad(tableName, dataFileName, delimiter, hasHeader, numWorkers, stats);
+    if (rc)
+    {
+        cerr << "Loading " << dataFileName << " into " << tableName << " failed (" << rc << ")." << endl;
+        return 1;
+    }
+
+    cout << stats.rows << " rows loaded into " << stats.pages << " pages, "
+         << stats.rejectedRows << " rejected, in " << stats.seconds << " s ("
+         << (unsigned) stats.rowsPerSecond << " rows/s)" << endl;
+    return 0;
+}
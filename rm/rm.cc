@@ -2,6 +2,7 @@
 #include "rm.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 
 RelationManager* RelationManager::_rm = 0;
@@ -15,8 +16,12 @@ RelationManager* RelationManager::instance()
 }
 
 RelationManager::RelationManager()
-: tableDescriptor(createTableDescriptor()), columnDescriptor(createColumnDescriptor())
+: tableDescriptor(createTableDescriptor()), columnDescriptor(createColumnDescriptor()),
+  optionsDescriptor(createOptionsDescriptor()), statisticsDescriptor(createStatisticsDescriptor())
 {
+    cacheStats.hits = 0;
+    cacheStats.misses = 0;
+    nextTableID = tableIDBatchEnd = 0;
 }
 
 RelationManager::~RelationManager()
@@ -26,22 +31,42 @@ RelationManager::~RelationManager()
 RC RelationManager::createCatalog()
 {
     RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
-    // Create both tables and columns tables, return error if either fails
+    // Create both tables and columns tables, return error if either fails.
+    // They are clustered on the column they are looked up by, so finding a table's entries reads the
+    // key directory and the pages holding them rather than the whole file.
     RC rc;
-    rc = rbfm->createFile(getFileName(TABLES_TABLE_NAME));
+    catalogCache.clear();
+    nextTableID = tableIDBatchEnd = 0;
+    rc = rbfm->createClusteredFile(getFileName(TABLES_TABLE_NAME), tableDescriptor, TABLES_COL_TABLE_NAME);
     if (rc)
         return rc;
-    rc = rbfm->createFile(getFileName(COLUMNS_TABLE_NAME));
+    rc = rbfm->createClusteredFile(getFileName(COLUMNS_TABLE_NAME), columnDescriptor, COLUMNS_COL_TABLE_ID);
+    if (rc)
+        return rc;
+    rc = rbfm->createClusteredFile(getFileName(OPTIONS_TABLE_NAME), optionsDescriptor, OPTIONS_COL_TABLE_ID);
+    if (rc)
+        return rc;
+    rc = rbfm->createClusteredFile(getFileName(STATISTICS_TABLE_NAME), statisticsDescriptor, STATISTICS_COL_TABLE_ID);
+    if (rc)
+        return rc;
+    // User tables are numbered after the catalog tables
+    rc = createCatalogHeader(STATISTICS_TABLE_ID + 1);
     if (rc)
         return rc;
 
-    // Add table entries for both Tables and Columns
+    // Add table entries for the catalog tables
     rc = insertTable(TABLES_TABLE_ID, 1, TABLES_TABLE_NAME);
     if (rc)
         return rc;
     rc = insertTable(COLUMNS_TABLE_ID, 1, COLUMNS_TABLE_NAME);
     if (rc)
         return rc;
+    rc = insertTable(OPTIONS_TABLE_ID, 1, OPTIONS_TABLE_NAME);
+    if (rc)
+        return rc;
+    rc = insertTable(STATISTICS_TABLE_ID, 1, STATISTICS_TABLE_NAME);
+    if (rc)
+        return rc;
 
 
     // Add entries for tables and columns to Columns table
@@ -49,18 +74,26 @@ RC RelationManager::createCatalog()
     if (rc)
         return rc;
     rc = insertColumns(COLUMNS_TABLE_ID, columnDescriptor);
+    if (rc)
+        return rc;
+    rc = insertColumns(OPTIONS_TABLE_ID, optionsDescriptor);
+    if (rc)
+        return rc;
+    rc = insertColumns(STATISTICS_TABLE_ID, statisticsDescriptor);
     if (rc)
         return rc;
 
     return SUCCESS;
 }
 
-// Just delete the the two catalog files
+// Just delete the catalog files
 RC RelationManager::deleteCatalog()
 {
     RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
 
     RC rc;
+    catalogCache.clear();
+    nextTableID = tableIDBatchEnd = 0;
 
     rc = rbfm->destroyFile(getFileName(TABLES_TABLE_NAME));
     if (rc)
@@ -70,6 +103,18 @@ RC RelationManager::deleteCatalog()
     if (rc)
         return rc;
 
+    rc = rbfm->destroyFile(getFileName(OPTIONS_TABLE_NAME));
+    if (rc)
+        return rc;
+
+    rc = rbfm->destroyFile(getFileName(STATISTICS_TABLE_NAME));
+    if (rc)
+        return rc;
+
+    // Catalogs created before the header existed have none until their first new table
+    PagedFileManager *pfm = PagedFileManager::instance();
+    pfm->destroyFile(CATALOG_HEADER_FILE_NAME);
+
     return SUCCESS;
 }
 
@@ -82,6 +127,36 @@ RC RelationManager::createTable(const string &tableName, const vector<Attribute>
     if ((rc = rbfm->createFile(getFileName(tableName))))
         return rc;
 
+    return registerTable(tableName, attrs);
+}
+
+RC RelationManager::createClusteredTable(const string &tableName, const vector<Attribute> &attrs, const string &keyAttribute)
+{
+    RC rc;
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+    if ((rc = rbfm->createClusteredFile(getFileName(tableName), attrs, keyAttribute)))
+        return rc;
+
+    return registerTable(tableName, attrs);
+}
+
+RC RelationManager::createAppendOnlyTable(const string &tableName, const vector<Attribute> &attrs)
+{
+    RC rc;
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+    if ((rc = rbfm->createAppendOnlyFile(getFileName(tableName))))
+        return rc;
+
+    return registerTable(tableName, attrs);
+}
+
+RC RelationManager::registerTable(const string &tableName, const vector<Attribute> &attrs)
+{
+    RC rc;
+    invalidateCatalogEntry(tableName);
+
     // Get the table's ID
     int32_t id;
     rc = getNextTableID(id);
@@ -124,6 +199,7 @@ RC RelationManager::deleteTable(const string &tableName)
     rc = getTableID(tableName, id);
     if (rc)
         return rc;
+    invalidateCatalogEntry(tableName);
 
     // Open tables file
     FileHandle fileHandle;
@@ -170,178 +246,315 @@ RC RelationManager::deleteTable(const string &tableName)
     rbfm->closeFile(fileHandle);
     rbfm_si.close();
 
+    // Delete its options and statistics, if it has any
+    rc = deleteCatalogEntries(OPTIONS_TABLE_NAME, optionsDescriptor, OPTIONS_COL_TABLE_ID, id);
+    if (rc)
+        return rc;
+    rc = deleteCatalogEntries(STATISTICS_TABLE_NAME, statisticsDescriptor, STATISTICS_COL_TABLE_ID, id);
+    if (rc)
+        return rc;
+
     return SUCCESS;
 }
 
-// Fills the given attribute vector with the recordDescriptor of tableName
-RC RelationManager::getAttributes(const string &tableName, vector<Attribute> &attrs)
+RC RelationManager::setFillFactor(const string &tableName, unsigned fillFactor)
 {
     RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
-    // Clear out any old values
-    attrs.clear();
     RC rc;
 
-    int32_t id;
-    rc = getTableID(tableName, id);
+    if (fillFactor == 0 || fillFactor > 100)
+        return RBFM_BAD_FILL_FACTOR;
+
+    shared_ptr<CatalogEntry> entry;
+    rc = getCatalogEntry(tableName, entry);
     if (rc)
         return rc;
+    if (entry->system)
+        return RM_CANNOT_MOD_SYS_TBL;
 
-    void *value = &id;
-
-    // We need to get the three values that make up an Attribute: name, type, length
-    // We also need the position of each attribute in the row
-    RBFM_ScanIterator rbfm_si;
-    vector<string> projection;
-    projection.push_back(COLUMNS_COL_COLUMN_NAME);
-    projection.push_back(COLUMNS_COL_COLUMN_TYPE);
-    projection.push_back(COLUMNS_COL_COLUMN_LENGTH);
-    projection.push_back(COLUMNS_COL_COLUMN_POSITION);
-
+    // Clustered and append-only tables do not pick pages by free space, so they cannot keep to it
     FileHandle fileHandle;
-    rc = rbfm->openFile(getFileName(COLUMNS_TABLE_NAME), fileHandle);
+    rc = rbfm->openFile(getFileName(tableName), fileHandle);
+    if (rc)
+        return rc;
+    rc = rbfm->checkFillFactor(fileHandle, fillFactor);
+    rbfm->closeFile(fileHandle);
     if (rc)
         return rc;
 
-    // Scan through the Column table for all entries whose table-id equals tableName's table id.
-    rc = rbfm->scan(fileHandle, columnDescriptor, COLUMNS_COL_TABLE_ID, EQ_OP, value, projection, rbfm_si);
+    rc = loadTableOptions(*entry);
     if (rc)
         return rc;
+    TableOptions options = entry->options;
+    options.fillFactor = fillFactor;
+    return writeTableOptions(*entry, options);
+}
 
-    RID rid;
-    void *data = malloc(COLUMNS_RECORD_DATA_SIZE);
+RC RelationManager::getTableOptions(const string &tableName, TableOptions &options)
+{
+    RC rc;
 
-    // IndexedAttr is an attr with a position. The position will be used to sort the vector
-    vector<IndexedAttr> iattrs;
-    while ((rc = rbfm_si.getNextRecord(rid, data)) == SUCCESS)
-    {
-        // For each entry, create an IndexedAttr, and fill it with the 4 results
-        IndexedAttr attr;
-        unsigned offset = 0;
+    shared_ptr<CatalogEntry> entry;
+    rc = getCatalogEntry(tableName, entry);
+    if (rc)
+        return rc;
 
-        // For the Columns table, there should never be a null column
-        char null;
-        memcpy(&null, data, 1);
-        if (null)
-            rc = RM_NULL_COLUMN;
+    rc = loadTableOptions(*entry);
+    if (rc)
+        return rc;
+    options = entry->options;
+    return SUCCESS;
+}
 
-        // Read in name
-        offset = 1;
-        int32_t nameLen;
-        memcpy(&nameLen, (char*) data + offset, VARCHAR_LENGTH_SIZE);
-        offset += VARCHAR_LENGTH_SIZE;
-        char name[nameLen + 1];
-        name[nameLen] = '\0';
-        memcpy(name, (char*) data + offset, nameLen);
-        offset += nameLen;
-        attr.attr.name = string(name);
+RC RelationManager::analyzeTable(const string &tableName)
+{
+    return analyzeTable(tableName, 100);
+}
 
-        // read in type
-        int32_t type;
-        memcpy(&type, (char*) data + offset, INT_SIZE);
-        offset += INT_SIZE;
-        attr.attr.type = (AttrType)type;
+RC RelationManager::analyzeTable(const string &tableName, float samplePercent)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    RC rc;
 
-        // Read in length
-        int32_t length;
-        memcpy(&length, (char*) data + offset, INT_SIZE);
-        offset += INT_SIZE;
-        attr.attr.length = length;
+    // An empty sample would replace the statistics with nothing
+    if (!(samplePercent > 0 && samplePercent <= 100))
+        return RBFM_BAD_SAMPLE;
 
-        // Read in position
-        int32_t pos;
-        memcpy(&pos, (char*) data + offset, INT_SIZE);
-        offset += INT_SIZE;
-        attr.pos = pos;
+    int32_t id;
+    rc = getTableID(tableName, id);
+    if (rc)
+        return rc;
 
-        iattrs.push_back(attr);
-    }
-    // Do cleanup
-    rbfm_si.close();
+    vector<Attribute> recordDescriptor;
+    rc = getAttributes(tableName, recordDescriptor);
+    if (rc)
+        return rc;
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(getFileName(tableName), fileHandle);
+    if (rc)
+        return rc;
+    TableStats stats;
+    unsigned sampledPages = max(1L, lround(fileHandle.getNumberOfPages() * samplePercent / 100));
+    rc = rbfm->analyzeFile(fileHandle, recordDescriptor, sampledPages, id, stats);
     rbfm->closeFile(fileHandle);
-    free(data);
-    // If we ended on an error, return that error
-    if (rc != RBFM_EOF)
+    if (rc)
         return rc;
 
-    // Sort attributes by position ascending
-    auto comp = [](IndexedAttr first, IndexedAttr second) 
-        {return first.pos < second.pos;};
-    sort(iattrs.begin(), iattrs.end(), comp);
+    // Replace the old statistics
+    rc = deleteCatalogEntries(STATISTICS_TABLE_NAME, statisticsDescriptor, STATISTICS_COL_TABLE_ID, id);
+    if (rc)
+        return rc;
+    rc = rbfm->openFile(getFileName(STATISTICS_TABLE_NAME), fileHandle);
+    if (rc)
+        return rc;
 
-    // Fill up our result with the Attributes in sorted order
-    for (auto attr : iattrs)
+    // Long varchars are only kept up to STATISTICS_VALUE_PREFIX characters
+    auto prefix = [](AttrType type, const string &value)
     {
-        attrs.push_back(attr.attr);
-    }
+        if (type != TypeVarChar || value.size() <= STATISTICS_COL_VALUE_SIZE)
+            return value;
+        string cut = value.substr(0, STATISTICS_COL_VALUE_SIZE);
+        uint32_t length = STATISTICS_VALUE_PREFIX;
+        memcpy(&cut[0], &length, VARCHAR_LENGTH_SIZE);
+        return cut;
+    };
+    auto appendVarchar = [](vector<char> &data, const string &value)
+    {
+        uint32_t length = value.size();
+        data.insert(data.end(), (const char*) &length, (const char*) &length + VARCHAR_LENGTH_SIZE);
+        data.insert(data.end(), value.begin(), value.end());
+    };
 
-    return SUCCESS;
+    RID rid;
+    for (unsigned i = 0; i < recordDescriptor.size() && rc == SUCCESS; i++)
+    {
+        const ColumnStats &column = stats.columns[i];
+        AttrType type = recordDescriptor[i].type;
+
+        // Only the bounds of a column holding nothing but nulls are null. The 9 fields take 2 null bytes.
+        vector<char> data(2, 0);
+        data[0] = column.minValue.empty() ? 0x06 : 0;
+        int32_t fields[3] = {id, (int32_t) i + 1, (int32_t) stats.rowCount};
+        data.insert(data.end(), (const char*) fields, (const char*) fields + sizeof(fields));
+        data.insert(data.end(), (const char*) &column.nullFraction, (const char*) &column.nullFraction + REAL_SIZE);
+        int32_t distinctCount = column.distinctCount;
+        data.insert(data.end(), (const char*) &distinctCount, (const char*) &distinctCount + INT_SIZE);
+        if (!column.minValue.empty())
+        {
+            appendVarchar(data, prefix(type, column.minValue));
+            appendVarchar(data, prefix(type, column.maxValue));
+        }
+        string histogram;
+        for (const string &bound : column.histogram)
+        {
+            string value = prefix(type, bound);
+            uint32_t size = value.size();
+            histogram.append((const char*) &size, sizeof(size));
+            histogram.append(value);
+        }
+        appendVarchar(data, histogram);
+        int32_t sampled = stats.sampled;
+        data.insert(data.end(), (const char*) &sampled, (const char*) &sampled + INT_SIZE);
+
+        rc = rbfm->insertRecord(fileHandle, statisticsDescriptor, data.data(), rid);
+    }
+    rbfm->closeFile(fileHandle);
+    return rc;
 }
 
-RC RelationManager::insertTuple(const string &tableName, const void *data, RID &rid)
+RC RelationManager::getTableStats(const string &tableName, TableStats &stats)
 {
     RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
     RC rc;
 
-    // If this is a system table, we cannot modify it
-    bool isSystem;
-    rc = isSystemTable(isSystem, tableName);
+    int32_t id;
+    rc = getTableID(tableName, id);
     if (rc)
         return rc;
-    if (isSystem)
-        return RM_CANNOT_MOD_SYS_TBL;
 
-    // Get recordDescriptor
-    vector<Attribute> recordDescriptor;
-    rc = getAttributes(tableName, recordDescriptor);
+    FileHandle fileHandle;
+    rc = rbfm->openFile(getFileName(STATISTICS_TABLE_NAME), fileHandle);
     if (rc)
         return rc;
 
-    // And get fileHandle
-    FileHandle fileHandle;
-    rc = rbfm->openFile(getFileName(tableName), fileHandle);
+    vector<string> projection;
+    projection.push_back(STATISTICS_COL_POSITION);
+    projection.push_back(STATISTICS_COL_ROW_COUNT);
+    projection.push_back(STATISTICS_COL_NULL_FRACTION);
+    projection.push_back(STATISTICS_COL_DISTINCT_COUNT);
+    projection.push_back(STATISTICS_COL_MIN_VALUE);
+    projection.push_back(STATISTICS_COL_MAX_VALUE);
+    projection.push_back(STATISTICS_COL_HISTOGRAM);
+    projection.push_back(STATISTICS_COL_SAMPLED);
+
+    RBFM_ScanIterator rbfm_si;
+    rc = rbfm->scan(fileHandle, statisticsDescriptor, STATISTICS_COL_TABLE_ID, EQ_OP, &id, projection, rbfm_si);
     if (rc)
+    {
+        rbfm->closeFile(fileHandle);
         return rc;
+    }
 
-    // Let rbfm do all the work
-    rc = rbfm->insertRecord(fileHandle, recordDescriptor, data, rid);
-    rbfm->closeFile(fileHandle);
+    stats.rowCount = 0;
+    stats.columns.clear();
+    stats.sampled = false;
+    RID rid;
+    char *data = (char*) malloc(STATISTICS_RECORD_DATA_SIZE);
+    while ((rc = rbfm_si.getNextRecord(rid, data)) == SUCCESS)
+    {
+        // The projection has 8 fields, so the null indicator is one byte
+        char null = data[0];
+        unsigned offset = 1;
+        int32_t position, rowCount, distinctCount;
+        ColumnStats column;
+        memcpy(&position, data + offset, INT_SIZE);
+        offset += INT_SIZE;
+        memcpy(&rowCount, data + offset, INT_SIZE);
+        offset += INT_SIZE;
+        memcpy(&column.nullFraction, data + offset, REAL_SIZE);
+        offset += REAL_SIZE;
+        memcpy(&distinctCount, data + offset, INT_SIZE);
+        offset += INT_SIZE;
+        column.distinctCount = distinctCount;
+
+        auto readVarchar = [&](string &value)
+        {
+            uint32_t length;
+            memcpy(&length, data + offset, VARCHAR_LENGTH_SIZE);
+            offset += VARCHAR_LENGTH_SIZE;
+            value.assign(data + offset, length);
+            offset += length;
+        };
+        // min-value and max-value are the 5th and 6th fields of the projection
+        if (!(null & 0x08))
+            readVarchar(column.minValue);
+        if (!(null & 0x04))
+            readVarchar(column.maxValue);
+        string histogram;
+        readVarchar(histogram);
+        for (size_t pos = 0; pos + sizeof(uint32_t) <= histogram.size(); )
+        {
+            uint32_t size;
+            memcpy(&size, histogram.data() + pos, sizeof(size));
+            pos += sizeof(size);
+            column.histogram.push_back(histogram.substr(pos, size));
+            pos += size;
+        }
+        int32_t sampled;
+        memcpy(&sampled, data + offset, INT_SIZE);
+        offset += INT_SIZE;
+        stats.sampled = sampled;
 
-    return rc;
+        stats.rowCount = rowCount;
+        if ((unsigned) position > stats.columns.size())
+            stats.columns.resize(position);
+        stats.columns[position - 1] = column;
+    }
+    free(data);
+    rbfm_si.close();
+    rbfm->closeFile(fileHandle);
+    if (rc != RBFM_EOF)
+        return rc;
+    return stats.columns.empty() ? RM_NO_STATISTICS : SUCCESS;
 }
 
-RC RelationManager::deleteTuple(const string &tableName, const RID &rid)
+// Fills the given attribute vector with the recordDescriptor of tableName
+RC RelationManager::getAttributes(const string &tableName, vector<Attribute> &attrs)
 {
-    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
     RC rc;
 
-    // If this is a system table, we cannot modify it
-    bool isSystem;
-    rc = isSystemTable(isSystem, tableName);
+    shared_ptr<CatalogEntry> entry;
+    rc = getCatalogEntry(tableName, entry);
     if (rc)
         return rc;
-    if (isSystem)
-        return RM_CANNOT_MOD_SYS_TBL;
 
-    // Get recordDescriptor
-    vector<Attribute> recordDescriptor;
-    rc = getAttributes(tableName, recordDescriptor);
+    attrs = entry->attrs;
+    return SUCCESS;
+}
+
+CatalogCacheStats RelationManager::getCatalogCacheStats()
+{
+    return cacheStats;
+}
+
+RC RelationManager::insertTuple(const string &tableName, const void *data, RID &rid)
+{
+    TableHandle tableHandle;
+    RC rc = openTable(tableName, tableHandle);
     if (rc)
         return rc;
 
-    // And get fileHandle
-    FileHandle fileHandle;
-    rc = rbfm->openFile(getFileName(tableName), fileHandle);
+    rc = insertTuple(tableHandle, data, rid);
+    closeTable(tableHandle);
+    return rc;
+}
+
+RC RelationManager::deleteTuple(const string &tableName, const RID &rid)
+{
+    TableHandle tableHandle;
+    RC rc = openTable(tableName, tableHandle);
     if (rc)
         return rc;
 
-    // Let rbfm do all the work
-    rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rid);
-    rbfm->closeFile(fileHandle);
-
+    rc = deleteTuple(tableHandle, rid);
+    closeTable(tableHandle);
     return rc;
 }
 
 RC RelationManager::updateTuple(const string &tableName, const void *data, const RID &rid)
+{
+    TableHandle tableHandle;
+    RC rc = openTable(tableName, tableHandle);
+    if (rc)
+        return rc;
+
+    rc = updateTuple(tableHandle, data, rid);
+    closeTable(tableHandle);
+    return rc;
+}
+
+RC RelationManager::updateAttribute(const string &tableName, const RID &rid, const string &attributeName, const void *value)
 {
     RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
     RC rc;
@@ -354,47 +567,171 @@ RC RelationManager::updateTuple(const string &tableName, const void *data, const
     if (isSystem)
         return RM_CANNOT_MOD_SYS_TBL;
 
-    // Get recordDescriptor
     vector<Attribute> recordDescriptor;
     rc = getAttributes(tableName, recordDescriptor);
     if (rc)
         return rc;
 
-    // And get fileHandle
     FileHandle fileHandle;
     rc = rbfm->openFile(getFileName(tableName), fileHandle);
     if (rc)
         return rc;
 
-    // Let rbfm do all the work
-    rc = rbfm->updateRecord(fileHandle, recordDescriptor, data, rid);
+    unsigned forwarded = rbfm->getForwardedRecordCount();
+    rc = rbfm->updateAttribute(fileHandle, recordDescriptor, rid, attributeName, value);
     rbfm->closeFile(fileHandle);
 
+    forwarded = rbfm->getForwardedRecordCount() - forwarded;
+    if (rc == SUCCESS && forwarded)
+    {
+        shared_ptr<CatalogEntry> entry;
+        rc = getCatalogEntry(tableName, entry);
+        if (rc == SUCCESS)
+            rc = countForwardedTuples(*entry, forwarded);
+    }
     return rc;
 }
 
 RC RelationManager::readTuple(const string &tableName, const RID &rid, void *data)
+{
+    TableHandle tableHandle;
+    RC rc = openTable(tableName, tableHandle);
+    if (rc)
+        return rc;
+
+    rc = readTuple(tableHandle, rid, data);
+    closeTable(tableHandle);
+    return rc;
+}
+
+RC RelationManager::openTable(const string &tableName, TableHandle &tableHandle)
 {
     RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
     RC rc;
 
-    // Get record descriptor
-    vector<Attribute> recordDescriptor;
-    rc = getAttributes(tableName, recordDescriptor);
+    if (tableHandle.open)
+        return PFM_HANDLE_IN_USE;
+
+    shared_ptr<CatalogEntry> entry;
+    rc = getCatalogEntry(tableName, entry);
     if (rc)
         return rc;
 
-    // And get fileHandle
-    FileHandle fileHandle;
-    rc = rbfm->openFile(getFileName(tableName), fileHandle);
+    // The fill factor is needed for inserts and the forwarded count for updates
+    rc = loadTableOptions(*entry);
     if (rc)
         return rc;
 
-    // Let rbfm do all the work
-    rc = rbfm->readRecord(fileHandle, recordDescriptor, rid, data);
-    rbfm->closeFile(fileHandle);
-    return rc;
-}
+    rc = rbfm->openFile(getFileName(tableName), tableHandle.fileHandle);
+    if (rc)
+        return rc;
+
+    tableHandle.tableName = tableName;
+    tableHandle.id = entry->id;
+    tableHandle.system = entry->system;
+    tableHandle.attrs = entry->attrs;
+    tableHandle.entry = entry;
+    tableHandle.open = true;
+    return SUCCESS;
+}
+
+RC RelationManager::closeTable(TableHandle &tableHandle)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+    if (!tableHandle.open)
+        return RM_TABLE_NOT_OPEN;
+
+    tableHandle.open = false;
+    tableHandle.entry.reset();
+    return rbfm->closeFile(tableHandle.fileHandle);
+}
+
+RC RelationManager::insertTuple(TableHandle &tableHandle, const void *data, RID &rid)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+    if (!tableHandle.open)
+        return RM_TABLE_NOT_OPEN;
+
+    // If this is a system table, we cannot modify it
+    if (tableHandle.system)
+        return RM_CANNOT_MOD_SYS_TBL;
+
+    // Pages are only filled as far as the table's fill factor allows. The options are shared with the
+    // catalog cache, so a fill factor set while the table is open is seen here.
+    return rbfm->insertRecord(tableHandle.fileHandle, tableHandle.attrs, data, rid, tableHandle.entry->options.fillFactor);
+}
+
+RC RelationManager::deleteTuple(TableHandle &tableHandle, const RID &rid)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+    if (!tableHandle.open)
+        return RM_TABLE_NOT_OPEN;
+
+    // If this is a system table, we cannot modify it
+    if (tableHandle.system)
+        return RM_CANNOT_MOD_SYS_TBL;
+
+    // Let rbfm do all the work
+    return rbfm->deleteRecord(tableHandle.fileHandle, tableHandle.attrs, rid);
+}
+
+RC RelationManager::updateTuple(TableHandle &tableHandle, const void *data, const RID &rid)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    RC rc;
+
+    if (!tableHandle.open)
+        return RM_TABLE_NOT_OPEN;
+
+    // If this is a system table, we cannot modify it
+    if (tableHandle.system)
+        return RM_CANNOT_MOD_SYS_TBL;
+
+    // Let rbfm do all the work
+    unsigned forwarded = rbfm->getForwardedRecordCount();
+    rc = rbfm->updateRecord(tableHandle.fileHandle, tableHandle.attrs, data, rid);
+
+    // Keep count of the tuples that outgrew their page
+    forwarded = rbfm->getForwardedRecordCount() - forwarded;
+    if (rc == SUCCESS && forwarded)
+        rc = countForwardedTuples(*tableHandle.entry, forwarded);
+
+    return rc;
+}
+
+RC RelationManager::readTuple(TableHandle &tableHandle, const RID &rid, void *data)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+    if (!tableHandle.open)
+        return RM_TABLE_NOT_OPEN;
+
+    // Let rbfm do all the work
+    return rbfm->readRecord(tableHandle.fileHandle, tableHandle.attrs, rid, data);
+}
+
+RC RelationManager::readTuples(const string &tableName, const RID *rids, unsigned n, const RecordBatchCallback &callback)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    RC rc;
+
+    vector<Attribute> recordDescriptor;
+    rc = getAttributes(tableName, recordDescriptor);
+    if (rc)
+        return rc;
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(getFileName(tableName), fileHandle);
+    if (rc)
+        return rc;
+
+    rc = rbfm->readRecords(fileHandle, recordDescriptor, rids, n, callback);
+    rbfm->closeFile(fileHandle);
+    return rc;
+}
 
 // Let rbfm do all the work
 RC RelationManager::printTuple(const vector<Attribute> &attrs, const void *data)
@@ -423,6 +760,162 @@ RC RelationManager::readAttribute(const string &tableName, const RID &rid, const
     return rc;
 }
 
+RC RelationManager::readAttributes(const string &tableName, const RID &rid, const vector<string> &attributeNames, void *data)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    RC rc;
+
+    vector<Attribute> recordDescriptor;
+    rc = getAttributes(tableName, recordDescriptor);
+    if (rc)
+        return rc;
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(getFileName(tableName), fileHandle);
+    if (rc)
+        return rc;
+
+    rc = rbfm->readAttributes(fileHandle, recordDescriptor, rid, attributeNames, data);
+    rbfm->closeFile(fileHandle);
+    return rc;
+}
+
+RC RelationManager::bulkLoad(const string &tableName, const string &dataFileName, char delimiter, bool hasHeader,
+      unsigned numWorkers, BulkLoadStats &stats)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    RC rc;
+
+    // If this is a system table, we cannot modify it
+    bool isSystem;
+    rc = isSystemTable(isSystem, tableName);
+    if (rc)
+        return rc;
+    if (isSystem)
+        return RM_CANNOT_MOD_SYS_TBL;
+
+    vector<Attribute> recordDescriptor;
+    rc = getAttributes(tableName, recordDescriptor);
+    if (rc)
+        return rc;
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(getFileName(tableName), fileHandle);
+    if (rc)
+        return rc;
+
+    rc = rbfm->bulkLoad(fileHandle, recordDescriptor, dataFileName, delimiter, hasHeader, numWorkers, stats);
+    rbfm->closeFile(fileHandle);
+    return rc;
+}
+
+RC RelationManager::deleteWhere(const string &tableName, const vector<ScanPredicateGroup> &conditions, unsigned &deleted)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    RC rc;
+
+    // If this is a system table, we cannot modify it
+    bool isSystem;
+    rc = isSystemTable(isSystem, tableName);
+    if (rc)
+        return rc;
+    if (isSystem)
+        return RM_CANNOT_MOD_SYS_TBL;
+
+    vector<Attribute> recordDescriptor;
+    rc = getAttributes(tableName, recordDescriptor);
+    if (rc)
+        return rc;
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(getFileName(tableName), fileHandle);
+    if (rc)
+        return rc;
+
+    rc = rbfm->deleteWhere(fileHandle, recordDescriptor, conditions, deleted);
+    rbfm->closeFile(fileHandle);
+    return rc;
+}
+
+RC RelationManager::discardPages(const string &tableName, PageNum firstPage, PageNum endPage, unsigned &deleted)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    RC rc;
+
+    // If this is a system table, we cannot modify it
+    bool isSystem;
+    rc = isSystemTable(isSystem, tableName);
+    if (rc)
+        return rc;
+    if (isSystem)
+        return RM_CANNOT_MOD_SYS_TBL;
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(getFileName(tableName), fileHandle);
+    if (rc)
+        return rc;
+
+    rc = rbfm->discardPages(fileHandle, firstPage, endPage, deleted);
+    rbfm->closeFile(fileHandle);
+    return rc;
+}
+
+RC RelationManager::vacuumForwardedTuples(const string &tableName, unsigned &hopsRemoved)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    RC rc;
+
+    // Vacuuming rewrites pages, so system tables are off limits like any other modification
+    bool isSystem;
+    rc = isSystemTable(isSystem, tableName);
+    if (rc)
+        return rc;
+    if (isSystem)
+        return RM_CANNOT_MOD_SYS_TBL;
+
+    vector<Attribute> recordDescriptor;
+    rc = getAttributes(tableName, recordDescriptor);
+    if (rc)
+        return rc;
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(getFileName(tableName), fileHandle);
+    if (rc)
+        return rc;
+
+    rc = rbfm->vacuumForwardedRecords(fileHandle, recordDescriptor, hopsRemoved);
+    rbfm->closeFile(fileHandle);
+    return rc;
+}
+
+RC RelationManager::vacuumTable(const string &tableName, bool relocate, vector<RIDRemap> &remapped, VacuumStats &stats)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    RC rc;
+
+    // Relocating records changes RIDs, which the catalog code relies on staying put
+    bool isSystem;
+    rc = isSystemTable(isSystem, tableName);
+    if (rc)
+        return rc;
+    if (isSystem)
+        return RM_CANNOT_MOD_SYS_TBL;
+
+    vector<Attribute> recordDescriptor;
+    rc = getAttributes(tableName, recordDescriptor);
+    if (rc)
+        return rc;
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(getFileName(tableName), fileHandle);
+    if (rc)
+        return rc;
+
+    rc = rbfm->vacuumFile(fileHandle, recordDescriptor, relocate, remapped, stats);
+    rbfm->closeFile(fileHandle);
+    return rc;
+}
+
 string RelationManager::getFileName(const char *tableName)
 {
     return string(tableName) + string(TABLE_FILE_EXTENSION);
@@ -494,6 +987,82 @@ vector<Attribute> RelationManager::createColumnDescriptor()
     return cd;
 }
 
+vector<Attribute> RelationManager::createOptionsDescriptor()
+{
+    vector<Attribute> od;
+
+    Attribute attr;
+    attr.name = OPTIONS_COL_TABLE_ID;
+    attr.type = TypeInt;
+    attr.length = (AttrLength)INT_SIZE;
+    od.push_back(attr);
+
+    attr.name = OPTIONS_COL_FILL_FACTOR;
+    attr.type = TypeInt;
+    attr.length = (AttrLength)INT_SIZE;
+    od.push_back(attr);
+
+    attr.name = OPTIONS_COL_FORWARDED_TUPLES;
+    attr.type = TypeInt;
+    attr.length = (AttrLength)INT_SIZE;
+    od.push_back(attr);
+
+    return od;
+}
+
+vector<Attribute> RelationManager::createStatisticsDescriptor()
+{
+    vector<Attribute> sd;
+
+    Attribute attr;
+    attr.name = STATISTICS_COL_TABLE_ID;
+    attr.type = TypeInt;
+    attr.length = (AttrLength)INT_SIZE;
+    sd.push_back(attr);
+
+    attr.name = STATISTICS_COL_POSITION;
+    attr.type = TypeInt;
+    attr.length = (AttrLength)INT_SIZE;
+    sd.push_back(attr);
+
+    attr.name = STATISTICS_COL_ROW_COUNT;
+    attr.type = TypeInt;
+    attr.length = (AttrLength)INT_SIZE;
+    sd.push_back(attr);
+
+    attr.name = STATISTICS_COL_NULL_FRACTION;
+    attr.type = TypeReal;
+    attr.length = (AttrLength)REAL_SIZE;
+    sd.push_back(attr);
+
+    attr.name = STATISTICS_COL_DISTINCT_COUNT;
+    attr.type = TypeInt;
+    attr.length = (AttrLength)INT_SIZE;
+    sd.push_back(attr);
+
+    attr.name = STATISTICS_COL_MIN_VALUE;
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength)STATISTICS_COL_VALUE_SIZE;
+    sd.push_back(attr);
+
+    attr.name = STATISTICS_COL_MAX_VALUE;
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength)STATISTICS_COL_VALUE_SIZE;
+    sd.push_back(attr);
+
+    attr.name = STATISTICS_COL_HISTOGRAM;
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength)STATISTICS_COL_HISTOGRAM_SIZE;
+    sd.push_back(attr);
+
+    attr.name = STATISTICS_COL_SAMPLED;
+    attr.type = TypeInt;
+    attr.length = (AttrLength)INT_SIZE;
+    sd.push_back(attr);
+
+    return sd;
+}
+
 // Creates the Tables table entry for the given id and tableName
 // Assumes fileName is just tableName + file extension
 void RelationManager::prepareTablesRecordData(int32_t id, bool system, const string &tableName, void *data)
@@ -613,15 +1182,99 @@ RC RelationManager::insertTable(int32_t id, int32_t system, const string &tableN
 // Get the next table ID for creating a table
 RC RelationManager::getNextTableID(int32_t &table_id)
 {
-    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
-    FileHandle fileHandle;
     RC rc;
 
-    rc = rbfm->openFile(getFileName(TABLES_TABLE_NAME), fileHandle);
-    if (rc)
-        return rc;
-
-    // Grab only the table ID
+    if (nextTableID == tableIDBatchEnd)
+    {
+        rc = reserveTableIDs();
+        if (rc)
+            return rc;
+    }
+    table_id = nextTableID++;
+    return SUCCESS;
+}
+
+RC RelationManager::reserveTableIDs()
+{
+    PagedFileManager *pfm = PagedFileManager::instance();
+    FileHandle fileHandle;
+    RC rc;
+
+    // A catalog created without a header gets one, continuing after its largest table ID
+    rc = pfm->openFile(CATALOG_HEADER_FILE_NAME, fileHandle);
+    if (rc == PFM_FILE_DN_EXIST)
+    {
+        int32_t maxID;
+        rc = findMaxTableID(maxID);
+        if (rc)
+            return rc;
+        rc = createCatalogHeader(maxID + 1);
+        if (rc)
+            return rc;
+        rc = pfm->openFile(CATALOG_HEADER_FILE_NAME, fileHandle);
+    }
+    if (rc)
+        return rc;
+
+    void *pageData = malloc(PAGE_SIZE);
+    CatalogHeader header;
+    rc = fileHandle.readPage(0, pageData);
+    if (rc == SUCCESS)
+    {
+        memcpy(&header, pageData, sizeof(CatalogHeader));
+        nextTableID = header.nextTableID;
+        tableIDBatchEnd = nextTableID + TABLE_ID_BATCH;
+
+        header.nextTableID = tableIDBatchEnd;
+        memcpy(pageData, &header, sizeof(CatalogHeader));
+        rc = fileHandle.writePage(0, pageData);
+        // Without the write the batch could be handed out again
+        if (rc)
+            nextTableID = tableIDBatchEnd = 0;
+    }
+
+    free(pageData);
+    pfm->closeFile(fileHandle);
+    return rc;
+}
+
+RC RelationManager::createCatalogHeader(int32_t nextID)
+{
+    PagedFileManager *pfm = PagedFileManager::instance();
+    FileHandle fileHandle;
+    RC rc;
+
+    // A header left behind by a catalog deleted without deleteCatalog belongs to no catalog, start it over
+    pfm->destroyFile(CATALOG_HEADER_FILE_NAME);
+    rc = pfm->createFile(CATALOG_HEADER_FILE_NAME);
+    if (rc)
+        return rc;
+    rc = pfm->openFile(CATALOG_HEADER_FILE_NAME, fileHandle);
+    if (rc)
+        return rc;
+
+    void *pageData = calloc(PAGE_SIZE, 1);
+    CatalogHeader header;
+    header.nextTableID = nextID;
+    memcpy(pageData, &header, sizeof(CatalogHeader));
+    rc = fileHandle.appendPage(pageData);
+
+    free(pageData);
+    pfm->closeFile(fileHandle);
+    return rc;
+}
+
+RC RelationManager::findMaxTableID(int32_t &maxID)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    FileHandle fileHandle;
+    RC rc;
+
+    rc = rbfm->openFile(getFileName(TABLES_TABLE_NAME), fileHandle);
+    if (rc)
+        return rc;
+
+    // Grab only the table ID
     vector<string> projection;
     projection.push_back(TABLES_COL_TABLE_ID);
 
@@ -645,15 +1298,73 @@ RC RelationManager::getNextTableID(int32_t &table_id)
         rc = SUCCESS;
 
     free(data);
-    // Next table ID is 1 more than largest table id
-    table_id = max_table_id + 1;
+    maxID = max_table_id;
     rbfm->closeFile(fileHandle);
     rbfm_si.close();
-    return SUCCESS;
+    return rc;
 }
 
 // Gets the table ID of the given tableName
 RC RelationManager::getTableID(const string &tableName, int32_t &tableID)
+{
+    RC rc;
+
+    shared_ptr<CatalogEntry> entry;
+    rc = getCatalogEntry(tableName, entry);
+    if (rc)
+        return rc;
+
+    tableID = entry->id;
+    return SUCCESS;
+}
+
+// Determine if table tableName is a system table. Set the boolean argument as the result
+RC RelationManager::isSystemTable(bool &system, const string &tableName)
+{
+    RC rc;
+
+    // A table that does not exist is not a system table
+    shared_ptr<CatalogEntry> entry;
+    rc = getCatalogEntry(tableName, entry);
+    system = rc == SUCCESS && entry->system;
+    if (rc == RBFM_EOF)
+        rc = SUCCESS;
+    return rc;
+}
+
+RC RelationManager::getCatalogEntry(const string &tableName, shared_ptr<CatalogEntry> &entry)
+{
+    RC rc;
+
+    auto cached = catalogCache.find(tableName);
+    if (cached != catalogCache.end())
+    {
+        cacheStats.hits++;
+        entry = cached->second;
+        return SUCCESS;
+    }
+    cacheStats.misses++;
+
+    shared_ptr<CatalogEntry> newEntry = make_shared<CatalogEntry>();
+    rc = readTableEntry(tableName, newEntry->id, newEntry->system);
+    if (rc)
+        return rc;
+    rc = readColumns(newEntry->id, newEntry->attrs);
+    if (rc)
+        return rc;
+    newEntry->hasOptions = false;
+    newEntry->hasOptionsEntry = false;
+
+    entry = catalogCache[tableName] = newEntry;
+    return SUCCESS;
+}
+
+void RelationManager::invalidateCatalogEntry(const string &tableName)
+{
+    catalogCache.erase(tableName);
+}
+
+RC RelationManager::readTableEntry(const string &tableName, int32_t &tableID, bool &system)
 {
     RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
     FileHandle fileHandle;
@@ -663,9 +1374,10 @@ RC RelationManager::getTableID(const string &tableName, int32_t &tableID)
     if (rc)
         return rc;
 
-    // We only care about the table ID
+    // We only care about the table ID and system columns
     vector<string> projection;
     projection.push_back(TABLES_COL_TABLE_ID);
+    projection.push_back(TABLES_COL_SYSTEM);
 
     // Fill value with the string tablename in api format (without null indicator)
     void *value = malloc(4 + TABLES_COL_TABLE_NAME_SIZE);
@@ -679,12 +1391,14 @@ RC RelationManager::getTableID(const string &tableName, int32_t &tableID)
 
     // There will only be one such entry, so we use if rather than while
     RID rid;
-    void *data = malloc (1 + INT_SIZE);
+    void *data = malloc (1 + 2 * INT_SIZE);
     if ((rc = rbfm_si.getNextRecord(rid, data)) == SUCCESS)
     {
-        int32_t tid;
-        fromAPI(tid, data);
+        int32_t tid, tmp;
+        memcpy(&tid, (char*) data + 1, INT_SIZE);
+        memcpy(&tmp, (char*) data + 1 + INT_SIZE, INT_SIZE);
         tableID = tid;
+        system = tmp == 1;
     }
 
     free(data);
@@ -694,48 +1408,217 @@ RC RelationManager::getTableID(const string &tableName, int32_t &tableID)
     return rc;
 }
 
-// Determine if table tableName is a system table. Set the boolean argument as the result
-RC RelationManager::isSystemTable(bool &system, const string &tableName)
+RC RelationManager::readColumns(int32_t id, vector<Attribute> &attrs)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    // Clear out any old values
+    attrs.clear();
+    RC rc;
+
+    void *value = &id;
+
+    // We need to get the three values that make up an Attribute: name, type, length
+    // We also need the position of each attribute in the row
+    RBFM_ScanIterator rbfm_si;
+    vector<string> projection;
+    projection.push_back(COLUMNS_COL_COLUMN_NAME);
+    projection.push_back(COLUMNS_COL_COLUMN_TYPE);
+    projection.push_back(COLUMNS_COL_COLUMN_LENGTH);
+    projection.push_back(COLUMNS_COL_COLUMN_POSITION);
+
+    FileHandle fileHandle;
+    rc = rbfm->openFile(getFileName(COLUMNS_TABLE_NAME), fileHandle);
+    if (rc)
+        return rc;
+
+    // Scan through the Column table for all entries whose table-id equals the table id.
+    rc = rbfm->scan(fileHandle, columnDescriptor, COLUMNS_COL_TABLE_ID, EQ_OP, value, projection, rbfm_si);
+    if (rc)
+        return rc;
+
+    RID rid;
+    void *data = malloc(COLUMNS_RECORD_DATA_SIZE);
+
+    // IndexedAttr is an attr with a position. The position will be used to sort the vector
+    vector<IndexedAttr> iattrs;
+    while ((rc = rbfm_si.getNextRecord(rid, data)) == SUCCESS)
+    {
+        // For each entry, create an IndexedAttr, and fill it with the 4 results
+        IndexedAttr attr;
+        unsigned offset = 0;
+
+        // For the Columns table, there should never be a null column
+        char null;
+        memcpy(&null, data, 1);
+        if (null)
+            rc = RM_NULL_COLUMN;
+
+        // Read in name
+        offset = 1;
+        int32_t nameLen;
+        memcpy(&nameLen, (char*) data + offset, VARCHAR_LENGTH_SIZE);
+        offset += VARCHAR_LENGTH_SIZE;
+        char name[nameLen + 1];
+        name[nameLen] = '\0';
+        memcpy(name, (char*) data + offset, nameLen);
+        offset += nameLen;
+        attr.attr.name = string(name);
+
+        // read in type
+        int32_t type;
+        memcpy(&type, (char*) data + offset, INT_SIZE);
+        offset += INT_SIZE;
+        attr.attr.type = (AttrType)type;
+
+        // Read in length
+        int32_t length;
+        memcpy(&length, (char*) data + offset, INT_SIZE);
+        offset += INT_SIZE;
+        attr.attr.length = length;
+
+        // Read in position
+        int32_t pos;
+        memcpy(&pos, (char*) data + offset, INT_SIZE);
+        offset += INT_SIZE;
+        attr.pos = pos;
+
+        iattrs.push_back(attr);
+    }
+    // Do cleanup
+    rbfm_si.close();
+    rbfm->closeFile(fileHandle);
+    free(data);
+    // If we ended on an error, return that error
+    if (rc != RBFM_EOF)
+        return rc;
+
+    // Sort attributes by position ascending
+    auto comp = [](IndexedAttr first, IndexedAttr second) 
+        {return first.pos < second.pos;};
+    sort(iattrs.begin(), iattrs.end(), comp);
+
+    // Fill up our result with the Attributes in sorted order
+    for (auto attr : iattrs)
+    {
+        attrs.push_back(attr.attr);
+    }
+
+    return SUCCESS;
+}
+
+RC RelationManager::readTableOptions(int32_t id, TableOptions &options, RID &rid, bool &found)
 {
     RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
     FileHandle fileHandle;
     RC rc;
 
-    rc = rbfm->openFile(getFileName(TABLES_TABLE_NAME), fileHandle);
+    options.fillFactor = DEFAULT_FILL_FACTOR;
+    options.forwardedTuples = 0;
+    found = false;
+
+    rc = rbfm->openFile(getFileName(OPTIONS_TABLE_NAME), fileHandle);
     if (rc)
         return rc;
 
-    // We only care about system column
     vector<string> projection;
-    projection.push_back(TABLES_COL_SYSTEM);
-
-    // Set up value to be tableName in API format (without null indicator)
-    void *value = malloc(5 + TABLES_COL_TABLE_NAME_SIZE);
-    int32_t name_len = tableName.length();
-    memcpy(value, &name_len, INT_SIZE);
-    memcpy((char*)value + INT_SIZE, tableName.c_str(), name_len);
+    projection.push_back(OPTIONS_COL_FILL_FACTOR);
+    projection.push_back(OPTIONS_COL_FORWARDED_TUPLES);
 
-    // Find table whose table-name is equal to tableName
+    // There is at most one entry per table
     RBFM_ScanIterator rbfm_si;
-    rc = rbfm->scan(fileHandle, tableDescriptor, TABLES_COL_TABLE_NAME, EQ_OP, value, projection, rbfm_si);
+    rc = rbfm->scan(fileHandle, optionsDescriptor, OPTIONS_COL_TABLE_ID, EQ_OP, &id, projection, rbfm_si);
 
-    RID rid;
-    void *data = malloc (1 + INT_SIZE);
-    if ((rc = rbfm_si.getNextRecord(rid, data)) == SUCCESS)
+    void *data = malloc(OPTIONS_RECORD_DATA_SIZE);
+    if (rc == SUCCESS && (rc = rbfm_si.getNextRecord(rid, data)) == SUCCESS)
     {
-        // Parse the system field from that table entry
-        int32_t tmp;
-        fromAPI(tmp, data);
-        system = tmp == 1;
+        int32_t fillFactor, forwardedTuples;
+        memcpy(&fillFactor, (char*) data + 1, INT_SIZE);
+        memcpy(&forwardedTuples, (char*) data + 1 + INT_SIZE, INT_SIZE);
+        options.fillFactor = fillFactor;
+        options.forwardedTuples = forwardedTuples;
+        found = true;
     }
     if (rc == RBFM_EOF)
         rc = SUCCESS;
 
     free(data);
-    free(value);
     rbfm->closeFile(fileHandle);
     rbfm_si.close();
-    return rc;   
+    return rc;
+}
+
+RC RelationManager::loadTableOptions(CatalogEntry &entry)
+{
+    if (entry.hasOptions)
+        return SUCCESS;
+
+    RC rc = readTableOptions(entry.id, entry.options, entry.optionsRid, entry.hasOptionsEntry);
+    if (rc)
+        return rc;
+    entry.hasOptions = true;
+    return SUCCESS;
+}
+
+RC RelationManager::writeTableOptions(CatalogEntry &entry, const TableOptions &options)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    RC rc;
+
+    // All fields non-null
+    char data[OPTIONS_RECORD_DATA_SIZE];
+    int32_t fillFactor = options.fillFactor;
+    int32_t forwardedTuples = options.forwardedTuples;
+    data[0] = 0;
+    memcpy(data + 1, &entry.id, INT_SIZE);
+    memcpy(data + 1 + INT_SIZE, &fillFactor, INT_SIZE);
+    memcpy(data + 1 + 2 * INT_SIZE, &forwardedTuples, INT_SIZE);
+
+    // The entry's RID is known from loading the options, so there is no need to look for it
+    FileHandle fileHandle;
+    rc = rbfm->openFile(getFileName(OPTIONS_TABLE_NAME), fileHandle);
+    if (rc)
+        return rc;
+    if (entry.hasOptionsEntry)
+        rc = rbfm->updateRecord(fileHandle, optionsDescriptor, data, entry.optionsRid);
+    else
+        rc = rbfm->insertRecord(fileHandle, optionsDescriptor, data, entry.optionsRid);
+    rbfm->closeFile(fileHandle);
+    if (rc)
+        return rc;
+
+    entry.hasOptionsEntry = true;
+    entry.options = options;
+    return SUCCESS;
+}
+
+RC RelationManager::countForwardedTuples(CatalogEntry &entry, unsigned forwarded)
+{
+    RC rc = loadTableOptions(entry);
+    if (rc)
+        return rc;
+    TableOptions options = entry.options;
+    options.forwardedTuples += forwarded;
+    return writeTableOptions(entry, options);
+}
+
+RC RelationManager::deleteCatalogEntries(const string &catalogName, const vector<Attribute> &descriptor, const string &idColumn, int32_t id)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    FileHandle fileHandle;
+    RC rc;
+
+    rc = rbfm->openFile(getFileName(catalogName), fileHandle);
+    if (rc)
+        return rc;
+
+    ScanPredicate predicate;
+    predicate.attribute = idColumn;
+    predicate.compOp = EQ_OP;
+    predicate.value = &id;
+    unsigned deleted;
+    rc = rbfm->deleteWhere(fileHandle, descriptor, vector<ScanPredicateGroup>(1, ScanPredicateGroup(1, predicate)), deleted);
+    rbfm->closeFile(fileHandle);
+    return rc;
 }
 
 void RelationManager::toAPI(const string &str, void *data)
@@ -841,12 +1724,112 @@ RC RelationManager::scan(const string &tableName,
     return SUCCESS;
 }
 
+RC RelationManager::scan(const string &tableName,
+      const vector<ScanPredicateGroup> &conditions,
+      const vector<string> &attributeNames,
+      RM_ScanIterator &rm_ScanIterator)
+{
+    // Open the file for the given tableName
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+    RC rc = rbfm->openFile(getFileName(tableName), rm_ScanIterator.fileHandle);
+    if (rc)
+        return rc;
+
+    // grab the record descriptor for the given tableName
+    vector<Attribute> recordDescriptor;
+    rc = getAttributes(tableName, recordDescriptor);
+    if (rc)
+        return rc;
+
+    // The predicates are pushed down into the rbfm_scaniterator
+    rc = rbfm->scan(rm_ScanIterator.fileHandle, recordDescriptor, conditions,
+                     attributeNames, rm_ScanIterator.rbfm_iter);
+    if (rc)
+        return rc;
+
+    return SUCCESS;
+}
+
+RC RelationManager::scan(TableHandle &tableHandle,
+      const string &conditionAttribute,
+      const CompOp compOp,
+      const void *value,
+      const vector<string> &attributeNames,
+      RM_ScanIterator &rm_ScanIterator)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+    if (!tableHandle.open)
+        return RM_TABLE_NOT_OPEN;
+
+    // The iterator's own file handle is left closed, it reads through the table's
+    return rbfm->scan(tableHandle.fileHandle, tableHandle.attrs, conditionAttribute,
+                      compOp, value, attributeNames, rm_ScanIterator.rbfm_iter);
+}
+
+RC RelationManager::scan(TableHandle &tableHandle,
+      const vector<ScanPredicateGroup> &conditions,
+      const vector<string> &attributeNames,
+      RM_ScanIterator &rm_ScanIterator)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+    if (!tableHandle.open)
+        return RM_TABLE_NOT_OPEN;
+
+    return rbfm->scan(tableHandle.fileHandle, tableHandle.attrs, conditions,
+                      attributeNames, rm_ScanIterator.rbfm_iter);
+}
+
+RC RelationManager::parallelScan(const string &tableName,
+      const vector<ScanPredicateGroup> &conditions,
+      const vector<string> &attributeNames,
+      unsigned numWorkers,
+      const ParallelScanCallback &callback)
+{
+    RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+    vector<Attribute> recordDescriptor;
+    RC rc = getAttributes(tableName, recordDescriptor);
+    if (rc)
+        return rc;
+
+    // The workers open the table file themselves
+    return rbfm->parallelScan(getFileName(tableName), recordDescriptor, conditions,
+                              attributeNames, numWorkers, callback);
+}
+
 // Let rbfm do all the work
 RC RM_ScanIterator::getNextTuple(RID &rid, void *data)
 {
     return rbfm_iter.getNextRecord(rid, data);
 }
 
+void RM_ScanIterator::setLimit(unsigned limit)
+{
+    rbfm_iter.setLimit(limit);
+}
+
+RC RM_ScanIterator::getContinuation(ScanToken &token)
+{
+    return rbfm_iter.getContinuation(token);
+}
+
+RC RM_ScanIterator::resume(const ScanToken &token)
+{
+    return rbfm_iter.resume(token);
+}
+
+RC RM_ScanIterator::samplePages(unsigned count, unsigned seed)
+{
+    return rbfm_iter.samplePages(count, seed);
+}
+
+RC RM_ScanIterator::samplePercent(float percent, unsigned seed)
+{
+    return rbfm_iter.samplePercent(percent, seed);
+}
+
 // Close our file handle, rbfm_scaniterator
 RC RM_ScanIterator::close()
 {
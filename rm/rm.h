@@ -4,6 +4,8 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <memory>
 
 #include "../rbf/rbfm.h"
 
@@ -17,6 +19,7 @@ using namespace std;
 // Format for Tables table:
 // (table-id:int, table-name:varchar(50), file-name:varchar(50), system:int)
 // system will be 1 if the table is a system table, 0 otherwise
+// Clustered on table-name. Columns, Options and Statistics are clustered on table-id.
 
 #define TABLES_COL_TABLE_ID         "table-id"
 #define TABLES_COL_TABLE_NAME       "table-name"
@@ -41,10 +44,92 @@ using namespace std;
 // 1 null byte, 4 integer fields and a varchar
 #define COLUMNS_RECORD_DATA_SIZE 1 + 5 * INT_SIZE + COLUMNS_COL_COLUMN_NAME_SIZE
 
+#define OPTIONS_TABLE_NAME           "Options"
+#define OPTIONS_TABLE_ID             3
+
+// Format for Options table:
+// (table-id:int, fill-factor:int, forwarded-tuples:int)
+// A table without an entry has the default options
+
+#define OPTIONS_COL_TABLE_ID         "table-id"
+#define OPTIONS_COL_FILL_FACTOR      "fill-factor"
+#define OPTIONS_COL_FORWARDED_TUPLES "forwarded-tuples"
+
+// 1 null byte and 3 integer fields
+#define OPTIONS_RECORD_DATA_SIZE 1 + 3 * INT_SIZE
+
+#define STATISTICS_TABLE_NAME        "Statistics"
+#define STATISTICS_TABLE_ID          4
+
+// Format for Statistics table, one entry per column of an analyzed table:
+// (table-id:int, column-position:int, row-count:int, null-fraction:real, distinct-count:int,
+//  min-value:varchar, max-value:varchar, histogram:varchar, sampled:int)
+// Values are stored in the format of a scan value, a null min-value/max-value means every value was null.
+// The histogram holds the upper bound of each bucket, each preceded by its size (4 bytes).
+// sampled is 1 if the statistics were gathered from a sample of the pages, 0 otherwise.
+
+#define STATISTICS_COL_TABLE_ID       "table-id"
+#define STATISTICS_COL_POSITION       "column-position"
+#define STATISTICS_COL_ROW_COUNT      "row-count"
+#define STATISTICS_COL_NULL_FRACTION  "null-fraction"
+#define STATISTICS_COL_DISTINCT_COUNT "distinct-count"
+#define STATISTICS_COL_MIN_VALUE      "min-value"
+#define STATISTICS_COL_MAX_VALUE      "max-value"
+#define STATISTICS_COL_HISTOGRAM      "histogram"
+#define STATISTICS_COL_SAMPLED        "sampled"
+
+// Varchar values kept in the Statistics table are cut to their first STATISTICS_VALUE_PREFIX characters
+#define STATISTICS_VALUE_PREFIX       64
+#define STATISTICS_COL_VALUE_SIZE     (VARCHAR_LENGTH_SIZE + STATISTICS_VALUE_PREFIX)
+#define STATISTICS_COL_HISTOGRAM_SIZE (STATS_HISTOGRAM_BUCKETS * (VARCHAR_LENGTH_SIZE + STATISTICS_COL_VALUE_SIZE))
+
+// 2 null bytes, 6 fixed-width fields and 3 varchars
+#define STATISTICS_RECORD_DATA_SIZE (2 + 6 * INT_SIZE + 3 * VARCHAR_LENGTH_SIZE + 2 * STATISTICS_COL_VALUE_SIZE + STATISTICS_COL_HISTOGRAM_SIZE)
+
+// The catalog header is a file of a single page starting with a CatalogHeader. Its name has no table file
+// extension, so no table can clash with it. New table ids come from its sequence, which a RelationManager
+// advances TABLE_ID_BATCH ids at a time with one read and one write of the page, handing the ids of a batch
+// out from memory. Ids left over when it exits are never used.
+#define CATALOG_HEADER_FILE_NAME    "Catalog.hdr"
+#define TABLE_ID_BATCH              64
+
+typedef struct CatalogHeader
+{
+    int32_t nextTableID;    // first id not yet taken from the sequence
+} CatalogHeader;
+
 # define RM_EOF (-1)  // end of a scan operator
 
 #define RM_CANNOT_MOD_SYS_TBL 1
 #define RM_NULL_COLUMN        2
+#define RM_NO_STATISTICS      3
+#define RM_TABLE_NOT_OPEN     4
+
+// Per-table settings and counters, kept in the Options table
+typedef struct TableOptions
+{
+    unsigned fillFactor;        // how full inserts may make a page, see RecordBasedFileManager::insertRecord
+    unsigned forwardedTuples;   // tuples that updates have forwarded to another page
+} TableOptions;
+
+// What the catalog holds about a table, kept in memory by the RelationManager once looked up
+typedef struct CatalogEntry
+{
+    int32_t id;
+    bool system;
+    vector<Attribute> attrs;
+    bool hasOptions;            // options are read from the Options table on first use
+    TableOptions options;
+    bool hasOptionsEntry;       // whether the Options table has an entry for it, at optionsRid
+    RID optionsRid;
+} CatalogEntry;
+
+// Catalog lookups answered from memory, and those that had to read the Tables and Columns tables
+typedef struct CatalogCacheStats
+{
+    unsigned hits;
+    unsigned misses;
+} CatalogCacheStats;
 
 typedef struct IndexedAttr
 {
@@ -62,12 +147,44 @@ public:
   RC getNextTuple(RID &rid, void *data);
   RC close();
 
+  // Paging through a scan, see RBFM_ScanIterator
+  void setLimit(unsigned limit);
+  RC getContinuation(ScanToken &token);
+  RC resume(const ScanToken &token);
+
+  // Scanning a random sample of the pages, see RBFM_ScanIterator
+  RC samplePages(unsigned count, unsigned seed);
+  RC samplePercent(float percent, unsigned seed);
+
   friend class RelationManager;
 private:
   RBFM_ScanIterator rbfm_iter;
   FileHandle fileHandle;
 };
 
+// A table opened with RelationManager::openTable. Tuple operations on a handle use the schema, options and
+// open file it keeps instead of looking the table up and opening its file on every call. The options are shared
+// with the catalog cache, so setFillFactor on the open table applies to it.
+// Close it with RelationManager::closeTable before the table is deleted.
+class TableHandle {
+public:
+  TableHandle() : id(0), system(false), open(false) {};
+  ~TableHandle() {};
+
+  const string &getTableName() const { return tableName; }
+  const vector<Attribute> &getAttributes() const { return attrs; }
+
+  friend class RelationManager;
+private:
+  string tableName;
+  int32_t id;
+  bool system;
+  vector<Attribute> attrs;
+  shared_ptr<CatalogEntry> entry;
+  FileHandle fileHandle;
+  bool open;
+};
+
 
 // Relation Manager
 class RelationManager
@@ -81,24 +198,90 @@ public:
 
   RC createTable(const string &tableName, const vector<Attribute> &attrs);
 
+  // Create a table whose tuples are kept in keyAttribute order, see RecordBasedFileManager::createClusteredFile.
+  // Scans with range conditions on the key read only the part of the table that can match.
+  RC createClusteredTable(const string &tableName, const vector<Attribute> &attrs, const string &keyAttribute);
+
+  // Create an insert-only table, see RecordBasedFileManager::createAppendOnlyFile.
+  // Its tuples are deleted with discardPages() rather than deleteTuple().
+  RC createAppendOnlyTable(const string &tableName, const vector<Attribute> &attrs);
+
   RC deleteTable(const string &tableName);
 
   RC getAttributes(const string &tableName, vector<Attribute> &attrs);
 
+  // Hits and misses of the in-memory catalog cache. Tables are cached by name on first lookup and dropped
+  // when created, deleted or altered through this RelationManager, which must be the only one changing the catalog.
+  CatalogCacheStats getCatalogCacheStats();
+
+  // Keep the table's pages at most fillFactor percent full (1 to 100, 100 by default) when inserting, leaving
+  // room for its tuples to grow into when updated instead of being forwarded to another page
+  RC setFillFactor(const string &tableName, unsigned fillFactor);
+
+  // The table's fill factor, and how many of its tuples have been forwarded by updates
+  RC getTableOptions(const string &tableName, TableOptions &options);
+
+  // Gather the statistics of the table, see RecordBasedFileManager::analyzeFile, and store them in the
+  // Statistics table in place of any gathered before
+  RC analyzeTable(const string &tableName);
+
+  // Same, reading only samplePercent percent of the table's pages, picked at random.
+  // See RecordBasedFileManager::analyzeFile for what a sample estimates.
+  RC analyzeTable(const string &tableName, float samplePercent);
+
+  // The statistics stored by the last analyzeTable(), or RM_NO_STATISTICS if it was never analyzed
+  RC getTableStats(const string &tableName, TableStats &stats);
+
   RC insertTuple(const string &tableName, const void *data, RID &rid);
 
   RC deleteTuple(const string &tableName, const RID &rid);
 
   RC updateTuple(const string &tableName, const void *data, const RID &rid);
 
+  // Set one attribute of a tuple, in place when it keeps its size, see RecordBasedFileManager::updateAttribute
+  RC updateAttribute(const string &tableName, const RID &rid, const string &attributeName, const void *value);
+
   RC readTuple(const string &tableName, const RID &rid, void *data);
 
+  // Look up the table and open its file once, for use with the TableHandle overloads below
+  RC openTable(const string &tableName, TableHandle &tableHandle);
+  RC closeTable(TableHandle &tableHandle);
+
+  // Same as the tableName versions, on an open table. They return RM_TABLE_NOT_OPEN if it is not.
+  RC insertTuple(TableHandle &tableHandle, const void *data, RID &rid);
+  RC deleteTuple(TableHandle &tableHandle, const RID &rid);
+  RC updateTuple(TableHandle &tableHandle, const void *data, const RID &rid);
+  RC readTuple(TableHandle &tableHandle, const RID &rid, void *data);
+
+  // Read n tuples a page at a time, see RecordBasedFileManager::readRecords
+  RC readTuples(const string &tableName, const RID *rids, unsigned n, const RecordBatchCallback &callback);
+
   // Print a tuple that is passed to this utility method.
   // The format is the same as printRecord().
   RC printTuple(const vector<Attribute> &attrs, const void *data);
 
   RC readAttribute(const string &tableName, const RID &rid, const string &attributeName, void *data);
 
+  // Read several attributes of a tuple at once, see RecordBasedFileManager::readAttributes
+  RC readAttributes(const string &tableName, const RID &rid, const vector<string> &attributeNames, void *data);
+
+  // Load a CSV/TSV file into the table, see RecordBasedFileManager::bulkLoad. The table's schema is looked up once.
+  RC bulkLoad(const string &tableName, const string &dataFileName, char delimiter, bool hasHeader,
+      unsigned numWorkers, BulkLoadStats &stats);
+
+  // Delete every tuple satisfying the conditions, see RecordBasedFileManager::deleteWhere
+  RC deleteWhere(const string &tableName, const vector<ScanPredicateGroup> &conditions, unsigned &deleted);
+
+  // Delete every tuple on pages [firstPage, endPage) of the table, see RecordBasedFileManager::discardPages
+  RC discardPages(const string &tableName, PageNum firstPage, PageNum endPage, unsigned &deleted);
+
+  // Shorten the forwarding chains left by updates, see RecordBasedFileManager::vacuumForwardedRecords
+  RC vacuumForwardedTuples(const string &tableName, unsigned &hopsRemoved);
+
+  // Shrink the table's file, see RecordBasedFileManager::vacuumFile. There are no indexes kept by the
+  // RelationManager, so any RIDs held elsewhere must be updated by the caller from remapped.
+  RC vacuumTable(const string &tableName, bool relocate, vector<RIDRemap> &remapped, VacuumStats &stats);
+
   // Scan returns an iterator to allow the caller to go through the results one by one.
   // Do not store entire results in the scan iterator.
   RC scan(const string &tableName,
@@ -108,6 +291,33 @@ public:
       const vector<string> &attributeNames, // a list of projected attributes
       RM_ScanIterator &rm_ScanIterator);
 
+  // Scan with several conditions, see RecordBasedFileManager::scan.
+  // Groups are ANDed together, the predicates within a group are ORed.
+  RC scan(const string &tableName,
+      const vector<ScanPredicateGroup> &conditions,
+      const vector<string> &attributeNames,
+      RM_ScanIterator &rm_ScanIterator);
+
+  // Scans of an open table. The iterator reads through the handle's file, so close it before the table.
+  RC scan(TableHandle &tableHandle,
+      const string &conditionAttribute,
+      const CompOp compOp,
+      const void *value,
+      const vector<string> &attributeNames,
+      RM_ScanIterator &rm_ScanIterator);
+
+  RC scan(TableHandle &tableHandle,
+      const vector<ScanPredicateGroup> &conditions,
+      const vector<string> &attributeNames,
+      RM_ScanIterator &rm_ScanIterator);
+
+  // Scan the table with several worker threads, see RecordBasedFileManager::parallelScan
+  RC parallelScan(const string &tableName,
+      const vector<ScanPredicateGroup> &conditions,
+      const vector<string> &attributeNames,
+      unsigned numWorkers,
+      const ParallelScanCallback &callback);
+
 
 protected:
   RelationManager();
@@ -117,6 +327,16 @@ private:
   static RelationManager *_rm;
   const vector<Attribute> tableDescriptor;
   const vector<Attribute> columnDescriptor;
+  const vector<Attribute> optionsDescriptor;
+  const vector<Attribute> statisticsDescriptor;
+
+  // Catalog entries by table name, see getCatalogEntry. Open tables share their entry.
+  unordered_map<string, shared_ptr<CatalogEntry>> catalogCache;
+  CatalogCacheStats cacheStats;
+
+  // Table ids [nextTableID, tableIDBatchEnd) were taken from the sequence and not handed out yet
+  int32_t nextTableID;
+  int32_t tableIDBatchEnd;
 
   // Convert tableName to file name (append extension)
   static string getFileName(const char *tableName);
@@ -125,11 +345,16 @@ private:
   // Create recordDescriptor for Table/Column tables
   static vector<Attribute> createTableDescriptor();
   static vector<Attribute> createColumnDescriptor();
+  static vector<Attribute> createOptionsDescriptor();
+  static vector<Attribute> createStatisticsDescriptor();
 
   // Prepare an entry for the Table/Column table
   void prepareTablesRecordData(int32_t id, bool system, const string &tableName, void *data);
   void prepareColumnsRecordData(int32_t id, int32_t pos, Attribute attr, void *data);
 
+  // Gives a table whose file was just created an ID, and enters it in the Tables and Columns tables
+  RC registerTable(const string &tableName, const vector<Attribute> &attrs);
+
   // Given a table ID and recordDescriptor, creates entries in Column table
   RC insertColumns(int32_t id, const vector<Attribute> &recordDescriptor);
   // Given table ID, system flag, and table name, creates entry in Table table
@@ -137,11 +362,39 @@ private:
 
   // Get next table ID for creating table
   RC getNextTableID(int32_t &table_id);
+  // Take the next TABLE_ID_BATCH ids from the sequence in the catalog header
+  RC reserveTableIDs();
+  // Create the catalog header, with the sequence starting at nextID
+  RC createCatalogHeader(int32_t nextID);
+  // Largest table ID in the Tables table, for catalogs created without a header
+  RC findMaxTableID(int32_t &maxID);
   // Get table ID of table with name tableName
   RC getTableID(const string &tableName, int32_t &tableID);
 
   RC isSystemTable(bool &system, const string &tableName);
 
+  // Find the catalog entry of tableName, reading it from the Tables and Columns tables if it is not cached.
+  // The cache keeps the entry until the table is next created, deleted or altered.
+  RC getCatalogEntry(const string &tableName, shared_ptr<CatalogEntry> &entry);
+  // Drop tableName from the catalog cache, to be read again on its next lookup
+  void invalidateCatalogEntry(const string &tableName);
+  // Read the Tables entry of tableName
+  RC readTableEntry(const string &tableName, int32_t &tableID, bool &system);
+  // Read the Columns entries of table id, in column order
+  RC readColumns(int32_t id, vector<Attribute> &attrs);
+
+  // Find the Options entry of table id. found is false, and options hold the defaults, if it has none
+  RC readTableOptions(int32_t id, TableOptions &options, RID &rid, bool &found);
+  // Read the options of a cached table from the Options table, unless they already were
+  RC loadTableOptions(CatalogEntry &entry);
+  // Insert or replace the Options entry of a cached table, whose options must be loaded
+  RC writeTableOptions(CatalogEntry &entry, const TableOptions &options);
+  // Add forwarded to the count of forwarded tuples of a cached table
+  RC countForwardedTuples(CatalogEntry &entry, unsigned forwarded);
+
+  // Delete the entries of catalog table catalogName whose idColumn equals id
+  RC deleteCatalogEntries(const string &catalogName, const vector<Attribute> &descriptor, const string &idColumn, int32_t id);
+
 public: 
 // Extra credit work (10 points)
   RC addAttribute(const string &tableName, const Attribute &attr);
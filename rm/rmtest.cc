@@ -990,6 +990,485 @@ RC TEST_RM_15(const string &tableName)
     return 0;
 }
 
+RC TEST_RM_16(const string &tableName)
+{
+    // Functions Tested
+    // 1. setFillFactor **
+    // 2. getTableOptions **
+    cout << endl << "***** In RM Test Case 16 *****" << endl;
+
+    string packedTable = tableName;
+    string sparseTable = tableName + "_sparse";
+    string clusteredTable = tableName + "_clustered";
+    string appendOnlyTable = tableName + "_log";
+    remove((packedTable + ".t").c_str());
+    remove((sparseTable + ".t").c_str());
+    remove((clusteredTable + ".t").c_str());
+    remove((appendOnlyTable + ".t").c_str());
+    createTable(packedTable);
+    createTable(sparseTable);
+
+    vector<Attribute> attrs;
+    RC rc = rm->getAttributes(packedTable, attrs);
+    assert(rc == success && "RelationManager::getAttributes() should not fail.");
+
+    TableOptions options;
+    rc = rm->getTableOptions(packedTable, options);
+    assert(rc == success && options.fillFactor == 100 && options.forwardedTuples == 0 && "A new table should have the default options.");
+
+    rc = rm->setFillFactor(sparseTable, 0);
+    assert(rc == RBFM_BAD_FILL_FACTOR && "A fill factor of 0 should be rejected.");
+    rc = rm->setFillFactor(sparseTable, 101);
+    assert(rc == RBFM_BAD_FILL_FACTOR && "A fill factor over 100 should be rejected.");
+    rc = rm->setFillFactor("Tables", 50);
+    assert(rc == RM_CANNOT_MOD_SYS_TBL && "System tables should keep their fill factor.");
+    rc = rm->setFillFactor(sparseTable, 40);
+    assert(rc == success && "RelationManager::setFillFactor() should not fail.");
+    rc = rm->getTableOptions(sparseTable, options);
+    assert(rc == success && options.fillFactor == 40 && "The fill factor should be kept.");
+
+    // Fill both tables with short names, then lengthen every name
+    int nullAttributesIndicatorActualSize = getActualByteForNullsIndicator(attrs.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullAttributesIndicatorActualSize);
+    memset(nullsIndicator, 0, nullAttributesIndicatorActualSize);
+    void *tuple = malloc(200);
+    int tupleSize = 0;
+    int numTuples = 1000;
+    string longName(30, 'x');
+    unsigned forwarded[2];
+    string tables[2] = {packedTable, sparseTable};
+    for (int t = 0; t < 2; t++)
+    {
+        vector<RID> rids(numTuples);
+        for (int i = 0; i < numTuples; i++)
+        {
+            prepareTuple(attrs.size(), nullsIndicator, 1, "x", i, 170.0, i, tuple, &tupleSize);
+            rc = rm->insertTuple(tables[t], tuple, rids[i]);
+            assert(rc == success && "RelationManager::insertTuple() should not fail.");
+        }
+        for (int i = 0; i < numTuples; i++)
+        {
+            prepareTuple(attrs.size(), nullsIndicator, longName.length(), longName, i, 170.0, i, tuple, &tupleSize);
+            rc = rm->updateTuple(tables[t], tuple, rids[i]);
+            assert(rc == success && "RelationManager::updateTuple() should not fail.");
+        }
+        rc = rm->getTableOptions(tables[t], options);
+        assert(rc == success && "RelationManager::getTableOptions() should not fail.");
+        forwarded[t] = options.forwardedTuples;
+        cout << tables[t] << ": fill factor " << options.fillFactor << ", " << forwarded[t] << " tuples forwarded" << endl;
+    }
+    assert(forwarded[0] > 0 && "Growing the tuples of full pages should forward some of them.");
+    assert(forwarded[1] == 0 && "Pages left 60% empty should have room for their tuples to double.");
+
+    // Tables that do not pick their pages by free space cannot keep to a fill factor
+    rc = rm->createClusteredTable(clusteredTable, attrs, "Age");
+    assert(rc == success && "RelationManager::createClusteredTable() should not fail.");
+    rc = rm->setFillFactor(clusteredTable, 50);
+    assert(rc == RBFM_CLUSTERED_FILE && "A clustered table should not take a fill factor.");
+    rc = rm->createAppendOnlyTable(appendOnlyTable, attrs);
+    assert(rc == success && "RelationManager::createAppendOnlyTable() should not fail.");
+    rc = rm->setFillFactor(appendOnlyTable, 50);
+    assert(rc == RBFM_APPEND_ONLY_FILE && "An append-only table should not take a fill factor.");
+    rc = rm->setFillFactor(appendOnlyTable, 100);
+    assert(rc == success && "A full fill factor suits any table.");
+
+    rc = rm->deleteTable(packedTable);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+    rc = rm->deleteTable(sparseTable);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+    rc = rm->deleteTable(clusteredTable);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+    rc = rm->deleteTable(appendOnlyTable);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+
+    free(tuple);
+    free(nullsIndicator);
+    cout << "***** Test Case 16 Finished. The result will be examined. *****" << endl;
+    return 0;
+}
+
+RC TEST_RM_17(const string &tableName)
+{
+    // Functions Tested
+    // 1. analyzeTable **
+    // 2. getTableStats **
+    cout << endl << "***** In RM Test Case 17 *****" << endl;
+
+    // A long varchar, an int that is null on every tenth tuple, and a varchar that is always null
+    vector<Attribute> attrs;
+    Attribute attr;
+    attr.name = "Title";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength)200;
+    attrs.push_back(attr);
+    attr.name = "Year";
+    attr.type = TypeInt;
+    attr.length = (AttrLength)4;
+    attrs.push_back(attr);
+    attr.name = "Note";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength)50;
+    attrs.push_back(attr);
+
+    remove((tableName + ".t").c_str());
+    RC rc = rm->createTable(tableName, attrs);
+    assert(rc == success && "RelationManager::createTable() should not fail.");
+
+    TableStats stats;
+    rc = rm->getTableStats(tableName, stats);
+    assert(rc == RM_NO_STATISTICS && "A table never analyzed should have no statistics.");
+
+    // Titles are 100 characters, starting with the tuple's number so they sort by it
+    int numTuples = 2000;
+    char tuple[200];
+    RID rid;
+    auto title = [](int i)
+    {
+        char number[8];
+        sprintf(number, "%05d", i);
+        return string(number) + string(95, 'a' + i % 26);
+    };
+    for (int i = 0; i < numTuples; i++)
+    {
+        string value = title(i);
+        int length = value.length();
+        int offset = 1;
+        tuple[0] = i % 10 == 0 ? 0x60 : 0x20;
+        memcpy(tuple + offset, &length, sizeof(int));
+        offset += sizeof(int);
+        memcpy(tuple + offset, value.c_str(), length);
+        offset += length;
+        if (i % 10 != 0)
+            memcpy(tuple + offset, &i, sizeof(int));
+        rc = rm->insertTuple(tableName, tuple, rid);
+        assert(rc == success && "RelationManager::insertTuple() should not fail.");
+    }
+
+    rc = rm->analyzeTable(tableName);
+    assert(rc == success && "RelationManager::analyzeTable() should not fail.");
+    rc = rm->getTableStats(tableName, stats);
+    assert(rc == success && "RelationManager::getTableStats() should not fail.");
+    assert(stats.rowCount == (unsigned) numTuples && stats.columns.size() == attrs.size() && "Every column should have statistics.");
+    assert(!stats.sampled && "Statistics of the whole table are not sampled.");
+
+    // Varchar bounds come back cut to their first STATISTICS_VALUE_PREFIX characters
+    const ColumnStats &titles = stats.columns[0];
+    int length;
+    string lowest = title(0), highest = title(numTuples - 1);
+    assert(titles.minValue.size() == sizeof(int) + STATISTICS_VALUE_PREFIX && titles.maxValue.size() == sizeof(int) + STATISTICS_VALUE_PREFIX
+        && "Long varchar bounds should be cut.");
+    memcpy(&length, titles.minValue.data(), sizeof(int));
+    assert(length == STATISTICS_VALUE_PREFIX && titles.minValue.compare(sizeof(int), length, lowest, 0, length) == 0
+        && "The smallest title should be kept up to the prefix length.");
+    memcpy(&length, titles.maxValue.data(), sizeof(int));
+    assert(length == STATISTICS_VALUE_PREFIX && titles.maxValue.compare(sizeof(int), length, highest, 0, length) == 0
+        && "The largest title should be kept up to the prefix length.");
+    for (const string &bound : titles.histogram)
+        assert(bound.size() <= sizeof(int) + STATISTICS_VALUE_PREFIX && "Histogram bounds should be cut too.");
+    assert(titles.nullFraction == 0 && "No title is null.");
+
+    const ColumnStats &years = stats.columns[1];
+    int minYear, maxYear;
+    memcpy(&minYear, years.minValue.data(), sizeof(int));
+    memcpy(&maxYear, years.maxValue.data(), sizeof(int));
+    assert(minYear == 1 && maxYear == numTuples - 1 && "The smallest and largest years should be exact.");
+    assert(years.nullFraction > 0.09 && years.nullFraction < 0.11 && "A tenth of the years are null.");
+    assert(years.distinctCount > numTuples * 0.9 * 0.9 && years.distinctCount < numTuples * 0.9 * 1.1 && "The distinct count should be close.");
+    assert(years.histogram.size() == STATS_HISTOGRAM_BUCKETS && "The histogram should have every bucket.");
+
+    // A column of nulls stores null bounds, and reads back without any
+    const ColumnStats &notes = stats.columns[2];
+    assert(notes.nullFraction == 1 && notes.minValue.empty() && notes.maxValue.empty() && notes.histogram.empty()
+        && "A column holding only nulls should have no bounds.");
+    cout << "Title distinct " << titles.distinctCount << ", year distinct " << years.distinctCount << endl;
+
+    // Analyzing again replaces the statistics
+    rc = rm->insertTuple(tableName, tuple, rid);
+    assert(rc == success && "RelationManager::insertTuple() should not fail.");
+    rc = rm->analyzeTable(tableName);
+    assert(rc == success && "RelationManager::analyzeTable() should not fail.");
+    rc = rm->getTableStats(tableName, stats);
+    assert(rc == success && stats.rowCount == (unsigned) numTuples + 1 && stats.columns.size() == attrs.size()
+        && "The new statistics should replace the old ones.");
+
+    // A sample is labelled as such, its row count scaled to the whole table
+    rc = rm->analyzeTable(tableName, 25);
+    assert(rc == success && "RelationManager::analyzeTable() should not fail.");
+    rc = rm->getTableStats(tableName, stats);
+    assert(rc == success && stats.sampled && "Sampled statistics should be labelled.");
+    assert(stats.rowCount > (numTuples + 1) * 0.5 && stats.rowCount < (numTuples + 1) * 1.5 && "The row count should be scaled.");
+
+    rc = rm->deleteTable(tableName);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+
+    cout << "***** Test Case 17 Finished. The result will be examined. *****" << endl;
+    return 0;
+}
+
+RC TEST_RM_18(const string &tableName)
+{
+    // Functions Tested
+    // 1. getCatalogCacheStats **
+    // 2. getAttributes after deleteTable and createTable of the same name
+    cout << endl << "***** In RM Test Case 18 *****" << endl;
+
+    remove((tableName + ".t").c_str());
+    RC rc = createTable(tableName);
+    assert(rc == success && "createTable() should not fail.");
+
+    // The first lookup reads the catalog, the second is answered from memory
+    vector<Attribute> attrs;
+    CatalogCacheStats before = rm->getCatalogCacheStats();
+    rc = rm->getAttributes(tableName, attrs);
+    assert(rc == success && attrs.size() == 4 && "RelationManager::getAttributes() should not fail.");
+    CatalogCacheStats after = rm->getCatalogCacheStats();
+    assert(after.misses == before.misses + 1 && after.hits == before.hits && "The first lookup should miss.");
+
+    before = after;
+    rc = rm->getAttributes(tableName, attrs);
+    assert(rc == success && attrs.size() == 4 && "RelationManager::getAttributes() should not fail.");
+    after = rm->getCatalogCacheStats();
+    assert(after.hits == before.hits + 1 && after.misses == before.misses && "The second lookup should hit.");
+
+    // A deleted table is dropped from the cache
+    rc = rm->deleteTable(tableName);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+    before = rm->getCatalogCacheStats();
+    rc = rm->getAttributes(tableName, attrs);
+    assert(rc != success && "A deleted table should not be found.");
+    after = rm->getCatalogCacheStats();
+    assert(after.misses == before.misses + 1 && after.hits == before.hits && "A deleted table should not be cached.");
+
+    // Creating the same name again with another schema should not serve the old one
+    vector<Attribute> newAttrs;
+    Attribute attr;
+    attr.name = "Id";
+    attr.type = TypeInt;
+    attr.length = (AttrLength)4;
+    newAttrs.push_back(attr);
+    rc = rm->createTable(tableName, newAttrs);
+    assert(rc == success && "RelationManager::createTable() should not fail.");
+    before = rm->getCatalogCacheStats();
+    rc = rm->getAttributes(tableName, attrs);
+    assert(rc == success && attrs.size() == 1 && attrs[0].name == "Id" && "The new schema should be returned.");
+    after = rm->getCatalogCacheStats();
+    assert(after.misses == before.misses + 1 && "The new table should be read from the catalog.");
+
+    rc = rm->deleteTable(tableName);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+
+    cout << "***** Test Case 18 Finished. The result will be examined. *****" << endl;
+    return 0;
+}
+
+RC TEST_RM_19(const string &tableName)
+{
+    // Functions Tested
+    // 1. openTable / closeTable **
+    // 2. insertTuple, updateTuple, readTuple, deleteTuple on a TableHandle **
+    // 3. setFillFactor while the table is open
+    cout << endl << "***** In RM Test Case 19 *****" << endl;
+
+    remove((tableName + ".t").c_str());
+    RC rc = createTable(tableName);
+    assert(rc == success && "createTable() should not fail.");
+
+    TableHandle tableHandle;
+    rc = rm->openTable(tableName, tableHandle);
+    assert(rc == success && "RelationManager::openTable() should not fail.");
+    rc = rm->openTable(tableName, tableHandle);
+    assert(rc != success && "An open handle should not be opened again.");
+    const vector<Attribute> &attrs = tableHandle.getAttributes();
+
+    int nullAttributesIndicatorActualSize = getActualByteForNullsIndicator(attrs.size());
+    unsigned char *nullsIndicator = (unsigned char *) malloc(nullAttributesIndicatorActualSize);
+    memset(nullsIndicator, 0, nullAttributesIndicatorActualSize);
+    void *tuple = malloc(200);
+    void *returnedData = malloc(200);
+    int tupleSize = 0;
+    string longName(30, 'x');
+
+    // Fill the first page with short names
+    vector<RID> rids;
+    RID rid;
+    do
+    {
+        prepareTuple(attrs.size(), nullsIndicator, 1, "x", rids.size(), 170.0, rids.size(), tuple, &tupleSize);
+        rc = rm->insertTuple(tableHandle, tuple, rid);
+        assert(rc == success && "RelationManager::insertTuple() should not fail.");
+        rids.push_back(rid);
+    } while (rid.pageNum == 0);
+
+    // Tuples outgrowing the full page are counted through the handle
+    for (size_t i = 0; i + 1 < rids.size(); i++)
+    {
+        prepareTuple(attrs.size(), nullsIndicator, longName.length(), longName, i, 170.0, i, tuple, &tupleSize);
+        rc = rm->updateTuple(tableHandle, tuple, rids[i]);
+        assert(rc == success && "RelationManager::updateTuple() should not fail.");
+    }
+    TableOptions options;
+    rc = rm->getTableOptions(tableName, options);
+    assert(rc == success && options.forwardedTuples > 0 && "Updates through the handle should count forwarded tuples.");
+    prepareTuple(attrs.size(), nullsIndicator, longName.length(), longName, 0, 170.0, 0, tuple, &tupleSize);
+    rc = rm->readTuple(tableHandle, rids[0], returnedData);
+    assert(rc == success && memcmp(tuple, returnedData, tupleSize) == 0 && "A forwarded tuple should read back through the handle.");
+
+    // A fill factor set on the open table applies to its next inserts. At 100 these would all fit on page 1.
+    rc = rm->setFillFactor(tableName, 10);
+    assert(rc == success && "RelationManager::setFillFactor() should not fail.");
+    unsigned lastPage = rid.pageNum;
+    for (int i = 0; i < 40; i++)
+    {
+        prepareTuple(attrs.size(), nullsIndicator, 1, "x", i, 170.0, i, tuple, &tupleSize);
+        rc = rm->insertTuple(tableHandle, tuple, rid);
+        assert(rc == success && "RelationManager::insertTuple() should not fail.");
+    }
+    assert(rid.pageNum > lastPage && "Inserts should keep to the fill factor set while the table is open.");
+    cout << "40 tuples inserted at fill factor 10 reached page " << rid.pageNum << endl;
+
+    rc = rm->deleteTuple(tableHandle, rid);
+    assert(rc == success && "RelationManager::deleteTuple() should not fail.");
+
+    // A closed handle can no longer be used
+    rc = rm->closeTable(tableHandle);
+    assert(rc == success && "RelationManager::closeTable() should not fail.");
+    rc = rm->insertTuple(tableHandle, tuple, rid);
+    assert(rc == RM_TABLE_NOT_OPEN && "Inserting through a closed handle should fail.");
+    rc = rm->readTuple(tableHandle, rids[0], returnedData);
+    assert(rc == RM_TABLE_NOT_OPEN && "Reading through a closed handle should fail.");
+    rc = rm->updateTuple(tableHandle, tuple, rids[0]);
+    assert(rc == RM_TABLE_NOT_OPEN && "Updating through a closed handle should fail.");
+    rc = rm->deleteTuple(tableHandle, rids[0]);
+    assert(rc == RM_TABLE_NOT_OPEN && "Deleting through a closed handle should fail.");
+    rc = rm->closeTable(tableHandle);
+    assert(rc == RM_TABLE_NOT_OPEN && "Closing a closed handle should fail.");
+
+    free(nullsIndicator);
+    free(tuple);
+    free(returnedData);
+    rc = rm->deleteTable(tableName);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+
+    cout << "***** Test Case 19 Finished. The result will be examined. *****" << endl;
+    return 0;
+}
+
+// Find the id of tableName in the Tables table
+RC getTableID(const string &tableName, int &id)
+{
+    RM_ScanIterator rmsi;
+    vector<string> attributes;
+    attributes.push_back(TABLES_COL_TABLE_ID);
+    char value[PAGE_SIZE];
+    int length = tableName.length();
+    memcpy(value, &length, sizeof(int));
+    memcpy(value + sizeof(int), tableName.c_str(), length);
+    RC rc = rm->scan("Tables", TABLES_COL_TABLE_NAME, EQ_OP, value, attributes, rmsi);
+    if (rc)
+        return rc;
+    RID rid;
+    char returnedData[1 + sizeof(int)];
+    rc = rmsi.getNextTuple(rid, returnedData);
+    if (rc == success)
+        memcpy(&id, returnedData + 1, sizeof(int));
+    rmsi.close();
+    return rc;
+}
+
+RC TEST_RM_20(const string &tableName)
+{
+    // Functions Tested
+    // 1. deleteCatalog / createCatalog, with a header left over from another catalog **
+    // 2. Table ids after the catalog is created again
+    // 3. Table ids of a catalog without a header
+    cout << endl << "***** In RM Test Case 20 *****" << endl;
+
+    // The tables other tests leave for rmtest_delete_tables are made again, empty, once the catalog is
+    const char *userTables[] = {"tbl_employee", "tbl_employee2", "tbl_employee3", "tbl_employee4", "tbl_b_employee4", "tbl_b_employee5"};
+    vector<pair<string, vector<Attribute>>> savedTables;
+    for (const char *name : userTables)
+    {
+        vector<Attribute> attrs;
+        if (rm->getAttributes(name, attrs) == success)
+            savedTables.push_back(make_pair(string(name), attrs));
+    }
+
+    string firstTable = tableName + "_a";
+    string secondTable = tableName + "_b";
+    remove((firstTable + ".t").c_str());
+    remove((secondTable + ".t").c_str());
+    RC rc = createTable(firstTable);
+    assert(rc == success && "createTable() should not fail.");
+    int oldID;
+    rc = getTableID(firstTable, oldID);
+    assert(rc == success && "The table should be in the Tables table.");
+
+    // Drop the catalog, and leave a header behind as if the catalog files had been removed by hand
+    rc = rm->deleteCatalog();
+    assert(rc == success && "RelationManager::deleteCatalog() should not fail.");
+    for (const pair<string, vector<Attribute>> &table : savedTables)
+        remove((table.first + ".t").c_str());
+    remove((firstTable + ".t").c_str());
+    PagedFileManager *pfm = PagedFileManager::instance();
+    rc = pfm->createFile(CATALOG_HEADER_FILE_NAME);
+    assert(rc == success && "Creating a stale header should not fail.");
+
+    rc = rm->createCatalog();
+    assert(rc == success && "RelationManager::createCatalog() should replace a stale header.");
+
+    // A new catalog numbers its tables from the start, not after the ones of the old catalog
+    int id;
+    rc = createTable(firstTable);
+    assert(rc == success && "createTable() should not fail.");
+    rc = getTableID(firstTable, id);
+    assert(rc == success && id == STATISTICS_TABLE_ID + 1 && "A new catalog should start its table ids over.");
+    cout << "Table id " << oldID << " before creating the catalog again, " << id << " after" << endl;
+    rc = createTable(secondTable);
+    assert(rc == success && "createTable() should not fail.");
+    int secondID;
+    rc = getTableID(secondTable, secondID);
+    assert(rc == success && secondID == id + 1 && "Table ids should follow each other.");
+
+    // Use up the ids reserved so far, then lose the header: the next id follows the largest one in use
+    vector<string> batchTables;
+    for (int i = secondID + 1; i <= STATISTICS_TABLE_ID + TABLE_ID_BATCH; i++)
+    {
+        string name = tableName + "_" + to_string(i);
+        remove((name + ".t").c_str());
+        rc = createTable(name);
+        assert(rc == success && "createTable() should not fail.");
+        batchTables.push_back(name);
+    }
+    remove(CATALOG_HEADER_FILE_NAME);
+    rc = rm->deleteTable(secondTable);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+    rc = createTable(secondTable);
+    assert(rc == success && "createTable() should not fail without a header.");
+    rc = getTableID(secondTable, secondID);
+    assert(rc == success && secondID == STATISTICS_TABLE_ID + TABLE_ID_BATCH + 1 && "Table ids should continue after the largest one.");
+    FILE *header = fopen(CATALOG_HEADER_FILE_NAME, "rb");
+    assert(header != NULL && "A catalog without a header should get one.");
+    fclose(header);
+
+    rc = rm->deleteTable(firstTable);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+    rc = rm->deleteTable(secondTable);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+    for (const string &name : batchTables)
+    {
+        rc = rm->deleteTable(name);
+        assert(rc == success && "RelationManager::deleteTable() should not fail.");
+    }
+    for (const pair<string, vector<Attribute>> &table : savedTables)
+    {
+        rc = rm->createTable(table.first, table.second);
+        assert(rc == success && "RelationManager::createTable() should not fail.");
+    }
+
+    cout << "***** Test Case 20 Finished. The result will be examined. *****" << endl;
+    return 0;
+}
+
 int main()
 {
     // Get Attributes
@@ -1056,6 +1535,21 @@ int main()
 
     // Test Catalog Information
     rcmain = TEST_RM_15(catalog_table_name_columns);
+
+    // Table options
+    rcmain = TEST_RM_16("tbl_options");
+
+    // Table statistics
+    rcmain = TEST_RM_17("tbl_stats");
+
+    // Catalog cache
+    rcmain = TEST_RM_18("tbl_cache");
+
+    // Table handles
+    rcmain = TEST_RM_19("tbl_handle");
+
+    // Catalog header, last as it creates the catalog again
+    rcmain = TEST_RM_20("tbl_sequence");
     
     return 0;
 }